@@ -0,0 +1,171 @@
+// BridgeBench.cpp : what out-of-process hosting costs -- the same NullPlugin, loaded in-process and bridged
+//
+// usage: bridgebench [path-to-nullplugin [path-to-cvstbridge]]
+// output: JSON lines, one per case -- {"bench": name, "param": n, "iterations": n, "ns_per_op": x}
+//   load_<mode>              CVST_LoadPlugin(Bridged) + CVST_Destroy (bridged: includes starting the process)
+//   process_<mode>           CVST_ProcessReplacing of a stereo block (param: frames) -- one round trip when bridged
+//   block_events_<mode>      CVST_SetBlockEvents + CVST_ProcessReplacing (param: events per block, 64 frames)
+//   automate_<mode>          one audioMasterAutomate from inside processing (param: calls per block, 64 frames,
+//                            the empty block time is subtracted) -- a callback round trip when bridged
+//   bridge_overhead          process_bridged - process_in_process (param: frames)
+
+#include <stdio.h>
+#include <chrono>
+#include <vector>
+
+#include "../../source/CVSTHost.h"
+
+#ifndef NULLPLUGIN_PATH
+#define NULLPLUGIN_PATH "nullplugin.so"
+#endif
+#ifndef CVSTBRIDGE_PATH
+#define CVSTBRIDGE_PATH "cvstbridge"
+#endif
+
+#define BENCH_SECONDS 0.2
+#define MAX_FRAMES 1024
+#define EVENTS_BLOCK_SIZE 64
+#define AUTOMATE_CALLS 16
+#define NULLPLUGIN_MAX_CALLS_PER_BLOCK 1024
+
+// NullPlugin's parameters
+enum {
+    kParamGetTimeCalls,
+    kParamAutomateCalls,
+    kParamProcessLevelCalls
+};
+
+int CDECL vstHostCallback(CVST_HostEvent *event, CVST_Plugin, void *)
+{
+    event->handled = false;
+    return 0;
+}
+
+static double secondsSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// runs 'op' repeatedly for BENCH_SECONDS, returns ns per call
+template <typename Op>
+static double measure(Op op, long *iterations)
+{
+    op(); // warm up
+    auto start = std::chrono::steady_clock::now();
+    long n = 0;
+    while (secondsSince(start) < BENCH_SECONDS) {
+        for (int i = 0; i < 16; i++) {
+            op();
+        }
+        n += 16;
+    }
+    *iterations = n;
+    return secondsSince(start) * 1e9 / n;
+}
+
+static void report(const char *bench, int param, long iterations, double nsPerOp)
+{
+    printf("{\"bench\": \"%s\", \"param\": %d, \"iterations\": %ld, \"ns_per_op\": %.2f}\n", bench, param, iterations, nsPerOp);
+    fflush(stdout);
+}
+
+static void setParameter(CVST_Plugin plugin, int index, float value)
+{
+    CVST_ParameterChange change;
+    change.sampleOffs = 0;
+    change.index = index;
+    change.value = value;
+    CVST_SetBlockParameterChanges(plugin, &change, 1);
+}
+
+static const int blockSizes[] = { 32, 64, 256, 1024 };
+
+// returns ns per process call for each of blockSizes
+static std::vector<double> runMode(const char *path, bool bridged)
+{
+    auto load = bridged ? CVST_LoadPluginBridged : CVST_LoadPlugin;
+    auto suffix = bridged ? "bridged" : "in_process";
+    char name[64];
+    long iterations;
+    std::vector<double> processTimes;
+
+    auto nsPerOp = measure([path, load]() {
+        auto plugin = load(path, nullptr);
+        if (plugin) {
+            CVST_Destroy(plugin);
+        }
+    }, &iterations);
+
+    auto plugin = load(path, nullptr);
+    if (!plugin) {
+        fprintf(stderr, "failed to load [%s]%s\n", path, bridged ? " (bridged)" : "");
+        return processTimes;
+    }
+    snprintf(name, sizeof(name), "load_%s", suffix);
+    report(name, 0, iterations, nsPerOp);
+
+    CVST_Start(plugin, 44100.0f);
+    CVST_SetBlockSize(plugin, MAX_FRAMES);
+    CVST_Resume(plugin);
+
+    std::vector<float> storage(4 * MAX_FRAMES);
+    float *inputs[2] = { &storage[0], &storage[MAX_FRAMES] };
+    float *outputs[2] = { &storage[2 * MAX_FRAMES], &storage[3 * MAX_FRAMES] };
+
+    snprintf(name, sizeof(name), "process_%s", suffix);
+    for (auto frames : blockSizes) {
+        nsPerOp = measure([&]() { CVST_ProcessReplacing(plugin, inputs, outputs, frames); }, &iterations);
+        report(name, frames, iterations, nsPerOp);
+        processTimes.push_back(nsPerOp);
+    }
+    auto process = [&]() { CVST_ProcessReplacing(plugin, inputs, outputs, EVENTS_BLOCK_SIZE); };
+    auto emptyBlock = measure(process, &iterations);
+
+    snprintf(name, sizeof(name), "block_events_%s", suffix);
+    const int eventCounts[] = { 16, 256 };
+    for (auto numEvents : eventCounts) {
+        std::vector<CVST_MidiEvent> events(numEvents);
+        for (int i = 0; i < numEvents; i++) {
+            events[i].sampleOffs = (unsigned long)i * EVENTS_BLOCK_SIZE / numEvents;
+            events[i].data.uint32 = 0x00403C90; // note on
+        }
+        nsPerOp = measure([&]() {
+            CVST_SetBlockEvents(plugin, events.data(), numEvents);
+            process();
+        }, &iterations);
+        report(name, numEvents, iterations, nsPerOp);
+    }
+
+    snprintf(name, sizeof(name), "automate_%s", suffix);
+    setParameter(plugin, kParamAutomateCalls, (float)AUTOMATE_CALLS / NULLPLUGIN_MAX_CALLS_PER_BLOCK);
+    nsPerOp = measure(process, &iterations);
+    report(name, AUTOMATE_CALLS, iterations, (nsPerOp - emptyBlock) / AUTOMATE_CALLS);
+    setParameter(plugin, kParamAutomateCalls, 0.0f);
+    process();
+
+    CVST_Suspend(plugin);
+    CVST_Destroy(plugin);
+    return processTimes;
+}
+
+int main(int argc, char *argv[])
+{
+    auto path = argc > 1 ? argv[1] : NULLPLUGIN_PATH;
+
+    CVST_Init(vstHostCallback);
+    CVST_SetLogLevel(CVST_LogLevel_Warning);
+    CVST_SetBridgePath(argc > 2 ? argv[2] : CVSTBRIDGE_PATH);
+
+    auto inProcess = runMode(path, false);
+    auto bridged = runMode(path, true);
+    if (inProcess.size() != bridged.size()) {
+        CVST_Shutdown();
+        return 1;
+    }
+    for (size_t i = 0; i < bridged.size(); i++) {
+        report("bridge_overhead", blockSizes[i], 0, bridged[i] - inProcess[i]);
+    }
+
+    CVST_Shutdown();
+    return 0;
+}
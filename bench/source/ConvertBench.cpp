@@ -0,0 +1,159 @@
+// ConvertBench.cpp : checks the sample conversion kernels against a scalar reference, then measures their throughput
+//
+// usage: convertbench [frames-per-block]
+// output: one line per case -- "format layout direction channels ok|FAIL Msamples/sec"
+// exits nonzero if any case disagrees with the reference
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <chrono>
+#include <vector>
+#include <algorithm>
+
+#include "../../source/CVSTHost.h"
+
+#define NUM_CHANNELS 8
+#define BENCH_SECONDS 0.2
+
+static const char *formatNames[] = { "int16", "int24", "int32", "float32", "float64" };
+static const size_t formatBytes[] = { 2, 3, 4, 4, 8 };
+static const double fullScale[] = { 32768.0, 8388608.0, 2147483648.0, 1.0, 1.0 };
+
+// reference: read one driver sample as a double in [-1, 1)
+static double readSample(CVST_SampleFormat format, const uint8_t *p)
+{
+    switch (format) {
+    case CVST_SampleFormat_Int16:
+        return *(const int16_t *)p / fullScale[format];
+    case CVST_SampleFormat_Int24:
+        return ((int32_t)(((uint32_t)p[0] << 8) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 24)) >> 8) / fullScale[format];
+    case CVST_SampleFormat_Int32:
+        return *(const int32_t *)p / fullScale[format];
+    case CVST_SampleFormat_Float32:
+        return *(const float *)p;
+    default:
+        return *(const double *)p;
+    }
+}
+
+static double tolerance(CVST_SampleFormat format)
+{
+    // float has a 24-bit mantissa, so one int LSB (or ~1e-7 relative) is as good as it gets
+    return std::max(1.0 / fullScale[format], 1.0e-7);
+}
+
+struct Buffers {
+    std::vector<uint8_t> driver; // planar: channel after channel; interleaved: one block
+    std::vector<void *> driverPtrs;
+    std::vector<std::vector<float>> plugin;
+    std::vector<float *> pluginPtrs;
+
+    Buffers(CVST_SampleFormat format, bool interleaved, unsigned int frames) {
+        auto bytes = formatBytes[format];
+        driver.resize(bytes * frames * NUM_CHANNELS + 32);
+        for (int i = 0; i < NUM_CHANNELS; i++) {
+            driverPtrs.push_back(interleaved ? driver.data() : driver.data() + bytes * frames * i);
+        }
+        plugin.assign(NUM_CHANNELS, std::vector<float>(frames));
+        for (auto &ch : plugin) {
+            pluginPtrs.push_back(ch.data());
+        }
+    }
+    const uint8_t *sampleAt(CVST_SampleFormat format, bool interleaved, unsigned int frames, int ch, unsigned int frame) {
+        auto bytes = formatBytes[format];
+        return interleaved ? driver.data() + (frame * NUM_CHANNELS + ch) * bytes : driver.data() + (ch * frames + frame) * bytes;
+    }
+};
+
+static double secondsSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static bool runCase(CVST_SampleFormat format, bool interleaved, unsigned int frames)
+{
+    CVST_BufferLayout layout;
+    layout.format = format;
+    layout.numChannels = NUM_CHANNELS;
+    layout.interleaved = interleaved;
+
+    // reversed routing plus one silenced channel, so routing is exercised as well
+    int routing[NUM_CHANNELS];
+    for (int i = 0; i < NUM_CHANNELS; i++) {
+        routing[i] = NUM_CHANNELS - 1 - i;
+    }
+    routing[1] = -1;
+
+    Buffers buffers(format, interleaved, frames);
+    srand(1234);
+    for (int ch = 0; ch < NUM_CHANNELS; ch++) {
+        for (unsigned int i = 0; i < frames; i++) {
+            // slightly beyond full scale, so clipping is covered on the way back
+            auto value = ((double)rand() / RAND_MAX) * 2.2 - 1.1;
+            buffers.plugin[ch][i] = (float)value;
+        }
+    }
+
+    // === float -> driver ===
+    bool ok = true;
+    CVST_ConvertFromFloat(&layout, buffers.pluginPtrs.data(), NUM_CHANNELS, buffers.driverPtrs.data(), routing, frames);
+    for (int ch = 0; ch < NUM_CHANNELS && ok; ch++) {
+        for (unsigned int i = 0; i < frames; i++) {
+            auto expected = routing[ch] < 0 ? 0.0 : std::min(std::max((double)buffers.plugin[routing[ch]][i], -1.0), 1.0);
+            auto actual = readSample(format, buffers.sampleAt(format, interleaved, frames, ch, i));
+            if (fabs(actual - expected) > tolerance(format)) {
+                printf("  mismatch (from float) ch %d frame %u: expected %f, got %f\n", ch, i, expected, actual);
+                ok = false;
+                break;
+            }
+        }
+    }
+    auto start = std::chrono::steady_clock::now();
+    long iterations = 0;
+    while (secondsSince(start) < BENCH_SECONDS) {
+        CVST_ConvertFromFloat(&layout, buffers.pluginPtrs.data(), NUM_CHANNELS, buffers.driverPtrs.data(), routing, frames);
+        iterations++;
+    }
+    auto fromRate = iterations * (double)frames * NUM_CHANNELS / secondsSince(start) / 1e6;
+    printf("%-8s %-11s from_float %d %-4s %8.1f Msamples/sec\n", formatNames[format], interleaved ? "interleaved" : "planar", NUM_CHANNELS, ok ? "ok" : "FAIL", fromRate);
+
+    // === driver -> float ===
+    bool okTo = true;
+    CVST_ConvertToFloat(&layout, buffers.driverPtrs.data(), buffers.pluginPtrs.data(), NUM_CHANNELS, routing, frames);
+    for (int ch = 0; ch < NUM_CHANNELS && okTo; ch++) {
+        for (unsigned int i = 0; i < frames; i++) {
+            auto expected = routing[ch] < 0 ? 0.0 : readSample(format, buffers.sampleAt(format, interleaved, frames, routing[ch], i));
+            if (fabs(buffers.plugin[ch][i] - expected) > tolerance(format)) {
+                printf("  mismatch (to float) ch %d frame %u: expected %f, got %f\n", ch, i, expected, buffers.plugin[ch][i]);
+                okTo = false;
+                break;
+            }
+        }
+    }
+    start = std::chrono::steady_clock::now();
+    iterations = 0;
+    while (secondsSince(start) < BENCH_SECONDS) {
+        CVST_ConvertToFloat(&layout, buffers.driverPtrs.data(), buffers.pluginPtrs.data(), NUM_CHANNELS, routing, frames);
+        iterations++;
+    }
+    auto toRate = iterations * (double)frames * NUM_CHANNELS / secondsSince(start) / 1e6;
+    printf("%-8s %-11s to_float   %d %-4s %8.1f Msamples/sec\n", formatNames[format], interleaved ? "interleaved" : "planar", NUM_CHANNELS, okTo ? "ok" : "FAIL", toRate);
+
+    return ok && okTo;
+}
+
+int main(int argc, char *argv[])
+{
+    // odd default, so the scalar tails get exercised
+    unsigned int frames = argc > 1 ? (unsigned int)atoi(argv[1]) : 1021;
+
+    bool allOk = true;
+    for (int format = CVST_SampleFormat_Int16; format <= CVST_SampleFormat_Float64; format++) {
+        allOk &= runCase((CVST_SampleFormat)format, false, frames);
+        allOk &= runCase((CVST_SampleFormat)format, true, frames);
+    }
+    return allOk ? 0 : 1;
+}
@@ -0,0 +1,149 @@
+// HostBench.cpp : measures the host's own per-call overhead, against the do-nothing NullPlugin
+//
+// usage: hostbench [path-to-nullplugin]
+// output: JSON lines, one per case -- {"bench": name, "param": n, "iterations": n, "ns_per_op": x}
+//   load_destroy           CVST_LoadPlugin + CVST_Destroy (a full library load/unload)
+//   process_replacing      CVST_ProcessReplacing of an empty block (param: frames) -- the trampoline
+//   block_events           CVST_SetBlockEvents + CVST_ProcessReplacing (param: events per block)
+//   host_callback_<opcode> one hostCallback dispatch (param: calls per block, the empty block time is subtracted)
+
+#include <stdio.h>
+#include <chrono>
+#include <vector>
+
+#include "../../source/CVSTHost.h"
+
+#ifndef NULLPLUGIN_PATH
+#define NULLPLUGIN_PATH "nullplugin.so"
+#endif
+
+#define BENCH_SECONDS 0.2
+#define BLOCK_SIZE 64
+#define CALLS_PER_BLOCK 1024 // NullPlugin's MAX_CALLS_PER_BLOCK, at parameter value 1.0
+
+// NullPlugin's parameters
+enum {
+    kParamGetTimeCalls,
+    kParamAutomateCalls,
+    kParamProcessLevelCalls
+};
+
+int CDECL vstHostCallback(CVST_HostEvent *event, CVST_Plugin, void *)
+{
+    event->handled = false;
+    return 0;
+}
+
+static double secondsSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// runs 'op' repeatedly for BENCH_SECONDS, returns ns per call
+template <typename Op>
+static double measure(Op op, long *iterations)
+{
+    op(); // warm up
+    auto start = std::chrono::steady_clock::now();
+    long n = 0;
+    while (secondsSince(start) < BENCH_SECONDS) {
+        for (int i = 0; i < 16; i++) {
+            op();
+        }
+        n += 16;
+    }
+    *iterations = n;
+    return secondsSince(start) * 1e9 / n;
+}
+
+static void report(const char *bench, int param, long iterations, double nsPerOp)
+{
+    printf("{\"bench\": \"%s\", \"param\": %d, \"iterations\": %ld, \"ns_per_op\": %.2f}\n", bench, param, iterations, nsPerOp);
+    fflush(stdout);
+}
+
+static void setParameter(CVST_Plugin plugin, int index, float value)
+{
+    CVST_ParameterChange change;
+    change.sampleOffs = 0;
+    change.index = index;
+    change.value = value;
+    CVST_SetBlockParameterChanges(plugin, &change, 1);
+}
+
+int main(int argc, char *argv[])
+{
+    auto path = argc > 1 ? argv[1] : NULLPLUGIN_PATH;
+
+    CVST_Init(vstHostCallback);
+    CVST_SetLogLevel(CVST_LogLevel_Warning);
+
+    long iterations;
+    auto nsPerOp = measure([path]() {
+        auto plugin = CVST_LoadPlugin(path, nullptr);
+        if (plugin) {
+            CVST_Destroy(plugin);
+        }
+    }, &iterations);
+
+    auto plugin = CVST_LoadPlugin(path, nullptr);
+    if (!plugin) {
+        fprintf(stderr, "failed to load [%s]\n", path);
+        CVST_Shutdown();
+        return 1;
+    }
+    report("load_destroy", 0, iterations, nsPerOp);
+
+    CVST_Start(plugin, 44100.0f);
+    CVST_SetBlockSize(plugin, BLOCK_SIZE);
+    CVST_SetEventCapacity(plugin, 4096, 0);
+    CVST_Resume(plugin);
+
+    std::vector<float> storage(4 * BLOCK_SIZE);
+    float *inputs[2] = { &storage[0], &storage[BLOCK_SIZE] };
+    float *outputs[2] = { &storage[2 * BLOCK_SIZE], &storage[3 * BLOCK_SIZE] };
+
+    auto process = [&]() {
+        CVST_ProcessReplacing(plugin, inputs, outputs, BLOCK_SIZE);
+    };
+    auto emptyBlock = measure(process, &iterations);
+    report("process_replacing", BLOCK_SIZE, iterations, emptyBlock);
+
+    const int eventCounts[] = { 0, 16, 256, 4096 };
+    for (auto numEvents : eventCounts) {
+        std::vector<CVST_MidiEvent> events(numEvents);
+        for (int i = 0; i < numEvents; i++) {
+            events[i].sampleOffs = (unsigned long)i * BLOCK_SIZE / numEvents;
+            events[i].data.uint32 = 0x00403C90; // note on
+        }
+        nsPerOp = measure([&]() {
+            CVST_SetBlockEvents(plugin, events.data(), numEvents);
+            process();
+        }, &iterations);
+        report("block_events", numEvents, iterations, nsPerOp);
+    }
+
+    struct {
+        const char *name;
+        int param;
+    } callbacks[] = {
+        { "host_callback_get_time", kParamGetTimeCalls },
+        { "host_callback_automate", kParamAutomateCalls },
+        { "host_callback_get_current_process_level", kParamProcessLevelCalls },
+    };
+    for (auto &callback : callbacks) {
+        setParameter(plugin, callback.param, 1.0f);
+        nsPerOp = measure(process, &iterations);
+        report(callback.name, CALLS_PER_BLOCK, iterations, (nsPerOp - emptyBlock) / CALLS_PER_BLOCK);
+        setParameter(plugin, callback.param, 0.0f);
+        process();
+
+        CVST_AutomationEvent drained[16];
+        while (CVST_PollAutomation(plugin, drained, 16) > 0) {}
+    }
+
+    CVST_Suspend(plugin);
+    CVST_Destroy(plugin);
+    CVST_Shutdown();
+    return 0;
+}
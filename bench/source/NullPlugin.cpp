@@ -0,0 +1,91 @@
+// NullPlugin.cpp : a synthetic VST2 plugin that does nothing, so that hostbench measures only the host
+//
+// stereo in/out, processReplacing doesn't touch the buffers; it accepts MIDI (and ignores it).
+// each parameter sets how many times per block processReplacing calls the host with one opcode
+// (value * MAX_CALLS_PER_BLOCK), which is how hostbench times hostCallback dispatch.
+
+#include <string.h>
+#include "../../deps/VST2_SDK/pluginterfaces/vst2.x/aeffectx.h"
+
+#ifdef _WIN32
+#define PLUGIN_EXPORT extern "C" __declspec(dllexport)
+#else
+#define PLUGIN_EXPORT extern "C" __attribute__((visibility("default")))
+#endif
+
+#define MAX_CALLS_PER_BLOCK 1024
+
+enum Params {
+    kParamGetTimeCalls,
+    kParamAutomateCalls,
+    kParamProcessLevelCalls,
+    kNumParams
+};
+
+static const VstInt32 paramOpcodes[kNumParams] = { audioMasterGetTime, audioMasterAutomate, audioMasterGetCurrentProcessLevel };
+
+struct NullPlugin {
+    AEffect effect;
+    audioMasterCallback host;
+    float params[kNumParams] = {};
+};
+
+static VstIntPtr VSTCALLBACK dispatcherProc(AEffect* effect, VstInt32 opcode, VstInt32, VstIntPtr, void* ptr, float)
+{
+    switch (opcode) {
+    case effClose:
+        delete (NullPlugin *)effect->object;
+        return 1;
+    case effProcessEvents:
+        return 1;
+    case effCanDo:
+        return (!strcmp((const char *)ptr, "receiveVstEvents") || !strcmp((const char *)ptr, "receiveVstMidiEvent")) ? 1 : -1;
+    case effGetVstVersion:
+        return kVstVersion;
+    }
+    return 0;
+}
+
+static void VSTCALLBACK processReplacingProc(AEffect* effect, float**, float**, VstInt32)
+{
+    auto plugin = (NullPlugin *)effect->object;
+    for (int p = 0; p < kNumParams; p++) {
+        auto calls = (int)(plugin->params[p] * MAX_CALLS_PER_BLOCK + 0.5f);
+        for (int i = 0; i < calls; i++) {
+            // (GetTime's value is the filter mask -- ask for the usual tempo-sync fields)
+            plugin->host(effect, paramOpcodes[p], 0, kVstPpqPosValid | kVstTempoValid | kVstBarsValid, nullptr, 0.5f);
+        }
+    }
+}
+
+static void VSTCALLBACK setParameterProc(AEffect* effect, VstInt32 index, float parameter)
+{
+    if (index >= 0 && index < kNumParams) {
+        ((NullPlugin *)effect->object)->params[index] = parameter;
+    }
+}
+
+static float VSTCALLBACK getParameterProc(AEffect* effect, VstInt32 index)
+{
+    return (index >= 0 && index < kNumParams) ? ((NullPlugin *)effect->object)->params[index] : 0.0f;
+}
+
+PLUGIN_EXPORT AEffect *VSTPluginMain(audioMasterCallback host)
+{
+    auto plugin = new NullPlugin;
+    plugin->host = host;
+    auto &effect = plugin->effect;
+    memset(&effect, 0, sizeof(effect));
+    effect.magic = kEffectMagic;
+    effect.dispatcher = dispatcherProc;
+    effect.processReplacing = processReplacingProc;
+    effect.setParameter = setParameterProc;
+    effect.getParameter = getParameterProc;
+    effect.numParams = kNumParams;
+    effect.numInputs = 2;
+    effect.numOutputs = 2;
+    effect.object = plugin;
+    effect.uniqueID = CCONST('N', 'u', 'l', 'l');
+    effect.version = 1;
+    return &effect;
+}
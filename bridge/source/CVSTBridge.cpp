@@ -0,0 +1,302 @@
+// CVSTBridge.cpp : the child process of CVST_LoadPluginBridged -- hosts one plugin, and serves the host's calls
+// from the shared region (see source/Bridge.h)
+//
+// usage (by the host only): cvstbridge <shared memory name> <plugin path> <host pid>
+// exits when the plugin is closed, or when the host process goes away.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+
+#include "../../source/Bridge.h"
+#include "../../source/Denormals.h"
+
+typedef AEffect *(*vstPluginFuncPtr)(audioMasterCallback host);
+
+static BridgeRegion *region = nullptr;
+static AEffect *effect = nullptr;
+static PlatformProcess hostProcess = 0;
+static std::atomic<bool> quitting{ false };
+
+// per served channel (= per serving thread)
+struct ServedChannel {
+    BridgeChannel *shared;
+    std::vector<char> events; // VstEvents for effProcessEvents
+    std::vector<float *> floatInputs, floatOutputs;
+    std::vector<double *> doubleInputs, doubleOutputs;
+    // channels past BRIDGE_MAX_CHANNELS don't cross, but the plugin still gets buffers for them: silence in, discarded out
+    std::vector<double> spare;
+    int numSpareInputs = 0, numSpareOutputs = 0;
+
+    // audioMasterGetTime answers for the current request: plugins ask repeatedly, the host's answer won't change
+    VstTimeInfo timeInfo;
+    bool timeInfoValid = false;
+
+    ServedChannel(BridgeChannel *shared)
+        :shared(shared)
+    {
+        for (int i = 0; i < BRIDGE_MAX_CHANNELS; i++) {
+            floatInputs.push_back(bridgeInput<float>(region, i));
+            floatOutputs.push_back(bridgeOutput<float>(region, i));
+            doubleInputs.push_back(bridgeInput<double>(region, i));
+            doubleOutputs.push_back(bridgeOutput<double>(region, i));
+        }
+    }
+
+    // sizes the pointer arrays for the plugin's current channel counts (they can change), before processing
+    void fit(int numInputs, int numOutputs) {
+        auto spareInputs = std::max(numInputs - BRIDGE_MAX_CHANNELS, 0), spareOutputs = std::max(numOutputs - BRIDGE_MAX_CHANNELS, 0);
+        if (spareInputs != numSpareInputs || spareOutputs != numSpareOutputs) {
+            spare.assign((size_t)(spareInputs + spareOutputs) * BRIDGE_MAX_FRAMES, 0.0);
+            floatInputs.resize(BRIDGE_MAX_CHANNELS + spareInputs);
+            doubleInputs.resize(BRIDGE_MAX_CHANNELS + spareInputs);
+            floatOutputs.resize(BRIDGE_MAX_CHANNELS + spareOutputs);
+            doubleOutputs.resize(BRIDGE_MAX_CHANNELS + spareOutputs);
+            for (int i = 0; i < spareInputs + spareOutputs; i++) {
+                auto buffer = &spare[(size_t)i * BRIDGE_MAX_FRAMES]; // (room for doubles, so for floats too)
+                if (i < spareInputs) {
+                    floatInputs[BRIDGE_MAX_CHANNELS + i] = (float *)buffer;
+                    doubleInputs[BRIDGE_MAX_CHANNELS + i] = buffer;
+                }
+                else {
+                    floatOutputs[BRIDGE_MAX_CHANNELS + i - spareInputs] = (float *)buffer;
+                    doubleOutputs[BRIDGE_MAX_CHANNELS + i - spareInputs] = buffer;
+                }
+            }
+            numSpareInputs = spareInputs;
+            numSpareOutputs = spareOutputs;
+        }
+        // (silent again, in case the plugin wrote to its inputs)
+        std::fill(spare.begin(), spare.begin() + (size_t)numSpareInputs * BRIDGE_MAX_FRAMES, 0.0);
+    }
+};
+static thread_local ServedChannel *currentChannel = nullptr;
+
+static bool hostAlive()
+{
+    if (quitting) {
+        return false;
+    }
+    if (!platformProcessRunning(hostProcess)) {
+        quitting = true;
+        return false;
+    }
+    return true;
+}
+
+static VstIntPtr VSTCALLBACK bridgeCallback(AEffect *, VstInt32 opcode, VstInt32 index, VstIntPtr value, void *ptr, float opt)
+{
+    if (opcode == audioMasterVersion) {
+        return kVstVersion;
+    }
+    auto served = currentChannel;
+    auto kind = bridgeCallbackKind(opcode);
+    if (!served || kind == kBridgePtrUnsupported) {
+        // (the plugin's own threads, or while loading: the host isn't waiting for anything it could answer with)
+        return 0;
+    }
+    const VstInt32 timeInfoFields = kVstPpqPosValid | kVstTempoValid | kVstBarsValid | kVstCyclePosValid | kVstTimeSigValid | kVstClockValid;
+    if (kind == kBridgePtrTimeInfoOut && served->timeInfoValid && !(value & timeInfoFields & ~served->timeInfo.flags)) {
+        return (VstIntPtr)&served->timeInfo;
+    }
+
+    auto &message = served->shared->callback;
+    auto payload = served->shared->callbackPayload;
+    message.opcode = opcode;
+    message.index = index;
+    message.value = value;
+    message.opt = opt;
+    message.payloadSize = 0;
+    if (kind == kBridgePtrStringIn) {
+        strncpy(payload, (const char *)ptr, BRIDGE_PAYLOAD_SIZE - 1);
+        payload[BRIDGE_PAYLOAD_SIZE - 1] = 0;
+    }
+    else if (kind == kBridgePtrEvents) {
+        bridgeWriteEvents(payload, (const VstEvents *)ptr);
+    }
+    bridgeGetEffectInfo(effect, &served->shared->info);
+
+    bridgePost(served->shared->state, kBridgeCallback);
+    if (bridgeWaitWhile(served->shared->state, kBridgeCallback, hostAlive) == kBridgeCallback) {
+        return 0;
+    }
+
+    if (kind == kBridgePtrTimeInfoOut) {
+        if (message.payloadSize != sizeof(VstTimeInfo)) {
+            return 0;
+        }
+        memcpy(&served->timeInfo, payload, sizeof(VstTimeInfo));
+        served->timeInfoValid = true;
+        return (VstIntPtr)&served->timeInfo;
+    }
+    if (kind == kBridgePtrStringOut) {
+        memcpy(ptr, payload, std::min(message.payloadSize, (uint32_t)BRIDGE_STRING_SIZE));
+    }
+    return (VstIntPtr)message.result;
+}
+
+static void dispatch(ServedChannel &served)
+{
+    auto &message = served.shared->request;
+    auto payload = served.shared->payload;
+    auto opcode = message.opcode;
+    auto index = message.index;
+    auto value = (VstIntPtr)message.value;
+    auto opt = message.opt;
+    auto kind = bridgeDispatchKind(opcode);
+    auto requestSize = message.payloadSize;
+    message.payloadSize = 0;
+    switch (kind) {
+    case kBridgePtrNone:
+        message.result = effect->dispatcher(effect, opcode, index, value, nullptr, opt);
+        break;
+    case kBridgePtrStringIn:
+        message.result = effect->dispatcher(effect, opcode, index, value, requestSize ? payload : nullptr, opt);
+        break;
+    case kBridgePtrStringOut:
+        // (the whole payload is there to be overrun)
+        payload[0] = 0;
+        message.result = effect->dispatcher(effect, opcode, index, value, payload, opt);
+        payload[BRIDGE_STRING_SIZE - 1] = 0;
+        message.payloadSize = (uint32_t)strlen(payload) + 1;
+        break;
+    case kBridgePtrEvents:
+        message.result = effect->dispatcher(effect, opcode, index, value, bridgeReadEvents(payload, served.events), opt);
+        break;
+    case kBridgePtrChunkOut: {
+        void *data = nullptr;
+        message.result = effect->dispatcher(effect, opcode, index, value, &data, opt);
+        if (message.result > BRIDGE_CHUNK_SIZE || (message.result > 0 && !data)) {
+            fprintf(stderr, "cvstbridge: chunk of %lld bytes can't cross, dropped\n", (long long)message.result);
+            message.result = 0;
+        }
+        else if (message.result > 0) {
+            memcpy(region->chunk, data, (size_t)message.result);
+        }
+        break;
+    }
+    case kBridgePtrChunkIn:
+        message.result = effect->dispatcher(effect, opcode, index, value, region->chunk, opt);
+        break;
+    case kBridgePtrRectOut: {
+        ERect *rect = nullptr;
+        message.result = effect->dispatcher(effect, opcode, index, value, &rect, opt);
+        if (rect) {
+            memcpy(payload, rect, sizeof(ERect));
+            message.payloadSize = sizeof(ERect);
+        }
+        break;
+    }
+    default:
+        message.result = 0; // (the host doesn't send these)
+        break;
+    }
+    if (opcode == effClose) {
+        effect = nullptr;
+        quitting = true;
+        platformWakeWord(&region->audio.state); // (rather than waiting out its poll)
+    }
+}
+
+// what the host queued in the payload ahead of a request: its parameter changes, in order, then its events
+static void deliverPending(ServedChannel &served)
+{
+    auto payload = served.shared->payload;
+    auto numChanges = std::max(0, std::min(bridgeParameterCount(payload), (int32_t)BRIDGE_MAX_PARAMS)); // (clamped both ways)
+    auto changes = bridgeParameterChanges(payload);
+    for (int i = 0; i < numChanges; i++) {
+        effect->setParameter(effect, changes[i].index, changes[i].value);
+    }
+    auto events = bridgeReadEvents(payload, served.events);
+    if (events->numEvents > 0) {
+        effect->dispatcher(effect, effProcessEvents, 0, 0, events, 0.0f);
+    }
+}
+
+static void serve(ServedChannel &served)
+{
+    currentChannel = &served;
+    auto &state = served.shared->state;
+    while (!quitting) {
+        auto current = state.load(std::memory_order_acquire);
+        if (current != kBridgeRequest) {
+            bridgeWaitWhile(state, current, hostAlive);
+            continue;
+        }
+        served.timeInfoValid = false;
+        auto &message = served.shared->request;
+        if ((message.call == kBridgeProcess || message.call == kBridgeProcessDouble || message.call == kBridgeDeliver) && message.payloadSize) {
+            deliverPending(served);
+        }
+        switch (message.call) {
+        case kBridgeProcess: {
+            served.fit(effect->numInputs, effect->numOutputs);
+            DenormalGuard denormals; // (as the host does around processing)
+            effect->processReplacing(effect, served.floatInputs.data(), served.floatOutputs.data(), (VstInt32)message.value);
+            break;
+        }
+        case kBridgeProcessDouble: {
+            served.fit(effect->numInputs, effect->numOutputs);
+            DenormalGuard denormals;
+            effect->processDoubleReplacing(effect, served.doubleInputs.data(), served.doubleOutputs.data(), (VstInt32)message.value);
+            break;
+        }
+        case kBridgeDeliver:
+            break;
+        case kBridgeSetParameter:
+            effect->setParameter(effect, message.index, message.opt);
+            break;
+        case kBridgeGetParameter:
+            message.floatResult = effect->getParameter(effect, message.index);
+            break;
+        case kBridgeDispatch:
+            dispatch(served);
+            break;
+        }
+        if (effect) {
+            bridgeGetEffectInfo(effect, &served.shared->info);
+        }
+        bridgePost(state, kBridgeReply);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 4) {
+        fprintf(stderr, "usage: cvstbridge <shared memory name> <plugin path> <host pid> (started by CVST_LoadPluginBridged)\n");
+        return 2;
+    }
+    PlatformSharedMemory shm;
+    if (!platformOpenSharedMemory(argv[1], sizeof(BridgeRegion), &shm)) {
+        fprintf(stderr, "cvstbridge: couldn't open the shared memory region [%s]\n", argv[1]);
+        return 1;
+    }
+    region = (BridgeRegion *)shm.data;
+    hostProcess = platformOpenProcess(atoi(argv[3]));
+
+    auto library = platformLoadLibrary(argv[2]);
+    auto mainEntryPoint = library ? (vstPluginFuncPtr)platformGetSymbol(library, "VSTPluginMain") : nullptr;
+    if (library && !mainEntryPoint) {
+        mainEntryPoint = (vstPluginFuncPtr)platformGetSymbol(library, "main");
+    }
+    effect = mainEntryPoint ? mainEntryPoint(bridgeCallback) : nullptr;
+    if (!effect || effect->magic != kEffectMagic) {
+        fprintf(stderr, "cvstbridge: couldn't load [%s]: %s\n", argv[2], library ? "no valid entry point" : platformLastError());
+        bridgePost(region->loadState, kBridgeLoadFailed);
+        return 1;
+    }
+    bridgeGetEffectInfo(effect, &region->info);
+    bridgeGetEffectInfo(effect, &region->audio.info);
+    bridgeGetEffectInfo(effect, &region->control.info);
+
+    ServedChannel audio(&region->audio), control(&region->control);
+    std::thread controlThread([&control]() { serve(control); });
+    bridgePost(region->loadState, kBridgeLoaded);
+    serve(audio);
+    controlThread.join();
+
+    platformFreeLibrary(library);
+    platformCloseSharedMemory(&shm);
+    return 0;
+}
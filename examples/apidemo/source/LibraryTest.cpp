@@ -24,8 +24,8 @@ static wl_TimerRef idleTimer = nullptr;
 static CASIO_Device asioDevice = nullptr;
 static CASIO_DeviceProperties asioProps;
 static double sampleRate;
-static float **asioInputs;
-static float **asioOutputs;
+static CVST_BufferLayout asioInputLayout;
+static CVST_BufferLayout asioOutputLayout;
 
 static CVST_Plugin vstPlugin;
 static CVST_Properties vstProps;
@@ -113,6 +113,17 @@ static void saveProgram() {
     } // else canceled
 }
 
+static void pollAutomation() {
+    CVST_AutomationEvent automation[64];
+    int count;
+    do {
+        count = CVST_PollAutomation(vstPlugin, automation, 64);
+        for (int i = 0; i < count; i++) {
+            printf(" = vst automation [%03d] value %.2f\n", automation[i].index, automation[i].value);
+        }
+    } while (count == 64);
+}
+
 int CDECL wlCallback(wl_WindowRef window, struct wl_Event *event, void *userData)
 {
     event->handled = true;
@@ -120,6 +131,7 @@ int CDECL wlCallback(wl_WindowRef window, struct wl_Event *event, void *userData
     case wl_EventType::wl_kEventTypeTimer:
         if (event->timerEvent.timer == idleTimer) {
             CVST_Idle(vstPlugin);
+            pollAutomation();
         }
         break;
     case wl_EventType::wl_kEventTypeWindowDestroyed:
@@ -162,9 +174,6 @@ int CDECL vstHostCallback(CVST_HostEvent *event, CVST_Plugin plugin, void *userD
     case CVST_EventType_Log:
         printf("VST>> %s\n", event->logEvent.message);
         break;
-    case CVST_EventType_Automation:
-        printf(" = vst automation [%03d] value %.2f\n", event->automationEvent.index, event->automationEvent.value);
-        break;
     case CVST_EventType_GetVendorInfo:
         event->vendorInfoEvent.vendor = "Derp";
         event->vendorInfoEvent.product = "LibraryTest";
@@ -183,24 +192,12 @@ static int midiEventCount;
 
 void bufferSwitch(CASIO_Event *event) {
     if (asioProps.sampleFormat == CASIO_SampleFormat_Int32) {
-        // convert raw asio inputs to float inputs
-        auto rawInputs = (int **)event->bufferSwitchEvent.inputs;
-        for (int i = 0; i < asioProps.numInputs; i++) {
-            for (int j = 0; j < asioProps.bufferSampleLength; j++) {
-                asioInputs[i][j] = (float) (rawInputs[i][j] / (1 << 30));
-            }
-        }
+        // convert raw asio inputs straight into the vst inputs (1:1 routing, surplus vst inputs get silence)
+        CVST_ConvertToFloat(&asioInputLayout, (const void * const *)event->bufferSwitchEvent.inputs, vstInputs, vstProps.numInputs, nullptr, asioProps.bufferSampleLength);
 
         // === process the VST ====
-        
-        // copy max asio inputs to vst inputs
-        int inputsToCopy = min(asioProps.numInputs, vstProps.numInputs);
-        for (int i = 0; i < inputsToCopy; i++) {
-            memcpy(vstInputs[i], asioInputs[i], asioProps.bufferSampleLength * sizeof(float));
-        }
 
         // process midi
-        bool blockSent = false;
         do {
             CWin32Midi_ReadInput(midiDevice, midiEvents, MIDI_BUFFER_LEN, &midiEventCount);
             for (int i = 0; i < midiEventCount; i++) {
@@ -210,12 +207,8 @@ void bufferSwitch(CASIO_Event *event) {
                 vstMidiEvents[i].data.uint32 = midiEvents[i].data.uint32;
             }
 
-            // currently this can only be called once per block
-            // so for now only send the first batch (2048 events is pleeeeenty for small ~12ms buffers! that's 176k events/sec)
-            if (!blockSent) {
-                CVST_SetBlockEvents(vstPlugin, vstMidiEvents, midiEventCount);
-                blockSent = true;
-            }
+            // each batch is merged into the plugin's event timeline, so every one of them gets through
+            CVST_SetBlockEvents(vstPlugin, vstMidiEvents, midiEventCount);
 
             // the CWin32Midi internal reference time won't reset until we've called ReadInput and it returns less than our total buffer size
             // hence the do-while loop, until that's the case
@@ -224,19 +217,8 @@ void bufferSwitch(CASIO_Event *event) {
         // process!
         CVST_ProcessReplacing(vstPlugin, vstInputs, vstOutputs, asioProps.bufferSampleLength);
 
-        // copy as many outputs as possible
-        int outputsToCopy = min(vstProps.numOutputs, asioProps.numOutputs);
-        for (int i = 0; i < outputsToCopy; i++) {
-            memcpy(asioOutputs[i], vstOutputs[i], asioProps.bufferSampleLength * sizeof(float));
-        }
-
-        // convert back to ASIO native format
-        auto rawOutputs = (int **)event->bufferSwitchEvent.outputs;
-        for (int i = 0; i < asioProps.numOutputs; i++) {
-            for (int j = 0; j < asioProps.bufferSampleLength; j++) {
-                rawOutputs[i][j] = (int)(asioOutputs[i][j] * (1 << 30));
-            }
-        }
+        // convert back to ASIO native format (surplus asio outputs get silence)
+        CVST_ConvertFromFloat(&asioOutputLayout, vstOutputs, vstProps.numOutputs, (void **)event->bufferSwitchEvent.outputs, nullptr, asioProps.bufferSampleLength);
     }
     else {
         for (int i = 0; i < asioProps.numOutputs; i++) {
@@ -278,17 +260,12 @@ int CDECL midiCallback(CWin32Midi_Event *event, CWin32Midi_Device device, void *
 }
 
 void allocBuffers() {
-    asioInputs = new float*[asioProps.numInputs];
-    for (int i = 0; i < asioProps.numInputs; i++) {
-        asioInputs[i] = new float[asioProps.bufferSampleLength];
-        // don't need to zero, they always get erased by incoming
-    }
-
-    asioOutputs = new float*[asioProps.numOutputs];
-    for (int i = 0; i < asioProps.numOutputs; i++) {
-        asioOutputs[i] = new float[asioProps.bufferSampleLength];
-        memset(asioOutputs[i], 0, sizeof(float)*asioProps.bufferSampleLength);
-    }
+    // asio side is converted in place, only needs describing
+    asioInputLayout.format = CVST_SampleFormat_Int32;
+    asioInputLayout.numChannels = asioProps.numInputs;
+    asioInputLayout.interleaved = false;
+    asioOutputLayout = asioInputLayout;
+    asioOutputLayout.numChannels = asioProps.numOutputs;
 
     // vst
     vstInputs = new float*[vstProps.numInputs];
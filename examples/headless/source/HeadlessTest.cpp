@@ -0,0 +1,146 @@
+// HeadlessTest.cpp : loads a plugin without any audio/MIDI/UI devices and renders a test signal through it
+//
+// usage: headless [path-to-plugin [-v]]   (defaults to the in-tree test plugin; -v shows debug-level log messages)
+
+#include <stdio.h>
+#include <math.h>
+#include <algorithm>
+
+#include "../../../source/CVSTHost.h"
+
+#ifndef TESTPLUGIN_PATH
+#define TESTPLUGIN_PATH "testplugin.so"
+#endif
+
+#define SAMPLE_RATE 44100.0f
+#define BLOCK_SIZE 256
+#define NUM_BLOCKS 172 // ~1 second
+
+int CDECL vstHostCallback(CVST_HostEvent *event, CVST_Plugin, void *)
+{
+    event->handled = true;
+    switch (event->eventType) {
+    case CVST_EventType_Log:
+        printf("VST>> %s\n", event->logEvent.message);
+        break;
+    case CVST_EventType_GetVendorInfo:
+        event->vendorInfoEvent.vendor = "Derp";
+        event->vendorInfoEvent.product = "HeadlessTest";
+        event->vendorInfoEvent.version = 1234;
+        break;
+    default:
+        event->handled = false;
+    }
+    return 0;
+}
+
+static float **allocChannels(int numChannels) {
+    auto ret = new float*[numChannels];
+    for (int i = 0; i < numChannels; i++) {
+        ret[i] = new float[BLOCK_SIZE]();
+    }
+    return ret;
+}
+
+static void freeChannels(float **channels, int numChannels) {
+    for (int i = 0; i < numChannels; i++) {
+        delete[] channels[i];
+    }
+    delete[] channels;
+}
+
+int main(int argc, char *argv[])
+{
+    auto path = argc > 1 ? argv[1] : TESTPLUGIN_PATH;
+
+    CVST_Init(vstHostCallback);
+    CVST_SetLogLevel(argc > 2 ? CVST_LogLevel_Debug : CVST_LogLevel_Info);
+
+    auto plugin = CVST_LoadPlugin(path, nullptr);
+    if (!plugin) {
+        printf("failed to load [%s]\n", path);
+        CVST_Shutdown();
+        return 1;
+    }
+
+    CVST_Properties props;
+    CVST_GetProperties(plugin, &props);
+    printf("inputs: %d, outputs: %d, instrument: %s\n", props.numInputs, props.numOutputs, props.isInstrument ? "yes" : "no");
+
+    CVST_Start(plugin, SAMPLE_RATE);
+    CVST_SetBlockSize(plugin, BLOCK_SIZE);
+    CVST_Resume(plugin);
+
+    // rolling transport (default tempo / time signature), for anything tempo-synced
+    CVST_Transport transport;
+    CVST_GetTransport(plugin, &transport);
+    transport.playing = true;
+    CVST_SetTransport(plugin, &transport);
+
+    auto inputs = allocChannels(props.numInputs);
+    auto outputs = allocChannels(props.numOutputs);
+
+    // middle C on / off, just so the event path runs
+    CVST_MidiEvent noteOn, noteOff;
+    noteOn.sampleOffs = 0;
+    noteOn.data.uint32 = 0x007F3C90;
+    noteOff.sampleOffs = BLOCK_SIZE / 2;
+    noteOff.data.uint32 = 0x00003C80;
+
+    // ... and a sample-accurate gain dip in the middle of a block, so the block splitting runs too
+    CVST_ParameterChange gainChanges[2];
+    gainChanges[0].sampleOffs = BLOCK_SIZE / 4;
+    gainChanges[0].index = 0;
+    gainChanges[0].value = 0.25f;
+    gainChanges[1].sampleOffs = BLOCK_SIZE * 3 / 4;
+    gainChanges[1].index = 0;
+    gainChanges[1].value = 0.5f;
+
+    float peak = 0.0f;
+    unsigned long frame = 0;
+    for (int block = 0; block < NUM_BLOCKS; block++) {
+        for (int i = 0; i < props.numInputs; i++) {
+            for (int j = 0; j < BLOCK_SIZE; j++) {
+                inputs[i][j] = 0.5f * sinf(2.0f * 3.14159265f * 440.0f * (frame + j) / SAMPLE_RATE);
+            }
+        }
+        if (block == 0) {
+            CVST_SetBlockEvents(plugin, &noteOn, 1);
+        }
+        else if (block == 1) {
+            CVST_SetBlockEvents(plugin, &noteOff, 1);
+        }
+        else if (block == 2) {
+            CVST_SetBlockParameterChanges(plugin, gainChanges, 2);
+        }
+        CVST_ProcessReplacing(plugin, inputs, outputs, BLOCK_SIZE);
+        int numOutputEvents;
+        auto outputEvents = CVST_GetOutputEvents(plugin, &numOutputEvents);
+        for (int i = 0; i < numOutputEvents; i++) {
+            printf("block %d: plugin sent %02X %02X %02X at %lu\n", block, outputEvents[i].data.bytes[0],
+                outputEvents[i].data.bytes[1], outputEvents[i].data.bytes[2], outputEvents[i].sampleOffs);
+        }
+        for (int i = 0; i < props.numOutputs; i++) {
+            for (int j = 0; j < BLOCK_SIZE; j++) {
+                peak = std::max(peak, fabsf(outputs[i][j]));
+            }
+        }
+        frame += BLOCK_SIZE;
+        CVST_DrainLog(); // no idle loop here -- in a real host this belongs on a non-audio thread
+    }
+    printf("rendered %lu frames, output peak %.3f\n", frame, peak);
+
+    CVST_Stats stats;
+    CVST_GetStats(plugin, &stats);
+    printf("%llu blocks, avg %.2fus (load %.4f), max %.2fus (load %.4f), %llu overruns\n",
+        stats.blocks, stats.avgTime, stats.avgLoad, stats.maxTime, stats.maxLoad, stats.overruns);
+
+    freeChannels(inputs, props.numInputs);
+    freeChannels(outputs, props.numOutputs);
+
+    CVST_Suspend(plugin);
+    CVST_Destroy(plugin);
+    CVST_Shutdown();
+
+    return peak > 0.0f ? 0 : 1;
+}
@@ -0,0 +1,198 @@
+// TestPlugin.cpp : a tiny synthetic VST2 plugin, so the host can be exercised without third-party binaries
+//
+// stereo gain effect with a single "Gain" parameter (0.5 = unity), and it accepts MIDI
+// so that the host treats it as an instrument and the event path gets exercised too
+// (MIDI CC7 sets the gain, and reports it to the host via audioMasterAutomate; all incoming MIDI is echoed back to the host)
+// its state (the parameters) is saved and restored as a chunk, for the host's chunk / preset store paths
+
+#include <string.h>
+#include <stdio.h>
+#include "../../../deps/VST2_SDK/pluginterfaces/vst2.x/aeffectx.h"
+
+#ifdef _WIN32
+#define PLUGIN_EXPORT extern "C" __declspec(dllexport)
+#else
+#define PLUGIN_EXPORT extern "C" __attribute__((visibility("default")))
+#endif
+
+#define NUM_CHANNELS 2
+
+enum Params {
+    kParamGain,
+    kNumParams
+};
+
+// the chunk (program and bank alike)
+struct TestPluginState {
+    VstInt32 magic;
+    VstInt32 numParams;
+    float params[kNumParams];
+};
+#define STATE_MAGIC CCONST('c', 'v', 't', 's')
+
+struct TestPlugin {
+    AEffect effect;
+    audioMasterCallback host;
+
+    float params[kNumParams];
+    float sampleRate = 44100.0f;
+    int blockSize = 512;
+    int eventsReceived = 0;
+    TestPluginState state; // (what effGetChunk hands out)
+
+    TestPlugin(audioMasterCallback host);
+
+    inline float gain() const { return params[kParamGain] * 2.0f; }
+};
+
+static void copyString(char *dest, size_t destLen, const char *source)
+{
+    strncpy(dest, source, destLen - 1);
+    dest[destLen - 1] = 0;
+}
+
+static VstIntPtr VSTCALLBACK dispatcherProc(AEffect* effect, VstInt32 opcode, VstInt32, VstIntPtr value, void* ptr, float opt)
+{
+    auto plugin = (TestPlugin *)effect->object;
+    switch (opcode) {
+    case effClose:
+        delete plugin;
+        return 1;
+    case effSetSampleRate:
+        plugin->sampleRate = opt;
+        return 1;
+    case effSetBlockSize:
+        plugin->blockSize = (int)value;
+        return 1;
+    case effSetProcessPrecision:
+        return 1; // both supported
+    case effGetParamName:
+        copyString((char *)ptr, kVstMaxParamStrLen, "Gain");
+        return 1;
+    case effGetParamLabel:
+        copyString((char *)ptr, kVstMaxParamStrLen, "x");
+        return 1;
+    case effGetParamDisplay:
+        snprintf((char *)ptr, kVstMaxParamStrLen, "%.2f", plugin->gain());
+        return 1;
+    case effProcessEvents: {
+        auto events = (VstEvents *)ptr;
+        plugin->eventsReceived += events->numEvents;
+        for (int i = 0; i < events->numEvents; i++) {
+            auto event = (VstMidiEvent *)events->events[i];
+            // CC7 drives the gain parameter, and is reported back as automation -- like turning the knob
+            if (event->type == kVstMidiType && (event->midiData[0] & 0xF0) == 0xB0 && event->midiData[1] == 7) {
+                auto value = (event->midiData[2] & 0x7F) / 127.0f;
+                plugin->params[kParamGain] = value;
+                plugin->host(effect, audioMasterAutomate, kParamGain, 0, nullptr, value);
+            }
+        }
+        plugin->host(effect, audioMasterProcessEvents, 0, 0, events, 0.0f); // MIDI thru
+        return 1;
+    }
+    case effGetChunk:
+        plugin->state.magic = STATE_MAGIC;
+        plugin->state.numParams = kNumParams;
+        memcpy(plugin->state.params, plugin->params, sizeof(plugin->params));
+        *(void **)ptr = &plugin->state;
+        return sizeof(TestPluginState);
+    case effSetChunk: {
+        auto state = (const TestPluginState *)ptr;
+        if (value != sizeof(TestPluginState) || state->magic != STATE_MAGIC || state->numParams != kNumParams) {
+            return 0;
+        }
+        memcpy(plugin->params, state->params, sizeof(plugin->params));
+        return 1;
+    }
+    case effGetEffectName:
+        copyString((char *)ptr, kVstMaxEffectNameLen, "TestPlugin");
+        return 1;
+    case effGetVendorString:
+        copyString((char *)ptr, kVstMaxVendorStrLen, "CVSTHost");
+        return 1;
+    case effGetProductString:
+        copyString((char *)ptr, kVstMaxProductStrLen, "CVSTHost Test Plugin");
+        return 1;
+    case effGetVendorVersion:
+        return 1000;
+    case effGetPlugCategory:
+        return kPlugCategEffect;
+    case effCanDo:
+        if (!strcmp((const char *)ptr, "receiveVstEvents") || !strcmp((const char *)ptr, "receiveVstMidiEvent") ||
+            !strcmp((const char *)ptr, "sendVstEvents") || !strcmp((const char *)ptr, "sendVstMidiEvent"))
+        {
+            return 1;
+        }
+        return -1;
+    case effGetVstVersion:
+        return kVstVersion;
+    }
+    return 0;
+}
+
+template <typename T>
+static void process(AEffect* effect, T** inputs, T** outputs, VstInt32 sampleFrames)
+{
+    auto plugin = (TestPlugin *)effect->object;
+    auto gain = (T)plugin->gain();
+    for (int ch = 0; ch < NUM_CHANNELS; ch++) {
+        for (int i = 0; i < sampleFrames; i++) {
+            outputs[ch][i] = inputs[ch][i] * gain;
+        }
+    }
+}
+
+static void VSTCALLBACK processReplacingProc(AEffect* effect, float** inputs, float** outputs, VstInt32 sampleFrames)
+{
+    process(effect, inputs, outputs, sampleFrames);
+}
+
+static void VSTCALLBACK processDoubleReplacingProc(AEffect* effect, double** inputs, double** outputs, VstInt32 sampleFrames)
+{
+    process(effect, inputs, outputs, sampleFrames);
+}
+
+static void VSTCALLBACK setParameterProc(AEffect* effect, VstInt32 index, float parameter)
+{
+    auto plugin = (TestPlugin *)effect->object;
+    if (index >= 0 && index < kNumParams) {
+        plugin->params[index] = parameter;
+    }
+}
+
+static float VSTCALLBACK getParameterProc(AEffect* effect, VstInt32 index)
+{
+    auto plugin = (TestPlugin *)effect->object;
+    return (index >= 0 && index < kNumParams) ? plugin->params[index] : 0.0f;
+}
+
+TestPlugin::TestPlugin(audioMasterCallback host)
+    :host(host)
+{
+    memset(&effect, 0, sizeof(effect));
+    effect.magic = kEffectMagic;
+    effect.dispatcher = dispatcherProc;
+    effect.setParameter = setParameterProc;
+    effect.getParameter = getParameterProc;
+    effect.processReplacing = processReplacingProc;
+    effect.processDoubleReplacing = processDoubleReplacingProc;
+    effect.numPrograms = 1;
+    effect.numParams = kNumParams;
+    effect.numInputs = NUM_CHANNELS;
+    effect.numOutputs = NUM_CHANNELS;
+    effect.flags = effFlagsCanReplacing | effFlagsCanDoubleReplacing | effFlagsProgramChunks;
+    effect.object = this;
+    effect.uniqueID = CCONST('c', 'v', 't', 'p');
+    effect.version = 1000;
+
+    params[kParamGain] = 0.5f;
+}
+
+PLUGIN_EXPORT AEffect *VSTPluginMain(audioMasterCallback host)
+{
+    if (!host(nullptr, audioMasterVersion, 0, 0, nullptr, 0.0f)) {
+        return nullptr;
+    }
+    auto plugin = new TestPlugin(host);
+    return &plugin->effect;
+}
@@ -0,0 +1,70 @@
+#ifndef __CVSTHOST_AUTOMATIONQUEUE_H__
+#define __CVSTHOST_AUTOMATIONQUEUE_H__
+
+// (internal) per-plugin automation queue, written from hostCallback (audioMasterAutomate) and drained by CVST_PollAutomation
+//
+// each parameter has a latest-value slot and a 'pending' flag; only the write that raises the flag
+// enqueues the parameter index, so repeated writes before the next drain coalesce (last value wins),
+// and the index ring can never hold more than numParams entries -- it is sized for that, and never overflows.
+// any number of producers (plugins automate from both audio and UI threads), one consumer.
+
+#include <atomic>
+#include <memory>
+#include "CVSTHost.h"
+
+class AutomationQueue {
+    int numParams = 0;
+    std::unique_ptr<std::atomic<float>[]> values;
+    std::unique_ptr<std::atomic<bool>[]> pending;
+    std::unique_ptr<std::atomic<int>[]> ring; // parameter index + 1, 0 = slot not (yet) written
+    std::atomic<unsigned int> tail{ 0 };
+    unsigned int head = 0; // consumer only
+
+public:
+    void init(int numParams) {
+        this->numParams = numParams;
+        values.reset(new std::atomic<float>[numParams]);
+        pending.reset(new std::atomic<bool>[numParams]);
+        ring.reset(new std::atomic<int>[numParams]);
+        for (int i = 0; i < numParams; i++) {
+            values[i].store(0.0f, std::memory_order_relaxed);
+            pending[i].store(false, std::memory_order_relaxed);
+            ring[i].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    // wait-free, no allocation
+    void push(int index, float value) {
+        if (index < 0 || index >= numParams) {
+            return;
+        }
+        values[index].store(value, std::memory_order_relaxed);
+        if (!pending[index].exchange(true, std::memory_order_acq_rel)) {
+            auto slot = tail.fetch_add(1, std::memory_order_relaxed) % numParams;
+            ring[slot].store(index + 1, std::memory_order_release);
+        }
+    }
+
+    int pop(CVST_AutomationEvent *events, int maxEvents) {
+        int count = 0;
+        while (count < maxEvents && numParams > 0) {
+            auto &slot = ring[head % numParams];
+            auto entry = slot.load(std::memory_order_acquire);
+            if (entry == 0) {
+                break; // empty, or a producer is between claiming the slot and writing it
+            }
+            slot.store(0, std::memory_order_relaxed);
+            head++;
+            auto index = entry - 1;
+            // lower the flag before reading the value: a write racing with this either lands before the read,
+            // or re-raises the flag and is delivered by the next poll
+            pending[index].store(false, std::memory_order_seq_cst);
+            events[count].index = index;
+            events[count].value = values[index].load(std::memory_order_seq_cst);
+            count++;
+        }
+        return count;
+    }
+};
+
+#endif // __CVSTHOST_AUTOMATIONQUEUE_H__
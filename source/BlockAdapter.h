@@ -0,0 +1,73 @@
+#ifndef __CVSTHOST_BLOCKADAPTER_H__
+#define __CVSTHOST_BLOCKADAPTER_H__
+
+// (internal) per-plugin block size adapter, see CVST_SetBlockMode
+//
+// maximum: caller blocks bigger than blockSize are processed as several plugin blocks, no delay
+// fixed:   the plugin only ever sees blocks of exactly blockSize -- caller input collects in a FIFO until a whole block
+//          is there, and output is played out of a FIFO holding the previous block's result, so it's delayed by
+//          blockSize frames. the plugin's sample clock (samplePosition) stays at the start of the block being collected,
+//          'fill' frames behind the caller's
+// either way, MIDI is scheduled on the sample clock (so it lands in the right plugin block by itself), and parameter
+// changes are kept here by absolute position until the plugin block they fall in comes up.
+
+#include <stdint.h>
+#include <algorithm>
+#include <vector>
+#include "CVSTHost.h"
+
+struct BlockAdapter {
+    CVST_BlockMode mode = BlockMode_Passthrough;
+    int blockSize = 0;
+    int numInputs = 0, numOutputs = 0;
+    int fill = 0; // fixed: frames collected towards the next plugin block
+
+    std::vector<double> storage; // fixed: the FIFOs (inputs, then outputs, blockSize frames each), either precision
+    // plugin-side channel pointers, inputs then outputs: the FIFOs (fixed), or offset caller buffers (maximum)
+    std::vector<float *> floatPtrs;
+    std::vector<double *> doublePtrs;
+
+    // parameter changes not yet due, by absolute position on the sample clock
+    std::vector<CVST_ParameterChange> changes;
+    std::vector<uint64_t> changePositions;
+    int numChanges = 0;
+
+    void init(CVST_BlockMode mode, int blockSize, int numInputs, int numOutputs, int maxChanges) {
+        this->mode = mode;
+        this->blockSize = blockSize;
+        this->numInputs = numInputs;
+        this->numOutputs = numOutputs;
+        fill = 0;
+        numChanges = 0;
+        changes.resize(maxChanges);
+        changePositions.resize(maxChanges);
+        auto numChannels = numInputs + numOutputs;
+        floatPtrs.assign(numChannels, nullptr);
+        doublePtrs.assign(numChannels, nullptr);
+        if (mode == BlockMode_Fixed) {
+            storage.assign((size_t)numChannels * blockSize, 0.0);
+            for (int i = 0; i < numChannels; i++) {
+                floatPtrs[i] = (float *)&storage[(size_t)i * blockSize];
+                doublePtrs[i] = &storage[(size_t)i * blockSize];
+            }
+        }
+        else {
+            std::vector<double>().swap(storage);
+        }
+    }
+
+    // back to empty FIFOs (silence) and no pending changes
+    void reset() {
+        fill = 0;
+        numChanges = 0;
+        std::fill(storage.begin(), storage.end(), 0.0);
+    }
+
+    inline float **ptrs(float **) { return floatPtrs.data(); }
+    inline double **ptrs(double **) { return doublePtrs.data(); }
+
+    // delay added on top of the plugin's own
+    inline int latency() const { return mode == BlockMode_Fixed ? blockSize : 0; }
+};
+
+#endif // __CVSTHOST_BLOCKADAPTER_H__
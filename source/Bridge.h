@@ -0,0 +1,349 @@
+#ifndef __CVSTHOST_BRIDGE_H__
+#define __CVSTHOST_BRIDGE_H__
+
+// (internal) out-of-process plugin hosting, see CVST_LoadPluginBridged
+//
+// the plugin runs in a child process (bridge/source/CVSTBridge.cpp), and the host talks to it through one shared
+// BridgeRegion: audio is copied straight into/out of its sample area, and every call is a fixed BridgeMessage plus
+// whatever raw bytes the opcode's pointer refers to -- there is no serialization format beyond that.
+//
+// each channel is a single call slot, driven by its state word: the host posts a request, the child serves it and
+// replies; meanwhile the child may post any number of host callbacks (audioMasterGetTime etc), which the host serves
+// from the thread that is waiting on the request. there are two channels, so that the audio thread never queues behind
+// a slow control call: 'audio' carries processing, effProcessEvents and the audio threads' setParameter calls, 'control'
+// everything else (so setParameter from any other thread too).
+// neither effProcessEvents nor an audio thread's setParameter gets a round trip of its own: they wait in the audio payload,
+// and go with the next process request (parameter changes first, then the events) -- or ahead of any other call made from
+// that thread, so it never sees them not applied yet.
+// waiting spins briefly (when there is a core to spare), then blocks on the state word (futex), waking up every
+// BRIDGE_POLL_MS to check the other side is still alive.
+//
+// BridgeClient is the host side: a proxy AEffect whose functions forward to the child, so that _CVST_Plugin
+// drives it exactly like an in-process plugin.
+
+#include <stdint.h>
+#include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "../deps/VST2_SDK/pluginterfaces/vst2.x/aeffectx.h"
+#include "Platform.h"
+
+#define BRIDGE_MAX_CHANNELS 32 // audio channels each way
+#define BRIDGE_MAX_FRAMES 4096 // per transfer -- longer process calls are split
+#define BRIDGE_PAYLOAD_SIZE 65536 // per message direction (strings, events, small structs)
+#define BRIDGE_STRING_SIZE 256 // room for string replies (plugins routinely overrun the kVst*Len limits)
+#define BRIDGE_CHUNK_SIZE (16 << 20) // largest effGetChunk/effSetChunk that can cross (pages are only touched as used)
+// payload layout for events (and, on the audio channel, queued parameter changes): int32 event count, int32 change count,
+// the BridgeParameterChanges, then the VstMidiEvents
+#define BRIDGE_PARAMS_OFFSET 16
+#define BRIDGE_MAX_PARAMS 1024 // queued at once (more, and the queue is delivered early)
+#define BRIDGE_EVENTS_OFFSET (BRIDGE_PARAMS_OFFSET + BRIDGE_MAX_PARAMS * (int)sizeof(BridgeParameterChange))
+#define BRIDGE_MAX_EVENTS ((BRIDGE_PAYLOAD_SIZE - BRIDGE_EVENTS_OFFSET) / (int)sizeof(VstMidiEvent))
+#define BRIDGE_SPIN_ITERATIONS 20000 // ~10us of polling before blocking
+#define BRIDGE_POLL_MS 100
+#define BRIDGE_LOAD_TIMEOUT_MS 30000 // some plugins take their time (license checks ...)
+#define BRIDGE_EXIT_TIMEOUT_MS 2000
+
+struct BridgeParameterChange {
+    int32_t index;
+    float value;
+};
+
+enum BridgeState : uint32_t {
+    kBridgeIdle,
+    kBridgeRequest,      // host -> child
+    kBridgeCallback,     // child -> host, while serving a request
+    kBridgeCallbackDone, // host -> child
+    kBridgeReply         // child -> host
+};
+
+enum BridgeLoadState : uint32_t {
+    kBridgeLoading,
+    kBridgeLoaded,
+    kBridgeLoadFailed
+};
+
+enum BridgeCall : int32_t {
+    kBridgeDispatch,
+    kBridgeProcess,       // value: frames; payloadSize != 0: deliver the payload's parameter changes and events first
+    kBridgeProcessDouble,
+    kBridgeDeliver,       // only deliver them (they weren't followed by processing)
+    kBridgeSetParameter,
+    kBridgeGetParameter
+};
+
+// the AEffect fields that may change after loading (audioMasterIOChanged), refreshed with every callback and reply
+struct BridgeEffectInfo {
+    VstInt32 numPrograms, numParams, numInputs, numOutputs;
+    VstInt32 flags, initialDelay, uniqueID, version;
+};
+
+inline void bridgeGetEffectInfo(const AEffect *effect, BridgeEffectInfo *info) {
+    info->numPrograms = effect->numPrograms;
+    info->numParams = effect->numParams;
+    info->numInputs = effect->numInputs;
+    info->numOutputs = effect->numOutputs;
+    info->flags = effect->flags;
+    info->initialDelay = effect->initialDelay;
+    info->uniqueID = effect->uniqueID;
+    info->version = effect->version;
+}
+
+// requests, callbacks, and (in place) their replies
+struct BridgeMessage {
+    int32_t call; // BridgeCall (requests only)
+    VstInt32 opcode;
+    VstInt32 index;
+    float opt;
+    int64_t value;
+    int64_t result;
+    float floatResult;
+    uint32_t payloadSize; // bytes used in the payload, either way
+};
+
+struct BridgeChannel {
+    std::atomic<uint32_t> state; // BridgeState
+    BridgeMessage request, callback;
+    BridgeEffectInfo info;
+    alignas(16) char payload[BRIDGE_PAYLOAD_SIZE];
+    alignas(16) char callbackPayload[BRIDGE_PAYLOAD_SIZE];
+};
+
+// zero-filled on creation, which is a valid initial state for all of it
+struct BridgeRegion {
+    std::atomic<uint32_t> loadState; // BridgeLoadState
+    BridgeEffectInfo info;
+    alignas(64) BridgeChannel audio;
+    alignas(64) BridgeChannel control;
+    alignas(64) double samples[2 * BRIDGE_MAX_CHANNELS * BRIDGE_MAX_FRAMES]; // inputs, then outputs (float or double)
+    char chunk[BRIDGE_CHUNK_SIZE];
+};
+
+template <typename T>
+inline T *bridgeInput(BridgeRegion *region, int channel) {
+    return (T *)region->samples + (size_t)channel * BRIDGE_MAX_FRAMES;
+}
+
+template <typename T>
+inline T *bridgeOutput(BridgeRegion *region, int channel) {
+    return (T *)region->samples + (size_t)(BRIDGE_MAX_CHANNELS + channel) * BRIDGE_MAX_FRAMES;
+}
+
+// what an opcode's ptr argument refers to, which decides what gets copied across
+enum BridgePtrKind {
+    kBridgePtrNone,
+    kBridgePtrStringIn,
+    kBridgePtrStringOut,
+    kBridgePtrEvents,      // VstEvents * (MIDI events only)
+    kBridgePtrChunkOut,    // void ** to plugin-owned data (in the region's chunk area)
+    kBridgePtrChunkIn,     // value: size
+    kBridgePtrRectOut,     // ERect **
+    kBridgePtrTimeInfoOut, // (callbacks) VstTimeInfo * returned
+    kBridgePtrUnsupported
+};
+
+inline BridgePtrKind bridgeDispatchKind(VstInt32 opcode) {
+    switch (opcode) {
+    case effGetProgramName:
+    case effGetParamLabel:
+    case effGetParamDisplay:
+    case effGetParamName:
+    case effGetProgramNameIndexed:
+    case effGetEffectName:
+    case effGetVendorString:
+    case effGetProductString:
+    case effShellGetNextPlugin:
+        return kBridgePtrStringOut;
+    case effCanDo:
+    case effSetProgramName:
+    case effString2Parameter:
+        return kBridgePtrStringIn;
+    case effProcessEvents:
+        return kBridgePtrEvents;
+    case effGetChunk:
+        return kBridgePtrChunkOut;
+    case effSetChunk:
+        return kBridgePtrChunkIn;
+    case effEditGetRect:
+        return kBridgePtrRectOut;
+    case effEditOpen: // (a window can't be handed to another process portably)
+    case effGetParameterProperties:
+    case effGetInputProperties:
+    case effGetOutputProperties:
+    case effSetSpeakerArrangement:
+    case effGetSpeakerArrangement:
+    case effVendorSpecific:
+    case effBeginLoadBank:
+    case effBeginLoadProgram:
+    case effGetMidiProgramName:
+    case effGetCurrentMidiProgram:
+    case effGetMidiProgramCategory:
+    case effGetMidiKeyName:
+        return kBridgePtrUnsupported;
+    }
+    return kBridgePtrNone;
+}
+
+inline BridgePtrKind bridgeCallbackKind(VstInt32 opcode) {
+    switch (opcode) {
+    case audioMasterGetTime:
+        return kBridgePtrTimeInfoOut;
+    case audioMasterProcessEvents:
+        return kBridgePtrEvents;
+    case audioMasterGetVendorString:
+    case audioMasterGetProductString:
+        return kBridgePtrStringOut;
+    case audioMasterCanDo:
+        return kBridgePtrStringIn;
+    case audioMasterAutomate:
+    case audioMasterIdle:
+    case audioMasterGetSampleRate:
+    case audioMasterGetBlockSize:
+    case audioMasterGetInputLatency:
+    case audioMasterGetOutputLatency:
+    case audioMasterGetCurrentProcessLevel:
+    case audioMasterGetAutomationState:
+    case audioMasterIOChanged:
+    case audioMasterSizeWindow:
+    case audioMasterUpdateDisplay:
+    case audioMasterBeginEdit:
+    case audioMasterEndEdit:
+    case audioMasterGetVendorVersion:
+    case audioMasterGetLanguage:
+    case __audioMasterNeedIdleDeprecated:
+    case __audioMasterWantMidiDeprecated:
+        return kBridgePtrNone;
+    }
+    return kBridgePtrUnsupported;
+}
+
+// MIDI events <-> payload (anything else, eg sysex, is skipped); returns the number written
+inline int bridgeWriteEvents(char *payload, const VstEvents *events) {
+    auto dest = (VstMidiEvent *)(payload + BRIDGE_EVENTS_OFFSET);
+    int n = 0;
+    for (int i = 0; i < events->numEvents && n < BRIDGE_MAX_EVENTS; i++) {
+        if (events->events[i]->type == kVstMidiType) {
+            dest[n++] = *(const VstMidiEvent *)events->events[i];
+        }
+    }
+    *(int32_t *)payload = n;
+    return n;
+}
+
+// points 'events' (room for BRIDGE_MAX_EVENTS) at the payload's events
+inline VstEvents *bridgeReadEvents(char *payload, std::vector<char> &events) {
+    if (events.empty()) {
+        events.resize(sizeof(VstEvents) + sizeof(VstEvent *) * BRIDGE_MAX_EVENTS);
+    }
+    auto result = (VstEvents *)events.data();
+    auto source = (VstMidiEvent *)(payload + BRIDGE_EVENTS_OFFSET);
+    result->numEvents = std::max(0, std::min(*(int32_t *)payload, (int32_t)BRIDGE_MAX_EVENTS)); // (from the other process: clamped both ways)
+    result->reserved = 0;
+    for (int i = 0; i < result->numEvents; i++) {
+        result->events[i] = (VstEvent *)&source[i];
+    }
+    return result;
+}
+
+// queued parameter changes <-> payload
+inline int32_t &bridgeParameterCount(char *payload) {
+    return *(int32_t *)(payload + 4);
+}
+
+inline BridgeParameterChange *bridgeParameterChanges(char *payload) {
+    return (BridgeParameterChange *)(payload + BRIDGE_PARAMS_OFFSET);
+}
+
+inline bool bridgeCanSpin() {
+    static const bool canSpin = std::thread::hardware_concurrency() > 1;
+    return canSpin;
+}
+
+// waits for 'state' to move on from 'from', returns the new state -- or 'from' if stillAlive() says the other side is gone
+template <typename StillAlive>
+uint32_t bridgeWaitWhile(std::atomic<uint32_t> &state, uint32_t from, StillAlive stillAlive) {
+    if (bridgeCanSpin()) {
+        for (int i = 0; i < BRIDGE_SPIN_ITERATIONS; i++) {
+            auto current = state.load(std::memory_order_acquire);
+            if (current != from) {
+                return current;
+            }
+        }
+    }
+    while (true) {
+        platformWaitWord(&state, from, BRIDGE_POLL_MS);
+        auto current = state.load(std::memory_order_acquire);
+        if (current != from) {
+            return current;
+        }
+        if (!stillAlive()) {
+            return from;
+        }
+    }
+}
+
+inline void bridgePost(std::atomic<uint32_t> &state, uint32_t value) {
+    state.store(value, std::memory_order_release);
+    platformWakeWord(&state);
+}
+
+class BridgeClient {
+    AEffect effect; // the proxy (.object points back here)
+    audioMasterCallback host;
+    PlatformSharedMemory shm;
+    BridgeRegion *region;
+    PlatformProcess process;
+    std::atomic<bool> alive{ true };
+
+    struct Channel {
+        BridgeChannel *shared;
+        std::mutex mutex; // (uncontended unless several threads use the same channel)
+        std::vector<char> events; // VstEvents for callbacks
+    };
+    Channel audio, control;
+    // waiting in the audio payload for the next process request
+    bool eventsPending = false; // effProcessEvents
+    int parametersPending = 0; // setParameter from processing threads
+
+    // plugin-owned data, as returned across the bridge (valid until the next such call)
+    std::vector<char> chunk;
+    ERect rect;
+
+    BridgeClient(PlatformSharedMemory shm, PlatformProcess process, audioMasterCallback host);
+
+    void updateEffect(const BridgeEffectInfo &info);
+    bool transact(Channel &channel);
+    void serveCallback(Channel &channel);
+    void markDead();
+    inline bool pending() const { return eventsPending || parametersPending > 0; }
+    uint32_t takePending();
+    void flushPending();
+    void flushPendingFromHere();
+
+    template <typename T>
+    void processAudio(T **inputs, T **outputs, VstInt32 sampleFrames, BridgeCall call);
+
+    static VstIntPtr VSTCALLBACK dispatcherProc(AEffect *effect, VstInt32 opcode, VstInt32 index, VstIntPtr value, void *ptr, float opt);
+    static void VSTCALLBACK processReplacingProc(AEffect *effect, float **inputs, float **outputs, VstInt32 sampleFrames);
+    static void VSTCALLBACK processDoubleReplacingProc(AEffect *effect, double **inputs, double **outputs, VstInt32 sampleFrames);
+    static void VSTCALLBACK setParameterProc(AEffect *effect, VstInt32 index, float parameter);
+    static float VSTCALLBACK getParameterProc(AEffect *effect, VstInt32 index);
+
+public:
+    // spawns the bridge executable for the plugin and waits for it to load -- NULL (logged) if anything fails
+    static BridgeClient *load(const char *bridgePath, const char *pluginPath, audioMasterCallback host);
+    ~BridgeClient(); // ends the child process (send effClose first)
+
+    inline AEffect *getEffect() { return &effect; }
+    inline bool isAlive() const { return alive; }
+
+    VstIntPtr dispatch(VstInt32 opcode, VstInt32 index, VstIntPtr value, void *ptr, float opt);
+};
+
+// whether CVST_SetBridgePath has been given an executable (CVSTHost.cpp)
+bool bridgeAvailable();
+
+#endif // __CVSTHOST_BRIDGE_H__
@@ -0,0 +1,353 @@
+// BridgeClient.cpp : host side of the out-of-process bridge (see Bridge.h)
+
+#include "Bridge.h"
+
+#include <stdio.h>
+#include <string.h>
+#include "Log.h"
+
+BridgeClient::BridgeClient(PlatformSharedMemory shm, PlatformProcess process, audioMasterCallback host)
+    :host(host), shm(shm), process(process)
+{
+    region = (BridgeRegion *)shm.data;
+    audio.shared = &region->audio;
+    control.shared = &region->control;
+    memset(&rect, 0, sizeof(rect));
+
+    memset(&effect, 0, sizeof(effect));
+    effect.magic = kEffectMagic;
+    effect.object = this;
+    effect.dispatcher = dispatcherProc;
+    effect.processReplacing = processReplacingProc;
+    effect.processDoubleReplacing = processDoubleReplacingProc;
+    effect.setParameter = setParameterProc;
+    effect.getParameter = getParameterProc;
+    updateEffect(region->info);
+}
+
+BridgeClient::~BridgeClient()
+{
+    platformEndProcess(process, BRIDGE_EXIT_TIMEOUT_MS);
+    platformCloseSharedMemory(&shm);
+}
+
+BridgeClient *BridgeClient::load(const char *bridgePath, const char *pluginPath, audioMasterCallback host)
+{
+    static std::atomic<int> instanceCounter{ 0 };
+    auto pid = platformCurrentProcessId();
+    char name[64];
+    snprintf(name, sizeof(name), "cvstbridge-%d-%d", pid, instanceCounter++);
+
+    PlatformSharedMemory shm;
+    if (!platformCreateSharedMemory(name, sizeof(BridgeRegion), &shm)) {
+        logMessage(CVST_LogLevel_Error, "bridge: couldn't create the shared memory region");
+        return nullptr;
+    }
+    auto region = (BridgeRegion *)shm.data;
+
+    char pidArg[16];
+    snprintf(pidArg, sizeof(pidArg), "%d", pid);
+    const char *args[] = { name, pluginPath, pidArg, nullptr };
+    auto process = platformSpawnProcess(bridgePath, args);
+    if (!process) {
+        logFormat(CVST_LogLevel_Error, "bridge: couldn't start [%s]", bridgePath);
+        platformCloseSharedMemory(&shm);
+        platformUnlinkSharedMemory(name);
+        return nullptr;
+    }
+
+    auto loadState = region->loadState.load(std::memory_order_acquire);
+    for (int waited = 0; loadState == kBridgeLoading && waited < BRIDGE_LOAD_TIMEOUT_MS; waited += BRIDGE_POLL_MS) {
+        platformWaitWord(&region->loadState, kBridgeLoading, BRIDGE_POLL_MS);
+        loadState = region->loadState.load(std::memory_order_acquire);
+        if (loadState == kBridgeLoading && !platformProcessRunning(process)) {
+            break;
+        }
+    }
+    platformUnlinkSharedMemory(name); // both sides have it open by now (or never will)
+    if (loadState != kBridgeLoaded) {
+        logMessage(CVST_LogLevel_Error, loadState == kBridgeLoadFailed ? "bridge: the plugin failed to load" : "bridge: the bridge process died or timed out while loading");
+        platformEndProcess(process, 0);
+        platformCloseSharedMemory(&shm);
+        return nullptr;
+    }
+    if (region->info.numInputs > BRIDGE_MAX_CHANNELS || region->info.numOutputs > BRIDGE_MAX_CHANNELS) {
+        logFormat(CVST_LogLevel_Warning, "bridge: only the first %d channels (of %d in / %d out) cross, the rest are silent", BRIDGE_MAX_CHANNELS,
+            region->info.numInputs, region->info.numOutputs);
+    }
+    logFormat(CVST_LogLevel_Info, "bridge: [%s] is up", pluginPath);
+    return new BridgeClient(shm, process, host);
+}
+
+// threads that have processed a bridged plugin (see setParameterProc)
+static thread_local bool processingThread = false;
+
+void BridgeClient::updateEffect(const BridgeEffectInfo &info)
+{
+    effect.numPrograms = info.numPrograms;
+    effect.numParams = info.numParams;
+    effect.numInputs = info.numInputs;
+    effect.numOutputs = info.numOutputs;
+    effect.flags = info.flags & ~effFlagsHasEditor; // (see effEditOpen in bridgeDispatchKind)
+    effect.initialDelay = info.initialDelay;
+    effect.uniqueID = info.uniqueID;
+    effect.version = info.version;
+}
+
+void BridgeClient::markDead()
+{
+    if (alive.exchange(false)) {
+        logMessage(CVST_LogLevel_Error, "bridge: the plugin's process died, it will be silent from now on");
+    }
+}
+
+// posts the channel's request and serves callbacks until the reply -- false if the child is gone
+bool BridgeClient::transact(Channel &channel)
+{
+    if (!alive) {
+        return false;
+    }
+    auto &state = channel.shared->state;
+    uint32_t posted = kBridgeRequest;
+    bridgePost(state, posted);
+    while (true) {
+        auto current = bridgeWaitWhile(state, posted, [this]() { return platformProcessRunning(process); });
+        if (current == posted) {
+            markDead();
+            return false;
+        }
+        updateEffect(channel.shared->info);
+        if (current == kBridgeReply) {
+            return true;
+        }
+        serveCallback(channel);
+        posted = kBridgeCallbackDone;
+        bridgePost(state, posted);
+    }
+}
+
+void BridgeClient::serveCallback(Channel &channel)
+{
+    auto &message = channel.shared->callback;
+    auto payload = channel.shared->callbackPayload;
+    void *ptr = nullptr;
+    auto kind = bridgeCallbackKind(message.opcode);
+    switch (kind) {
+    case kBridgePtrEvents:
+        ptr = bridgeReadEvents(payload, channel.events);
+        break;
+    case kBridgePtrStringIn:
+        payload[BRIDGE_PAYLOAD_SIZE - 1] = 0;
+        ptr = payload;
+        break;
+    case kBridgePtrStringOut:
+        payload[0] = 0;
+        ptr = payload;
+        break;
+    default:
+        break;
+    }
+    message.result = host(&effect, message.opcode, message.index, (VstIntPtr)message.value, ptr, message.opt);
+    message.payloadSize = 0;
+    if (kind == kBridgePtrTimeInfoOut && message.result) {
+        memcpy(payload, (const void *)(VstIntPtr)message.result, sizeof(VstTimeInfo));
+        message.payloadSize = sizeof(VstTimeInfo);
+    }
+    else if (kind == kBridgePtrStringOut) {
+        payload[BRIDGE_STRING_SIZE - 1] = 0;
+        message.payloadSize = (uint32_t)strlen(payload) + 1;
+    }
+}
+
+VstIntPtr BridgeClient::dispatch(VstInt32 opcode, VstInt32 index, VstIntPtr value, void *ptr, float opt)
+{
+    auto kind = bridgeDispatchKind(opcode);
+    if (kind == kBridgePtrUnsupported || (kind == kBridgePtrNone && ptr)) {
+        logOpcode(CVST_LogLevel_Warning, kLogEffect, opcode, "bridge: opcode %d isn't supported across processes", opcode);
+        return 0;
+    }
+    if (kind == kBridgePtrChunkIn && (size_t)value > BRIDGE_CHUNK_SIZE) {
+        logOpcode(CVST_LogLevel_Error, kLogEffect, opcode, "bridge: chunk too large (%d bytes)", (int)value);
+        return 0;
+    }
+
+    if (opcode == effProcessEvents) {
+        // hosts send events right before processing, so they ride along with the next process request (saving a round trip)
+        std::lock_guard<std::mutex> lock(audio.mutex);
+        if (eventsPending) {
+            flushPending();
+        }
+        auto events = (const VstEvents *)ptr;
+        auto numWritten = bridgeWriteEvents(audio.shared->payload, events);
+        if (numWritten < events->numEvents) {
+            logOpcode(CVST_LogLevel_Debug, kLogEffect, opcode, "bridge: only MIDI events cross (and at most %d per call)", BRIDGE_MAX_EVENTS);
+        }
+        eventsPending = true;
+        return 1;
+    }
+
+    flushPendingFromHere();
+    auto &channel = control;
+    std::lock_guard<std::mutex> lock(channel.mutex);
+    auto &message = channel.shared->request;
+    auto payload = channel.shared->payload;
+    message.call = kBridgeDispatch;
+    message.opcode = opcode;
+    message.index = index;
+    message.value = value;
+    message.opt = opt;
+    message.payloadSize = 0;
+    switch (kind) {
+    case kBridgePtrStringIn:
+        if (ptr) {
+            auto length = std::min(strlen((const char *)ptr), (size_t)BRIDGE_PAYLOAD_SIZE - 1);
+            memcpy(payload, ptr, length);
+            payload[length] = 0;
+            message.payloadSize = (uint32_t)length + 1;
+        }
+        break;
+    case kBridgePtrChunkIn:
+        memcpy(region->chunk, ptr, (size_t)value);
+        break;
+    default:
+        break;
+    }
+
+    if (!transact(channel)) {
+        return 0;
+    }
+
+    switch (kind) {
+    case kBridgePtrStringOut:
+        memcpy(ptr, payload, std::min(message.payloadSize, (uint32_t)BRIDGE_STRING_SIZE));
+        break;
+    case kBridgePtrChunkOut:
+        chunk.assign(region->chunk, region->chunk + std::max(message.result, (int64_t)0));
+        *(void **)ptr = chunk.data();
+        break;
+    case kBridgePtrRectOut:
+        if (message.payloadSize == sizeof(ERect)) {
+            memcpy(&rect, payload, sizeof(ERect));
+        }
+        *(ERect **)ptr = &rect;
+        break;
+    default:
+        break;
+    }
+    return (VstIntPtr)message.result;
+}
+
+// completes the audio payload's header for a request, and hands over what's queued: the payloadSize to send
+// (with the audio channel locked)
+uint32_t BridgeClient::takePending()
+{
+    auto payload = audio.shared->payload;
+    if (!eventsPending) {
+        *(int32_t *)payload = 0;
+    }
+    bridgeParameterCount(payload) = parametersPending;
+    auto size = pending() ? 1 : 0;
+    eventsPending = false;
+    parametersPending = 0;
+    return size;
+}
+
+// what's queued, without processing (with the audio channel locked)
+void BridgeClient::flushPending()
+{
+    auto &message = audio.shared->request;
+    message.call = kBridgeDeliver;
+    message.payloadSize = takePending();
+    transact(audio);
+}
+
+// before any other call from a processing thread, so that it sees its own changes applied
+void BridgeClient::flushPendingFromHere()
+{
+    if (!processingThread) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(audio.mutex);
+    if (pending()) {
+        flushPending();
+    }
+}
+
+template <typename T>
+void BridgeClient::processAudio(T **inputs, T **outputs, VstInt32 sampleFrames, BridgeCall call)
+{
+    processingThread = true;
+    std::lock_guard<std::mutex> lock(audio.mutex);
+    auto &message = audio.shared->request;
+    for (VstInt32 offset = 0; offset < sampleFrames; offset += BRIDGE_MAX_FRAMES) {
+        auto frames = std::min(sampleFrames - offset, (VstInt32)BRIDGE_MAX_FRAMES);
+        auto numInputs = std::min(effect.numInputs, BRIDGE_MAX_CHANNELS);
+        for (int i = 0; i < numInputs; i++) {
+            memcpy(bridgeInput<T>(region, i), inputs[i] + offset, frames * sizeof(T));
+        }
+        message.call = call;
+        message.value = frames;
+        message.payloadSize = takePending(); // (with the first part, if it's split)
+        auto ok = transact(audio);
+        // (the plugin may have changed its outputs meanwhile -- this has the current count)
+        for (int i = 0; i < effect.numOutputs; i++) {
+            if (ok && i < BRIDGE_MAX_CHANNELS) {
+                memcpy(outputs[i] + offset, bridgeOutput<T>(region, i), frames * sizeof(T));
+            }
+            else {
+                memset(outputs[i] + offset, 0, frames * sizeof(T));
+            }
+        }
+    }
+}
+
+VstIntPtr VSTCALLBACK BridgeClient::dispatcherProc(AEffect *effect, VstInt32 opcode, VstInt32 index, VstIntPtr value, void *ptr, float opt)
+{
+    return ((BridgeClient *)effect->object)->dispatch(opcode, index, value, ptr, opt);
+}
+
+void VSTCALLBACK BridgeClient::processReplacingProc(AEffect *effect, float **inputs, float **outputs, VstInt32 sampleFrames)
+{
+    ((BridgeClient *)effect->object)->processAudio(inputs, outputs, sampleFrames, kBridgeProcess);
+}
+
+void VSTCALLBACK BridgeClient::processDoubleReplacingProc(AEffect *effect, double **inputs, double **outputs, VstInt32 sampleFrames)
+{
+    ((BridgeClient *)effect->object)->processAudio(inputs, outputs, sampleFrames, kBridgeProcessDouble);
+}
+
+void VSTCALLBACK BridgeClient::setParameterProc(AEffect *effect, VstInt32 index, float parameter)
+{
+    // from a thread that processes, in line with the audio: queued to go with the next process request (sample-accurate
+    // changes come right before their block, and a block's worth shouldn't cost a round trip each); from anywhere else
+    // over the control channel, so that a GUI or automation thread never holds up the audio channel
+    auto client = (BridgeClient *)effect->object;
+    if (processingThread) {
+        std::lock_guard<std::mutex> lock(client->audio.mutex);
+        if (client->parametersPending == BRIDGE_MAX_PARAMS) {
+            client->flushPending();
+        }
+        auto &change = bridgeParameterChanges(client->audio.shared->payload)[client->parametersPending++];
+        change.index = index;
+        change.value = parameter;
+        return;
+    }
+    std::lock_guard<std::mutex> lock(client->control.mutex);
+    auto &message = client->control.shared->request;
+    message.call = kBridgeSetParameter;
+    message.index = index;
+    message.opt = parameter;
+    client->transact(client->control);
+}
+
+float VSTCALLBACK BridgeClient::getParameterProc(AEffect *effect, VstInt32 index)
+{
+    auto client = (BridgeClient *)effect->object;
+    client->flushPendingFromHere();
+    std::lock_guard<std::mutex> lock(client->control.mutex);
+    auto &message = client->control.shared->request;
+    message.call = kBridgeGetParameter;
+    message.index = index;
+    message.floatResult = 0.0f;
+    return client->transact(client->control) ? message.floatResult : 0.0f;
+}
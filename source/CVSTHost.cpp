@@ -0,0 +1,1646 @@
+// CVSTHost.cpp : Defines the exported functions for the DLL application.
+// (platform-neutral -- OS-specific bits are behind Platform.h)
+
+#include "CVSTHost.h"
+
+#include <string>
+#include <assert.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include "../deps/VST2_SDK/pluginterfaces/vst2.x/aeffectx.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#define PRODUCT_STRING "SOMEPRODUCT"
+#define VENDOR_STRING "SOMEVENDOR"
+
+#include "CanDos.h"
+
+#include "Platform.h"
+#include "SampleFormat.h"
+#include "AutomationQueue.h"
+#include "ParameterShadow.h"
+#include "EventTimeline.h"
+#include "Transport.h"
+#include "Stats.h"
+#include "Bridge.h"
+#include "StateLoad.h"
+#include "BlockAdapter.h"
+#include "Oversampler.h"
+#include "Sleep.h"
+#include "Denormals.h"
+#include "Log.h"
+
+#define OFFLINE_DEFAULT_BLOCK_SIZE 4096 // big enough to amortize per-call overhead, small enough to stay in cache
+
+#define DEFAULT_EVENT_CAPACITY 1024 // far beyond what would ever normally appear in a single low-latency buffer (~256 samples or so)
+#define MAX_PARAMETER_CHANGES 1024 // per block
+#define DEFAULT_MIN_SUB_BLOCK_LENGTH 32 // frames -- bounds the number of processReplacing calls a block can be split into
+#define PARAMETER_TEXT_SIZE 256 // far beyond kVstMaxParamStrLen, which plugins tend to ignore
+#define CACHE_LINE_SIZE 64
+
+static CVST_EventCallback apiClientCallback = nullptr;
+static std::string bridgePath; // see CVST_SetBridgePath
+
+// MIDI storage, only allocated for plugins that take or send events (most effects do neither) -- see CVST_SetEventCapacity
+struct EventStorage {
+    int inputCapacity, outputCapacity;
+
+    // storage for the actual events, and the VstEvents that gets sent to the plugin
+    //   (its .events pointers are set when sending: each (sub-)block's run of events is pointed to from the front)
+    std::vector<VstMidiEvent> midi;
+    std::unique_ptr<char[]> vstEventsMemory; // VstEvents header + inputCapacity pointers
+    VstEvents *vstEvents = nullptr;
+
+    // scheduled events, each process call sends the ones falling in its block
+    EventTimeline timeline;
+
+    // events the plugin sent us (audioMasterProcessEvents) during the last process call, see CVST_GetOutputEvents
+    std::vector<CVST_MidiEvent> output;
+
+    EventStorage(int inputCapacity, int outputCapacity)
+        :inputCapacity(inputCapacity), outputCapacity(outputCapacity)
+    {
+        if (inputCapacity > 0) {
+            midi.resize(inputCapacity);
+            for (auto &vme : midi) {
+                vme.type = kVstMidiType;
+                vme.byteSize = sizeof(VstMidiEvent);
+                vme.flags = kVstMidiEventIsRealtime;
+            }
+            // VstEvents declares events[2]
+            vstEventsMemory.reset(new char[sizeof(VstEvents) + sizeof(VstEvent *) * std::max(inputCapacity - 2, 0)]);
+            vstEvents = (VstEvents *)vstEventsMemory.get();
+            vstEvents->reserved = 0;
+            timeline.init(inputCapacity);
+        }
+        output.resize(outputCapacity);
+    }
+};
+
+// what every process call reads to find its way through the block (and most of what it writes), on a cache line of
+// its own -- so a host running many plugins per block touches one line per plugin before its audio
+struct alignas(CACHE_LINE_SIZE) HotState {
+    AEffect *effect = nullptr; // (called through _CVST_Plugin's wrappers; swapped by state loads, see swapEffect)
+    std::unique_ptr<EventStorage> events; // null for plugins without MIDI
+    uint64_t samplePosition = 0; // start of the next block, advanced by every process call
+    float sampleRate = 44100.0f; // (the host's, for the transport)
+    int pendingParameterChanges = 0; // sample-accurate parameter changes for the next process call
+    int minSubBlockLength = DEFAULT_MIN_SUB_BLOCK_LENGTH;
+    int numOutputEvents = 0;
+    unsigned int subBlockStart = 0; // start of the sub-block being processed (relative to the block)
+    std::atomic<bool> processing{ false }; // inside a process call -- only then are output events captured, time info updated
+    std::atomic<bool> renderingOffline{ false }; // reported via audioMasterGetCurrentProcessLevel, possibly from other threads
+    std::atomic<bool> stateLoadPending{ false }; // a CVST_SetChunkAsync not settled yet (only then is stateLoad looked at)
+    bool nativeDoublePrecision = false;
+    bool adapted = false; // blockAdapter.mode isn't passthrough
+    bool sleepEnabled = false; // CVST_SetSleepMode
+    bool wantsIdle = false;
+    bool editorOpen = false;
+};
+static_assert(sizeof(HotState) == CACHE_LINE_SIZE, "HotState has outgrown its cache line");
+
+struct _CVST_Plugin {
+    HotState hot; // (first, and the allocation is aligned for it -- see operator new)
+
+    // everything else: touched occasionally, or only by the stages a block actually goes through
+    void *userData = nullptr;
+    PlatformLibrary libraryHandle = NULL;
+    std::unique_ptr<BridgeClient> bridge; // out-of-process: 'effect' is the bridge's proxy
+    std::string path; // for loading further instances (CVST_SetChunkAsync)
+    //bool loaded = false;
+    bool isInstrument = false;
+
+    std::vector<CVST_ParameterChange> parameterChanges;
+    std::vector<float *> subBlockInputs, subBlockOutputs; // offset buffer pointers for the sub-blocks
+    std::vector<double *> subBlockInputs64, subBlockOutputs64;
+
+    AutomationQueue automation;
+    ParameterShadow parameters;
+
+    Transport transport;
+    PluginStats stats;
+
+    StateLoad stateLoad; // CVST_SetChunkAsync
+    BlockAdapter blockAdapter; // CVST_SetBlockMode
+    Oversampler oversampler; // CVST_SetOversampling
+    SleepState sleep; // CVST_SetSleepMode
+
+    // current processing setup, so it can be temporarily renegotiated (eg for offline rendering -- the rate is in 'hot')
+    int blockSize = 0;
+    bool resumed = false;
+
+    // 64-bit processing: native if the plugin can (and was asked to), otherwise converted through these float buffers
+    bool wantsDoublePrecision = false;
+    int fallbackCapacity = 0; // frames per channel
+    std::vector<float> fallbackStorage;
+    std::vector<float *> fallbackInputs;
+    std::vector<float *> fallbackOutputs;
+
+    _CVST_Plugin(AEffect *effect) {
+        hot.effect = effect;
+        effect->resvd1 = (VstIntPtr)this;
+
+        automation.init(effect->numParams);
+        parameters.init(effect->numParams);
+        parameterChanges.resize(MAX_PARAMETER_CHANGES);
+        allocSubBlockPointers();
+    }
+
+    // (state loads) makes 'incoming' the instance behind this plugin, returns the previous one
+    AEffect *swapEffect(AEffect *incoming) {
+        auto previous = hot.effect;
+        incoming->resvd1 = (VstIntPtr)this;
+        hot.effect = incoming;
+        return previous;
+    }
+
+    // (C++14's new doesn't honour alignments beyond the default one: over-allocated, and aligned here)
+    static void *operator new(size_t size) {
+        auto raw = ::operator new(size + CACHE_LINE_SIZE);
+        auto aligned = (void **)(((uintptr_t)raw + CACHE_LINE_SIZE) & ~(uintptr_t)(CACHE_LINE_SIZE - 1));
+        aligned[-1] = raw; // (there's at least the default alignment's worth of room in front)
+        return aligned;
+    }
+    static void operator delete(void *ptr) {
+        ::operator delete(((void **)ptr)[-1]);
+    }
+
+    inline VstIntPtr dispatcher(VstInt32 opcode, VstInt32 index, VstIntPtr value, void* ptr, float opt) {
+        return hot.effect->dispatcher(hot.effect, opcode, index, value, ptr, opt);
+    }
+    inline void processReplacing(float** inputs, float** outputs, VstInt32 sampleFrames) {
+        hot.effect->processReplacing(hot.effect, inputs, outputs, sampleFrames);
+    }
+    inline void processDoubleReplacing(double** inputs, double** outputs, VstInt32 sampleFrames) {
+        hot.effect->processDoubleReplacing(hot.effect, inputs, outputs, sampleFrames);
+    }
+    inline void setParameter(VstInt32 index, float parameter) {
+        hot.effect->setParameter(hot.effect, index, parameter);
+        parameters.set(index, parameter);
+    }
+    inline float getParameter(VstInt32 index) {
+        return hot.effect->getParameter(hot.effect, index);
+    }
+
+    inline int getNumInputs() { return hot.effect->numInputs; }
+    inline int getNumOutputs() { return hot.effect->numOutputs; }
+    inline int getNumParams() { return hot.effect->numParams; }
+    inline int getNumPrograms() { return hot.effect->numPrograms; }
+    inline int getUniqueID() { return hot.effect->uniqueID; }
+    inline int getVersion() { return hot.effect->version; }
+    inline int getFlags() { return hot.effect->flags; }
+    inline int getInitialDelay() { return hot.effect->initialDelay; }
+    inline bool canDoubleReplacing() {
+        return (hot.effect->flags & effFlagsCanDoubleReplacing) && hot.effect->processDoubleReplacing;
+    }
+
+    // frames per plugin call for caller blocks of 'blockSize', at the host rate (the block mode may cap it)
+    inline int adaptedBlockSize(int blockSize) const {
+        if (blockAdapter.mode == BlockMode_Fixed) {
+            return blockAdapter.blockSize;
+        }
+        if (blockAdapter.mode == BlockMode_Maximum) {
+            return std::min(blockSize, blockAdapter.blockSize);
+        }
+        return blockSize;
+    }
+
+    void allocSubBlockPointers() {
+        subBlockInputs.resize(getNumInputs());
+        subBlockOutputs.resize(getNumOutputs());
+        subBlockInputs64.resize(getNumInputs());
+        subBlockOutputs64.resize(getNumOutputs());
+    }
+
+    void allocDoubleFallback(int frames) {
+        auto numInputs = getNumInputs(), numOutputs = getNumOutputs();
+        fallbackStorage.assign((size_t)(numInputs + numOutputs) * frames, 0.0f);
+        fallbackInputs.resize(numInputs);
+        fallbackOutputs.resize(numOutputs);
+        for (int i = 0; i < numInputs; i++) {
+            fallbackInputs[i] = &fallbackStorage[(size_t)i * frames];
+        }
+        for (int i = 0; i < numOutputs; i++) {
+            fallbackOutputs[i] = &fallbackStorage[(size_t)(numInputs + i) * frames];
+        }
+        fallbackCapacity = frames;
+    }
+};
+
+static const char *vendor_str = "(VENDOR)";
+static const char *product_str = "(PRODUCT)";
+static int vendor_version = -1;
+
+CVSTHOST_API void CDECL CVST_Init(CVST_EventCallback callback)
+{
+    apiClientCallback = callback;
+    logSetClientCallback(callback);
+    logMessage(CVST_LogLevel_Info, "Hello from CVST_Init"); // only after we set the callback :P
+
+                                      // get some global info up front
+    CVST_HostEvent hostEvent;
+    hostEvent.handled = false;
+    hostEvent.eventType = CVST_EventType_GetVendorInfo;
+    apiClientCallback(&hostEvent, nullptr, nullptr);
+    if (hostEvent.handled) {
+        vendor_str = strdup(hostEvent.vendorInfoEvent.vendor);
+        product_str = strdup(hostEvent.vendorInfoEvent.product);
+        vendor_version = hostEvent.vendorInfoEvent.version;
+        logFormat(CVST_LogLevel_Info, "got product info: %s: %s (ver %d)", vendor_str, product_str, vendor_version);
+    }
+    drainLog();
+}
+
+CVSTHOST_API void CDECL CVST_Shutdown()
+{
+    logMessage(CVST_LogLevel_Info, "Goodbye from CVST_Shutdown");
+    drainLog();
+    logSetClientCallback(nullptr);
+    apiClientCallback = nullptr;
+}
+
+typedef AEffect *(*vstPluginFuncPtr)(audioMasterCallback host);
+
+// truncating copy that always terminates (stand-in for strncpy_s, which isn't available outside MSVC)
+static void copyString(char *dest, size_t destLen, const char *source)
+{
+    auto length = std::min(strlen(source), destLen - 1);
+    memcpy(dest, source, length);
+    dest[length] = 0;
+}
+
+// converts MIDI events sent by the plugin to block-relative CVST_MidiEvents (anything else, eg sysex, is skipped)
+static void captureOutputEvents(CVST_Plugin plugin, VstEvents *events)
+{
+    if (!plugin->hot.events || plugin->hot.events->outputCapacity == 0) {
+        logOpcode(CVST_LogLevel_Debug, kLogAudioMaster, audioMasterProcessEvents, "plugin sent events without saying it would (see CVST_SetEventCapacity), dropped");
+        return;
+    }
+    auto &output = plugin->hot.events->output;
+    for (int i = 0; i < events->numEvents && plugin->hot.numOutputEvents < plugin->hot.events->outputCapacity; i++) {
+        auto event = events->events[i];
+        if (event->type != kVstMidiType) {
+            continue;
+        }
+        auto &dest = output[plugin->hot.numOutputEvents++];
+        dest.sampleOffs = plugin->hot.subBlockStart + std::max(event->deltaFrames, 0) / plugin->oversampler.factor;
+        memcpy(dest.data.bytes, ((VstMidiEvent *)event)->midiData, 4);
+    }
+}
+
+VstIntPtr VSTCALLBACK hostCallback(AEffect* effect, VstInt32 opcode, VstInt32 index, VstIntPtr value, void* ptr, float opt)
+{
+    CVST_Plugin plugin = effect ? (CVST_Plugin)effect->resvd1 : NULL;
+
+    // a few messages can be handled with or without a valid plugin ptr
+    // (notice these all return directly)
+    switch (opcode) {
+    case audioMasterVersion:
+        return kVstVersion;
+
+    case audioMasterGetCurrentProcessLevel:
+        return (plugin && plugin->hot.renderingOffline) ? kVstProcessLevelOffline : kVstProcessLevelRealtime;
+
+    case audioMasterGetVendorString:
+        copyString((char *)ptr, kVstMaxVendorStrLen, vendor_str); // vendor_str and product_str are prefetched upon CVSTInit
+        return true;
+
+    case audioMasterGetProductString:
+        copyString((char *)ptr, kVstMaxProductStrLen, product_str);
+        return true;
+
+    case audioMasterGetVendorVersion:
+        return vendor_version;
+
+    case audioMasterUpdateDisplay:
+        logOpcode(CVST_LogLevel_Debug, kLogAudioMaster, opcode, "audioMasterUpdateDisplay");
+        if (plugin) {
+            plugin->parameters.textStale = true;
+        }
+        return true;
+
+    case audioMasterGetTime:
+        if (!plugin) {
+            return 0;
+        }
+        // outside of processing (eg from the UI thread), whatever the last block had
+        return (VstIntPtr)(plugin->hot.processing ? plugin->transport.getTimeInfo((VstInt32)value, plugin->hot.sampleRate)
+            : plugin->transport.getLastTimeInfo());
+    }
+
+    // some plugins are jerks and send us things like automation messages before we even have an AEffect (from the first call to mainEntryPoint)
+    // thus there won't be a CVstPlugin instance associated with it yet (gotten from ->resvd1 above)
+    // hence the 'if' filter below ...
+    if (plugin) {
+        switch (opcode) {
+        case audioMasterIdle:
+            // not sure what to do here ...
+            // discussion https://www.kvraudio.com/forum/viewtopic.php?t=349866
+            break;
+        case __audioMasterWantMidiDeprecated: // ??
+            break;
+        case __audioMasterNeedIdleDeprecated:
+            plugin->hot.wantsIdle = true; // send effIdle on idle pulse
+            break;
+        case audioMasterAutomate:
+            // frequently the audio thread -- queued for CVST_PollAutomation rather than calling out to the client here
+            plugin->automation.push(index, opt);
+            plugin->parameters.set(index, opt);
+            break;
+        case audioMasterBeginEdit:
+            logOpcode(CVST_LogLevel_Debug, kLogAudioMaster, opcode, "edit param %d BEGIN", index);
+            break;
+        case audioMasterEndEdit:
+            logOpcode(CVST_LogLevel_Debug, kLogAudioMaster, opcode, "edit param %d END", index);
+            break;
+        case audioMasterIOChanged:
+            // (the latency is read from initialDelay whenever asked, see CVST_GetLatency)
+            logOpcode(CVST_LogLevel_Info, kLogAudioMaster, opcode, "audioMasterIOChanged event, latency now %d", plugin->getInitialDelay());
+            break;
+        case audioMasterProcessEvents: {
+            auto events = (VstEvents*)ptr;
+            if (!plugin->hot.processing) {
+                // eg from the plugin's UI thread -- no block to attach them to
+                logOpcode(CVST_LogLevel_Debug, kLogAudioMaster, opcode, "dropped %d VstEvents sent from outside processing", events->numEvents);
+                break;
+            }
+            captureOutputEvents(plugin, events);
+            return 1;
+        }
+        case audioMasterCanDo: {
+            auto canDo = (const char*)ptr;
+            logOpcode(CVST_LogLevel_Debug, kLogAudioMaster, opcode, "audioMasterCanDo [%s]?", canDo);
+            if (!strcmp(canDo, HostCanDos::canDoOffline) ||
+                !strcmp(canDo, HostCanDos::canDoSendVstEvents) ||
+                !strcmp(canDo, HostCanDos::canDoSendVstMidiEvent) ||
+                !strcmp(canDo, HostCanDos::canDoSendVstTimeInfo) ||
+                !strcmp(canDo, HostCanDos::canDoReceiveVstEvents) ||
+                !strcmp(canDo, HostCanDos::canDoReceiveVstMidiEvent))
+            {
+                return 1;
+            }
+            return 0; // for now, until we handle these individually
+        }
+        case audioMasterGetSampleRate:
+            return (VstIntPtr)(plugin->hot.sampleRate * plugin->oversampler.factor);
+        case audioMasterGetBlockSize:
+            return plugin->adaptedBlockSize(plugin->blockSize) * plugin->oversampler.factor;
+        default:
+            logOpcode(CVST_LogLevel_Warning, kLogAudioMaster, opcode, "unhandled vst host opcode (with plugin): %d", opcode);
+            return false; // unhandled by default
+        }
+        return true; // unless otherwise specified
+    }
+    else {
+        switch (opcode) {
+            // these all definitely require a plugin instance, so silence them
+        case audioMasterAutomate:
+            break;
+        default:
+            logOpcode(CVST_LogLevel_Warning, kLogAudioMaster, opcode, "unhandled vst host opcode (null plugin): %d", opcode);
+        }
+    }
+    return 0;
+}
+
+// re-reads every parameter into the shadow, after the plugin's state changed wholesale (marking what differs as changed)
+static void refreshParameters(CVST_Plugin plugin)
+{
+    for (int i = 0; i < plugin->parameters.size(); i++) {
+        plugin->parameters.set(i, plugin->getParameter(i));
+    }
+}
+
+// the _CVST_Plugin for a freshly loaded effect (in-process, or a bridge's proxy)
+static CVST_Plugin wrapEffect(AEffect *effect, void *userData)
+{
+    auto ret = new _CVST_Plugin(effect);
+    ret->userData = userData;
+    ret->hot.editorOpen = false;
+    ret->isInstrument = false;
+
+    if (ret->dispatcher(effCanDo, 0, 0, (void *)PlugCanDos::canDoReceiveVstMidiEvent, 0.0f) == 1) {
+        ret->isInstrument = true;
+    }
+    // event storage only for plugins that say they use it -- the rest can ask for it with CVST_SetEventCapacity
+    auto sendsEvents = ret->dispatcher(effCanDo, 0, 0, (void *)PlugCanDos::canDoSendVstMidiEvent, 0.0f) == 1 ||
+        ret->dispatcher(effCanDo, 0, 0, (void *)PlugCanDos::canDoSendVstEvents, 0.0f) == 1;
+    if (ret->isInstrument || sendsEvents) {
+        ret->hot.events.reset(new EventStorage(ret->isInstrument ? DEFAULT_EVENT_CAPACITY : 0, sendsEvents ? DEFAULT_EVENT_CAPACITY : 0));
+    }
+    refreshParameters(ret);
+    ret->parameters.clearChanged(); // (nothing has changed yet, as far as the client is concerned)
+    return ret;
+}
+
+// loads the library and calls its entry point -- NULL (and logged) if either fails
+static AEffect *openEffect(const char *pathToPlugin, PlatformLibrary *library)
+{
+    auto libHandle = platformLoadLibrary(pathToPlugin);
+    if (libHandle == NULL) {
+        logFormat(CVST_LogLevel_Error, "library not found / load failed: %s", platformLastError());
+        return NULL;
+    }
+
+    vstPluginFuncPtr mainEntryPoint;
+
+    mainEntryPoint = (vstPluginFuncPtr)platformGetSymbol(libHandle, "VSTPluginMain");
+    if (!mainEntryPoint) {
+        logMessage(CVST_LogLevel_Info, "'VSTPluginMain' entry point not found, trying 'main'");
+        mainEntryPoint = (vstPluginFuncPtr)platformGetSymbol(libHandle, "main");
+        if (!mainEntryPoint) {
+            logMessage(CVST_LogLevel_Error, "'main' entry point not found, either");
+            platformFreeLibrary(libHandle);
+            return NULL;
+        }
+    }
+
+    logFormat(CVST_LogLevel_Debug, "main entry point: %p", (void *)mainEntryPoint);
+
+    auto effect = mainEntryPoint(hostCallback);
+    logFormat(CVST_LogLevel_Debug, "mplugin: %p", (void *)effect);
+    if (!effect || effect->magic != kEffectMagic) {
+        logMessage(CVST_LogLevel_Error, "VST magic incorrect, unloading ...");
+        platformFreeLibrary(libHandle);
+        return NULL;
+    }
+    *library = libHandle;
+    return effect;
+}
+
+CVSTHOST_API CVST_Plugin CDECL CVST_LoadPlugin(const char *pathToPlugin, void *userData)
+{
+    logFormat(CVST_LogLevel_Info, "** loading [%s] **", pathToPlugin);
+    PlatformLibrary libHandle = NULL;
+    auto effect = openEffect(pathToPlugin, &libHandle);
+    if (!effect) {
+        drainLog();
+        return NULL;
+    }
+    auto ret = wrapEffect(effect, userData);
+    ret->libraryHandle = libHandle;
+    ret->path = pathToPlugin;
+    drainLog();
+    return ret;
+}
+
+CVSTHOST_API void CDECL CVST_SetBridgePath(const char *pathToBridge)
+{
+    bridgePath = pathToBridge ? pathToBridge : "";
+}
+
+bool bridgeAvailable()
+{
+    return !bridgePath.empty();
+}
+
+CVSTHOST_API CVST_Plugin CDECL CVST_LoadPluginBridged(const char *pathToPlugin, void *userData)
+{
+    logFormat(CVST_LogLevel_Info, "** loading [%s] (bridged) **", pathToPlugin);
+    if (bridgePath.empty()) {
+        logMessage(CVST_LogLevel_Error, "no bridge executable set (see CVST_SetBridgePath)");
+        drainLog();
+        return NULL;
+    }
+    auto bridge = BridgeClient::load(bridgePath.c_str(), pathToPlugin, hostCallback);
+    if (!bridge) {
+        drainLog();
+        return NULL;
+    }
+    auto ret = wrapEffect(bridge->getEffect(), userData);
+    ret->bridge.reset(bridge);
+    ret->path = pathToPlugin;
+    drainLog();
+    return ret;
+}
+
+CVSTHOST_API bool CDECL CVST_IsAlive(CVST_Plugin plugin)
+{
+    return !plugin->bridge || plugin->bridge->isAlive();
+}
+
+static void closeEffect(AEffect *effect)
+{
+    effect->dispatcher(effect, effClose, 0, 0, NULL, 0.0f);
+}
+
+// (state loads) after the swap: closes the old instance, and hands the plugin the new instance's bridge if bridged
+static void finishStateLoad(CVST_Plugin plugin)
+{
+    auto &load = plugin->stateLoad;
+    closeEffect(load.outgoing);
+    load.outgoing = nullptr;
+    if (load.library) {
+        // (the same library either way -- the plugin keeps the reference of the instance it now has)
+        std::swap(plugin->libraryHandle, load.library);
+        platformFreeLibrary(load.library);
+        load.library = NULL;
+    }
+    if (load.incomingBridge) {
+        plugin->bridge = std::move(load.incomingBridge); // (the old client waits for its process to exit)
+    }
+    plugin->parameters.invalidateText();
+    refreshParameters(plugin);
+    load.stage.store(kStateLoadDone, std::memory_order_release);
+}
+
+static void discardIncoming(StateLoad &load)
+{
+    if (load.incoming) {
+        closeEffect(load.incoming);
+        load.incoming = nullptr;
+    }
+    if (load.library) {
+        platformFreeLibrary(load.library);
+        load.library = NULL;
+    }
+    load.incomingBridge.reset();
+}
+
+// non-realtime: cleans up after a state load once the audio thread is done with it, returns the resulting stage
+// with 'force' (no processing may be going on), whatever is in flight is brought to an end: waited for, then discarded
+// if not swapped in yet, or finished if it was
+static int settleStateLoad(CVST_Plugin plugin, bool force)
+{
+    auto &load = plugin->stateLoad;
+    auto stage = load.stage.load(std::memory_order_acquire);
+    if (stage == kStateLoadPreparing && !force) {
+        return stage;
+    }
+    if (load.loader.joinable()) {
+        load.loader.join(); // (only waits if forced -- otherwise the loader is past Preparing, done)
+        stage = load.stage.load(std::memory_order_acquire);
+    }
+    switch (stage) {
+    case kStateLoadReady:
+        if (force) {
+            discardIncoming(load);
+            load.stage.store(kStateLoadIdle, std::memory_order_release);
+        }
+        else if (!plugin->resumed) {
+            // not processing, so no block boundary is coming -- swap right here
+            if (load.resumed) {
+                load.incoming->dispatcher(load.incoming, effStopProcess, 0, 0, NULL, 0.0f);
+                load.incoming->dispatcher(load.incoming, effMainsChanged, 0, 0, NULL, 0.0f);
+            }
+            load.outgoing = plugin->swapEffect(load.incoming);
+            load.incoming = nullptr;
+            finishStateLoad(plugin);
+        }
+        break;
+    case kStateLoadFading:
+        if (force) {
+            finishStateLoad(plugin);
+        }
+        break;
+    case kStateLoadRetired:
+        finishStateLoad(plugin);
+        break;
+    case kStateLoadFailed:
+        discardIncoming(load);
+        break;
+    }
+    stage = load.stage.load(std::memory_order_acquire);
+    if (stage == kStateLoadIdle || stage == kStateLoadDone || stage == kStateLoadFailed) {
+        plugin->hot.stateLoadPending.store(false, std::memory_order_relaxed); // (the audio thread can stop looking)
+    }
+    return stage;
+}
+
+CVSTHOST_API void CDECL CVST_Destroy(CVST_Plugin plugin)
+{
+    settleStateLoad(plugin, true);
+    if (plugin->libraryHandle) {
+        plugin->dispatcher(effClose, 0, 0, NULL, 0.0f);
+        logFormat(CVST_LogLevel_Debug, "library handle: %p", plugin->libraryHandle);
+        platformFreeLibrary(plugin->libraryHandle);
+        plugin->libraryHandle = NULL;
+        logMessage(CVST_LogLevel_Info, " ... freed library");
+    }
+    else if (plugin->bridge) {
+        plugin->dispatcher(effClose, 0, 0, NULL, 0.0f);
+        logMessage(CVST_LogLevel_Info, " ... closing bridge process"); // (waited for by ~BridgeClient)
+    }
+    else {
+        logMessage(CVST_LogLevel_Warning, "library handle null? not freeing");
+    }
+    delete plugin;
+    drainLog();
+}
+
+CVSTHOST_API void CDECL CVST_SetUserData(CVST_Plugin plugin, void *userData)
+{
+    plugin->userData = userData;
+}
+
+CVSTHOST_API void CDECL CVST_ResetHostState(CVST_Plugin plugin)
+{
+    settleStateLoad(plugin, true);
+    plugin->hot.samplePosition = 0;
+    plugin->hot.pendingParameterChanges = 0;
+    plugin->hot.numOutputEvents = 0;
+    plugin->blockAdapter.reset();
+    plugin->oversampler.reset();
+    plugin->sleep.reset();
+    if (plugin->hot.events) {
+        plugin->hot.events->timeline.clear();
+    }
+    plugin->transport.set(Transport().get());
+    plugin->stats.reset();
+    CVST_AutomationEvent discarded[64];
+    while (plugin->automation.pop(discarded, 64) > 0) {
+    }
+    plugin->parameters.clearChanged();
+}
+
+CVSTHOST_API void CDECL CVST_Start(CVST_Plugin plugin, float sampleRate)
+{
+    plugin->dispatcher(effOpen, 0, 0, NULL, 0.0f);
+    plugin->dispatcher(effSetSampleRate, 0, 0, NULL, sampleRate * plugin->oversampler.factor);
+    plugin->hot.sampleRate = sampleRate;
+}
+
+// (oversampling) buffers for the plugin's current I/O and block size
+static void allocOversampler(CVST_Plugin plugin)
+{
+    auto &oversampler = plugin->oversampler;
+    auto frames = plugin->adaptedBlockSize(plugin->blockSize);
+    if (oversampler.factor > 1 && !oversampler.fits(plugin->getNumInputs(), plugin->getNumOutputs(), frames)) {
+        oversampler.init(oversampler.factor, plugin->getNumInputs(), plugin->getNumOutputs(), frames);
+    }
+}
+
+CVSTHOST_API void CDECL CVST_SetBlockSize(CVST_Plugin plugin, int blockSize)
+{
+    // (with a block mode set, the plugin never sees more than the adapter's block; oversampled, it sees more frames)
+    auto pluginBlockSize = plugin->adaptedBlockSize(blockSize) * plugin->oversampler.factor;
+    plugin->dispatcher(effSetBlockSize, 0, pluginBlockSize, NULL, 0.0f);
+    plugin->blockSize = blockSize;
+    allocOversampler(plugin);
+    if (plugin->wantsDoublePrecision && !plugin->hot.nativeDoublePrecision && blockSize > plugin->fallbackCapacity) {
+        plugin->allocDoubleFallback(blockSize);
+    }
+}
+
+CVSTHOST_API bool CDECL CVST_SetProcessPrecision(CVST_Plugin plugin, enum CVST_ProcessPrecision precision)
+{
+    auto wantDouble = precision == ProcessPrecision_64;
+    plugin->wantsDoublePrecision = wantDouble;
+    plugin->hot.nativeDoublePrecision = wantDouble && plugin->canDoubleReplacing();
+    plugin->dispatcher(effSetProcessPrecision, 0, plugin->hot.nativeDoublePrecision ? kVstProcessPrecision64 : kVstProcessPrecision32, NULL, 0.0f);
+    if (wantDouble && !plugin->hot.nativeDoublePrecision && plugin->blockSize > plugin->fallbackCapacity) {
+        plugin->allocDoubleFallback(plugin->blockSize);
+    }
+    return wantDouble == plugin->hot.nativeDoublePrecision;
+}
+
+CVSTHOST_API void CDECL CVST_Suspend(CVST_Plugin plugin)
+{
+    plugin->dispatcher(effStopProcess, 0, 0, NULL, 0.0f);
+    plugin->dispatcher(effMainsChanged, 0, 0, NULL, 0.0f);
+    plugin->resumed = false;
+}
+
+// (sleep mode) the plugin's tail at the host rate -- asked again on every resume, it may depend on its settings
+static void updateTail(CVST_Plugin plugin)
+{
+    auto &sleep = plugin->sleep;
+    auto tail = plugin->dispatcher(effGetTailSize, 0, 0, NULL, 0.0f);
+    auto factor = plugin->oversampler.factor;
+    // (0: doesn't know, 1: has none)
+    sleep.tail = tail == 0 ? sleep.fallbackTail : tail == 1 ? 0 : (int)((tail + factor - 1) / factor);
+}
+
+CVSTHOST_API void CDECL CVST_Resume(CVST_Plugin plugin)
+{
+    plugin->allocSubBlockPointers(); // the I/O configuration may have changed while suspended
+    allocOversampler(plugin);
+    plugin->dispatcher(effMainsChanged, 0, 1, NULL, 0.0f);
+    plugin->dispatcher(effStartProcess, 0, 0, NULL, 0.0f);
+    plugin->resumed = true;
+    if (plugin->hot.sleepEnabled) {
+        updateTail(plugin);
+        plugin->sleep.quietFrames = 0;
+        plugin->sleep.sleeping.store(false, std::memory_order_relaxed);
+    }
+}
+
+// block size can only change while suspended, so bounce the plugin if necessary
+static void renegotiateBlockSize(CVST_Plugin plugin, int blockSize)
+{
+    if (blockSize == plugin->blockSize) {
+        return;
+    }
+    auto wasResumed = plugin->resumed;
+    if (wasResumed) {
+        CVST_Suspend(plugin);
+    }
+    CVST_SetBlockSize(plugin, blockSize);
+    if (wasResumed) {
+        CVST_Resume(plugin);
+    }
+}
+
+CVSTHOST_API void CDECL CVST_GetEditorSize(CVST_Plugin plugin, int *width, int *height)
+{
+    ERect *result; // allocated by plugin ... who is responsible for freeing?
+    plugin->dispatcher(effEditGetRect, 0, 0, &result, 0.0f);
+    *width = result->right - result->left;
+    *height = result->bottom - result->top;
+}
+
+CVSTHOST_API void CDECL CVST_OpenEditor(CVST_Plugin plugin, size_t windowHandle)
+{
+    if (!plugin->hot.editorOpen) {
+        logMessage(CVST_LogLevel_Info, "showing plugin window");
+        plugin->dispatcher(effEditOpen, 0, 0, (void *)windowHandle, 0.0f);
+        plugin->hot.editorOpen = true;
+    }
+}
+
+CVSTHOST_API void CDECL CVST_CloseEditor(CVST_Plugin plugin)
+{
+    if (plugin->hot.editorOpen) {
+        plugin->dispatcher(effEditClose, 0, 0, NULL, 0.0f);
+        plugin->hot.editorOpen = false;
+    }
+}
+
+// moves this block's slice of the timeline into the event storage, with deltaFrames holding the block-relative offset
+// until sendQueuedEvents (events that are late for some reason go at the start of the block)
+static int takeBlockEvents(CVST_Plugin plugin, unsigned int sampleFrames)
+{
+    auto storage = plugin->hot.events.get();
+    if (!storage || storage->inputCapacity == 0) {
+        return 0;
+    }
+    const TimelineEvent *due;
+    auto blockStart = plugin->hot.samplePosition;
+    auto numEvents = storage->timeline.take(blockStart + sampleFrames, storage->inputCapacity, &due);
+    for (int i = 0; i < numEvents; i++) {
+        VstMidiEvent &vme = storage->midi[i];
+        // other fields already set in the EventStorage constructor
+        vme.deltaFrames = due[i].samplePos > blockStart ? (VstInt32)(due[i].samplePos - blockStart) : 0;
+        *((uint32_t *)vme.midiData) = due[i].data; // copy all 4 bytes at once (even if only 3 are used)
+        plugin->sleep.trackMidi(vme.midiData);
+    }
+    return numEvents;
+}
+
+static void scheduleEvents(CVST_Plugin plugin, uint64_t samplePos, const CVST_MidiEvent *events, int numEvents)
+{
+    if (!plugin->hot.events || plugin->hot.events->inputCapacity == 0) {
+        if (numEvents > 0) {
+            logOpcode(CVST_LogLevel_Warning, kLogEffect, effProcessEvents, "plugin has no event storage (see CVST_SetEventCapacity), dropped %d events", numEvents);
+        }
+        return;
+    }
+    auto dropped = plugin->hot.events->timeline.schedule(samplePos, events, numEvents);
+    if (dropped > 0) {
+        logFormat(CVST_LogLevel_Warning, "event timeline full, dropped %d events", dropped);
+    }
+}
+
+// sends queued events [first, last), which all fall in the (sub-)block starting at subBlockStart
+static void sendQueuedEvents(CVST_Plugin plugin, int first, int last, VstInt32 subBlockStart)
+{
+    if (last <= first) {
+        return;
+    }
+    auto storage = plugin->hot.events.get();
+    for (int i = first; i < last; i++) {
+        VstMidiEvent &vme = storage->midi[i];
+        // (deltaFrames is from the start of the processReplacing call the event goes with, in the plugin's frames)
+        vme.deltaFrames = (vme.deltaFrames - subBlockStart) * plugin->oversampler.factor;
+        storage->vstEvents->events[i - first] = (VstEvent *)&vme;
+    }
+    storage->vstEvents->numEvents = last - first;
+    auto started = statsNow();
+    plugin->dispatcher(effProcessEvents, 0, 0, storage->vstEvents, 0.0f);
+    plugin->stats.addEventTime(statsNow() - started);
+}
+
+// sends the queued events and runs 'process' over the block -- split into sub-blocks at the queued parameter changes, if any
+template <typename T, typename Process>
+static void processBlock(CVST_Plugin plugin, T **inputs, T **outputs, unsigned int sampleFrames,
+    std::vector<T *> &subInputs, std::vector<T *> &subOutputs, Process process)
+{
+    auto started = statsNow();
+    auto numEvents = takeBlockEvents(plugin, sampleFrames);
+    auto numChanges = plugin->hot.pendingParameterChanges;
+    plugin->hot.samplePosition += sampleFrames;
+    plugin->hot.pendingParameterChanges = 0;
+    plugin->hot.numOutputEvents = 0;
+    plugin->hot.subBlockStart = 0;
+    plugin->hot.processing = true;
+
+    auto changes = plugin->parameterChanges.data();
+    int nextChange = 0;
+    if (numChanges > 0 && (subInputs.size() < (size_t)plugin->getNumInputs() || subOutputs.size() < (size_t)plugin->getNumOutputs())) {
+        // I/O grew without a suspend/resume, can't offset the buffers -- apply everything up front
+        for (; nextChange < numChanges; nextChange++) {
+            plugin->setParameter(changes[nextChange].index, changes[nextChange].value);
+        }
+    }
+    if (nextChange == numChanges) {
+        sendQueuedEvents(plugin, 0, numEvents, 0);
+        process(inputs, outputs, sampleFrames);
+        plugin->hot.processing = false;
+        plugin->transport.advance(sampleFrames, plugin->hot.sampleRate);
+        plugin->stats.recordBlock(statsNow() - started, sampleFrames, plugin->hot.sampleRate);
+        return;
+    }
+
+    auto minLength = (unsigned int)plugin->hot.minSubBlockLength;
+    int nextEvent = 0;
+    unsigned int start = 0;
+    while (start < sampleFrames) {
+        // changes that would begin a sub-block shorter than minLength are merged into this one
+        while (nextChange < numChanges && changes[nextChange].sampleOffs < start + minLength) {
+            plugin->setParameter(changes[nextChange].index, changes[nextChange].value);
+            nextChange++;
+        }
+        auto end = nextChange < numChanges ? std::min(changes[nextChange].sampleOffs, sampleFrames) : sampleFrames;
+
+        // (events past the end of the block go with the last sub-block, same as when not splitting)
+        auto firstEvent = nextEvent;
+        while (nextEvent < numEvents && (end == sampleFrames || (unsigned int)plugin->hot.events->midi[nextEvent].deltaFrames < end)) {
+            nextEvent++;
+        }
+        plugin->hot.subBlockStart = start;
+        plugin->transport.invalidate(start);
+        sendQueuedEvents(plugin, firstEvent, nextEvent, (VstInt32)start);
+
+        for (int i = 0; i < plugin->getNumInputs(); i++) {
+            subInputs[i] = inputs[i] + start;
+        }
+        for (int i = 0; i < plugin->getNumOutputs(); i++) {
+            subOutputs[i] = outputs[i] + start;
+        }
+        process(subInputs.data(), subOutputs.data(), end - start);
+        start = end;
+    }
+    plugin->hot.processing = false;
+    plugin->transport.advance(sampleFrames, plugin->hot.sampleRate);
+    // offsets beyond the block take effect from the next one
+    for (; nextChange < numChanges; nextChange++) {
+        plugin->setParameter(changes[nextChange].index, changes[nextChange].value);
+    }
+    plugin->stats.recordBlock(statsNow() - started, sampleFrames, plugin->hot.sampleRate);
+}
+
+// plugin is float-only: convert around a regular processReplacing ('process'), in chunks if the block is bigger than announced
+template <typename Process>
+static void processDoubleFallback(CVST_Plugin plugin, double **inputs, double **outputs, unsigned int sampleFrames, Process process)
+{
+    if (plugin->fallbackCapacity == 0) {
+        logMessage(CVST_LogLevel_Warning, "CVST_ProcessDoubleReplacing: no conversion buffers yet (no block size set, or 64-bit processing not asked for), allocating them on the audio thread");
+        plugin->allocDoubleFallback(std::max(plugin->blockSize, (int)sampleFrames));
+    }
+    auto numInputs = plugin->getNumInputs(), numOutputs = plugin->getNumOutputs();
+    for (unsigned int offset = 0; offset < sampleFrames; offset += plugin->fallbackCapacity) {
+        auto frames = std::min((unsigned int)plugin->fallbackCapacity, sampleFrames - offset);
+        for (int i = 0; i < numInputs; i++) {
+            convertDoubleToFloat(plugin->fallbackInputs[i], inputs[i] + offset, frames);
+        }
+        process(plugin->fallbackInputs.data(), plugin->fallbackOutputs.data(), frames);
+        for (int i = 0; i < numOutputs; i++) {
+            convertFloatToDouble(outputs[i] + offset, plugin->fallbackOutputs[i], frames);
+        }
+    }
+}
+
+// (oversampling) runs 'process' (a call into the plugin) through 'oversampler', or straight through if it's off
+template <typename T, typename Process>
+static void processOversampled(CVST_Plugin plugin, Oversampler &oversampler, T **inputs, T **outputs, unsigned int sampleFrames, Process process)
+{
+    if (oversampler.factor == 1) {
+        process(inputs, outputs, sampleFrames);
+        return;
+    }
+    auto numInputs = plugin->getNumInputs(), numOutputs = plugin->getNumOutputs();
+    if (!oversampler.fits(numInputs, numOutputs, 1)) {
+        logMessage(CVST_LogLevel_Warning, "oversampling: no block size set (or the I/O grew), allocating buffers on the audio thread");
+        oversampler.init(oversampler.factor, numInputs, numOutputs, std::max(plugin->adaptedBlockSize(plugin->blockSize), (int)sampleFrames));
+    }
+    oversampler.process(inputs, outputs, sampleFrames, numInputs, numOutputs, process);
+}
+
+// (state loads) hands the outgoing instance what this block hands the incoming one: its parameter changes and MIDI (peeked
+// from the timeline, processBlock takes them as usual), all at the start of the block -- it's only heard fading out
+// (its own output events are dropped: the plugin isn't 'processing' yet)
+static void forwardToOutgoing(CVST_Plugin plugin, unsigned int sampleFrames)
+{
+    auto &load = plugin->stateLoad;
+    auto outgoing = load.outgoing;
+    for (int i = 0; i < plugin->hot.pendingParameterChanges; i++) {
+        outgoing->setParameter(outgoing, plugin->parameterChanges[i].index, plugin->parameterChanges[i].value);
+    }
+    auto storage = plugin->hot.events.get();
+    if (!storage || load.midi.empty()) {
+        return;
+    }
+    const TimelineEvent *due;
+    auto blockStart = plugin->hot.samplePosition;
+    auto numEvents = storage->timeline.peek(blockStart + sampleFrames, (int)load.midi.size(), &due);
+    for (int i = 0; i < numEvents; i++) {
+        auto &vme = load.midi[i];
+        auto sampleOffs = due[i].samplePos > blockStart ? (VstInt32)(due[i].samplePos - blockStart) : 0;
+        vme.deltaFrames = sampleOffs * load.oversampler.factor;
+        *((uint32_t *)vme.midiData) = due[i].data;
+        load.vstEvents->events[i] = (VstEvent *)&vme;
+    }
+    if (numEvents > 0) {
+        load.vstEvents->numEvents = numEvents;
+        outgoing->dispatcher(outgoing, effProcessEvents, 0, 0, load.vstEvents, 0.0f);
+    }
+}
+
+// (state loads) at a block boundary: swaps in a prepared instance, and while crossfading runs the outgoing one over the
+// block into the scratch buffers -- ahead of the incoming one, in case the outputs overwrite the inputs
+// returns the frames to crossfade over (0: none)
+template <typename T>
+static unsigned int processOutgoing(CVST_Plugin plugin, T **inputs, unsigned int sampleFrames)
+{
+    if (!plugin->hot.stateLoadPending.load(std::memory_order_acquire)) {
+        return 0;
+    }
+    auto &load = plugin->stateLoad;
+    auto stage = load.stage.load(std::memory_order_acquire);
+    if (stage == kStateLoadReady) {
+        load.outgoing = plugin->swapEffect(load.incoming);
+        load.incoming = nullptr;
+        load.oversampler.copyState(plugin->oversampler); // (both instances go on from the same filter state)
+        load.fadePosition = 0;
+        stage = load.crossfadeFrames > 0 ? kStateLoadFading : kStateLoadRetired;
+        load.stage.store(stage, std::memory_order_release);
+    }
+    if (stage != kStateLoadFading) {
+        return 0;
+    }
+    auto frames = std::min(sampleFrames, (unsigned int)std::min(load.crossfadeFrames - load.fadePosition, load.scratchFrames));
+    forwardToOutgoing(plugin, frames);
+    auto outgoing = load.outgoing;
+    auto outputs = load.scratch(inputs);
+    auto processFloat = [outgoing](float **in, float **out, unsigned int n) { outgoing->processReplacing(outgoing, in, out, n); };
+    if (std::is_same<T, float>::value) {
+        processOversampled(plugin, load.oversampler, (float **)inputs, (float **)outputs, frames, processFloat);
+    }
+    else if (plugin->hot.nativeDoublePrecision) {
+        processOversampled(plugin, load.oversampler, (double **)inputs, (double **)outputs, frames,
+            [outgoing](double **in, double **out, unsigned int n) { outgoing->processDoubleReplacing(outgoing, in, out, n); });
+    }
+    else {
+        processDoubleFallback(plugin, (double **)inputs, (double **)outputs, frames,
+            [plugin, &load, processFloat](float **in, float **out, unsigned int n) { processOversampled(plugin, load.oversampler, in, out, n, processFloat); });
+    }
+    return frames;
+}
+
+template <typename T>
+static void crossfadeOutgoing(CVST_Plugin plugin, T **outputs, unsigned int frames, unsigned int sampleFrames)
+{
+    auto &load = plugin->stateLoad;
+    load.mix(outputs, std::min(plugin->getNumOutputs(), (int)load.scratchFloat.size()), frames);
+    // (a block bigger than announced cuts the fade short)
+    if (load.fadePosition >= load.crossfadeFrames || frames < sampleFrames) {
+        load.stage.store(kStateLoadRetired, std::memory_order_release);
+    }
+}
+
+// (block modes) the parameter changes falling in the plugin's next 'frames', re-timed to that block
+static void takeAdapterChanges(CVST_Plugin plugin, unsigned int frames)
+{
+    auto &adapter = plugin->blockAdapter;
+    auto blockStart = plugin->hot.samplePosition;
+    int count = 0;
+    while (count < adapter.numChanges && adapter.changePositions[count] < blockStart + frames) {
+        auto &change = plugin->parameterChanges[count];
+        change = adapter.changes[count];
+        change.sampleOffs = adapter.changePositions[count] > blockStart ? (unsigned int)(adapter.changePositions[count] - blockStart) : 0;
+        count++;
+    }
+    std::copy(adapter.changes.begin() + count, adapter.changes.begin() + adapter.numChanges, adapter.changes.begin());
+    std::copy(adapter.changePositions.begin() + count, adapter.changePositions.begin() + adapter.numChanges, adapter.changePositions.begin());
+    adapter.numChanges -= count;
+    plugin->hot.pendingParameterChanges = count;
+}
+
+// (block modes) runs 'process' over plugin-sized blocks: slices of the caller's (maximum), or through the FIFOs (fixed)
+template <typename T, typename Process>
+static void processAdapted(CVST_Plugin plugin, T **inputs, T **outputs, unsigned int sampleFrames, Process process)
+{
+    auto &adapter = plugin->blockAdapter;
+    auto blockSize = (unsigned int)adapter.blockSize;
+    auto ptrs = adapter.ptrs(inputs);
+    auto numInputs = std::min(adapter.numInputs, plugin->getNumInputs());
+    auto numOutputs = std::min(adapter.numOutputs, plugin->getNumOutputs());
+    if (adapter.mode == BlockMode_Maximum) {
+        for (unsigned int offset = 0; offset < sampleFrames; offset += blockSize) {
+            auto frames = std::min(blockSize, sampleFrames - offset);
+            for (int i = 0; i < numInputs; i++) {
+                ptrs[i] = inputs[i] + offset;
+            }
+            for (int i = 0; i < numOutputs; i++) {
+                ptrs[adapter.numInputs + i] = outputs[i] + offset;
+            }
+            takeAdapterChanges(plugin, frames);
+            process(plugin, ptrs, ptrs + adapter.numInputs, frames);
+        }
+        return;
+    }
+    // (inputs are copied before the outputs overwrite the same frames, so processing in place works)
+    for (unsigned int done = 0; done < sampleFrames; ) {
+        auto frames = std::min(sampleFrames - done, blockSize - adapter.fill);
+        for (int i = 0; i < numInputs; i++) {
+            memcpy(ptrs[i] + adapter.fill, inputs[i] + done, frames * sizeof(T));
+        }
+        for (int i = 0; i < numOutputs; i++) {
+            memcpy(outputs[i] + done, ptrs[adapter.numInputs + i] + adapter.fill, frames * sizeof(T));
+        }
+        adapter.fill += (int)frames;
+        done += frames;
+        if ((unsigned int)adapter.fill == blockSize) {
+            takeAdapterChanges(plugin, blockSize);
+            process(plugin, ptrs, ptrs + adapter.numInputs, blockSize);
+            adapter.fill = 0;
+        }
+    }
+}
+
+// (sleep mode) whether the plugin can skip this block: it's had nothing to do for longer than its tail (plus latency),
+// and still hasn't. if so the outputs are zeroed, and the sample clock and transport move on as if it had run
+template <typename T>
+static bool sleepThrough(CVST_Plugin plugin, T **inputs, T **outputs, unsigned int sampleFrames)
+{
+    if (!plugin->hot.sleepEnabled) {
+        return false;
+    }
+    auto &sleep = plugin->sleep;
+    auto stage = plugin->stateLoad.stage.load(std::memory_order_relaxed);
+    auto busy = sleep.holding() || plugin->hot.pendingParameterChanges > 0 ||
+        (plugin->hot.events && plugin->hot.events->timeline.due(plugin->hot.samplePosition + sampleFrames)) ||
+        (plugin->hot.stateLoadPending.load(std::memory_order_relaxed) &&
+            stage != kStateLoadIdle && stage != kStateLoadDone && stage != kStateLoadFailed);
+    for (int i = 0; i < plugin->getNumInputs() && !busy; i++) {
+        busy = peakLevel(inputs[i], sampleFrames) > (T)sleep.threshold;
+    }
+    if (busy) {
+        sleep.quietFrames = 0;
+        sleep.sleeping.store(false, std::memory_order_relaxed);
+        return false;
+    }
+    if (sleep.quietFrames < (uint64_t)sleep.tail + CVST_GetLatency(plugin)) {
+        sleep.quietFrames += sampleFrames; // (still ringing out)
+        return false;
+    }
+    sleep.sleeping.store(true, std::memory_order_relaxed);
+    for (int i = 0; i < plugin->getNumOutputs(); i++) {
+        memset(outputs[i], 0, sampleFrames * sizeof(T));
+    }
+    plugin->hot.samplePosition += sampleFrames;
+    plugin->hot.numOutputEvents = 0;
+    plugin->transport.advance(sampleFrames, plugin->hot.sampleRate);
+    return true;
+}
+
+static void processFloat(CVST_Plugin plugin, float **inputs, float **outputs, unsigned int sampleFrames)
+{
+    if (sleepThrough(plugin, inputs, outputs, sampleFrames)) {
+        return;
+    }
+    auto fadeFrames = processOutgoing(plugin, inputs, sampleFrames);
+    // process audio
+    processBlock(plugin, inputs, outputs, sampleFrames, plugin->subBlockInputs, plugin->subBlockOutputs,
+        [plugin](float **in, float **out, unsigned int frames) {
+            processOversampled(plugin, plugin->oversampler, in, out, frames,
+                [plugin](float **pin, float **pout, unsigned int n) { plugin->processReplacing(pin, pout, n); });
+        });
+    if (fadeFrames) {
+        crossfadeOutgoing(plugin, outputs, fadeFrames, sampleFrames);
+    }
+}
+
+CVSTHOST_API void CDECL CVST_ProcessReplacing(CVST_Plugin plugin, float **inputs, float **outputs, unsigned int sampleFrames)
+{
+    DenormalGuard denormals;
+    if (plugin->hot.adapted) {
+        processAdapted(plugin, inputs, outputs, sampleFrames, processFloat);
+    }
+    else {
+        processFloat(plugin, inputs, outputs, sampleFrames);
+    }
+}
+
+static void processDouble(CVST_Plugin plugin, double **inputs, double **outputs, unsigned int sampleFrames)
+{
+    if (sleepThrough(plugin, inputs, outputs, sampleFrames)) {
+        return;
+    }
+    auto fadeFrames = processOutgoing(plugin, inputs, sampleFrames);
+    processBlock(plugin, inputs, outputs, sampleFrames, plugin->subBlockInputs64, plugin->subBlockOutputs64,
+        [plugin](double **in, double **out, unsigned int frames) {
+            if (plugin->hot.nativeDoublePrecision) {
+                processOversampled(plugin, plugin->oversampler, in, out, frames,
+                    [plugin](double **pin, double **pout, unsigned int n) { plugin->processDoubleReplacing(pin, pout, n); });
+            }
+            else {
+                processDoubleFallback(plugin, in, out, frames, [plugin](float **fin, float **fout, unsigned int n) {
+                    processOversampled(plugin, plugin->oversampler, fin, fout, n,
+                        [plugin](float **pin, float **pout, unsigned int n) { plugin->processReplacing(pin, pout, n); });
+                });
+            }
+        });
+    if (fadeFrames) {
+        crossfadeOutgoing(plugin, outputs, fadeFrames, sampleFrames);
+    }
+}
+
+CVSTHOST_API void CDECL CVST_ProcessDoubleReplacing(CVST_Plugin plugin, double **inputs, double **outputs, unsigned int sampleFrames)
+{
+    DenormalGuard denormals;
+    if (plugin->hot.adapted) {
+        processAdapted(plugin, inputs, outputs, sampleFrames, processDouble);
+    }
+    else {
+        processDouble(plugin, inputs, outputs, sampleFrames);
+    }
+}
+
+CVSTHOST_API void CDECL CVST_SetBlockMode(CVST_Plugin plugin, enum CVST_BlockMode mode, int blockSize)
+{
+    if (mode != BlockMode_Passthrough && blockSize <= 0) {
+        logMessage(CVST_LogLevel_Warning, "CVST_SetBlockMode: no block size given, staying in passthrough mode");
+        mode = BlockMode_Passthrough;
+    }
+    plugin->blockAdapter.init(mode, blockSize, plugin->getNumInputs(), plugin->getNumOutputs(), MAX_PARAMETER_CHANGES);
+    plugin->hot.adapted = mode != BlockMode_Passthrough;
+    if (plugin->blockSize > 0) {
+        CVST_SetBlockSize(plugin, plugin->blockSize); // (re-announced, as the adapter sees it)
+    }
+    drainLog();
+}
+
+CVSTHOST_API void CDECL CVST_SetOversampling(CVST_Plugin plugin, int factor)
+{
+    if (factor != 1 && factor != 2 && factor != 4 && factor != 8) {
+        logFormat(CVST_LogLevel_Warning, "CVST_SetOversampling: unsupported factor %d, oversampling off", factor);
+        factor = 1;
+    }
+    settleStateLoad(plugin, true); // (a prepared instance would be running at the old rate)
+    plugin->oversampler.init(factor, plugin->getNumInputs(), plugin->getNumOutputs(), plugin->adaptedBlockSize(plugin->blockSize));
+    plugin->transport.setRateFactor(factor);
+    plugin->dispatcher(effSetSampleRate, 0, 0, NULL, plugin->hot.sampleRate * factor);
+    if (plugin->blockSize > 0) {
+        CVST_SetBlockSize(plugin, plugin->blockSize); // (re-announced at the new rate)
+    }
+    drainLog();
+}
+
+CVSTHOST_API void CDECL CVST_SetSleepMode(CVST_Plugin plugin, bool enabled, int fallbackTailFrames, float threshold)
+{
+    auto &sleep = plugin->sleep;
+    plugin->hot.sleepEnabled = enabled;
+    sleep.fallbackTail = std::max(fallbackTailFrames, 0);
+    sleep.threshold = std::max(threshold, 0.0f);
+    sleep.quietFrames = 0;
+    sleep.sleeping.store(false, std::memory_order_relaxed);
+    if (enabled) {
+        updateTail(plugin);
+    }
+}
+
+CVSTHOST_API bool CDECL CVST_IsSleeping(CVST_Plugin plugin)
+{
+    return plugin->sleep.sleeping.load(std::memory_order_relaxed);
+}
+
+// the caller's position on the sample clock (in fixed block mode, the plugin's lags behind by what's in the FIFO)
+static inline uint64_t callerPosition(CVST_Plugin plugin)
+{
+    return plugin->hot.samplePosition + plugin->blockAdapter.fill;
+}
+
+CVSTHOST_API void CDECL CVST_Idle(CVST_Plugin plugin)
+{
+    if (plugin->hot.wantsIdle) {
+        plugin->dispatcher(__effIdleDeprecated, 0, 0, NULL, 0.0f);
+    }
+    if (plugin->hot.editorOpen) {
+        plugin->dispatcher(effEditIdle, 0, 0, NULL, 0.0f);
+    }
+    drainLog();
+}
+
+CVSTHOST_API int CDECL CVST_PollAutomation(CVST_Plugin plugin, CVST_AutomationEvent *events, int maxEvents)
+{
+    return plugin->automation.pop(events, maxEvents);
+}
+
+CVSTHOST_API int CDECL CVST_GetNumParameters(CVST_Plugin plugin)
+{
+    return plugin->parameters.size();
+}
+
+CVSTHOST_API int CDECL CVST_GetParameters(CVST_Plugin plugin, int first, float *values, int count)
+{
+    first = std::max(first, 0);
+    count = std::max(0, std::min(count, plugin->parameters.size() - first));
+    for (int i = 0; i < count; i++) {
+        values[i] = plugin->parameters.get(first + i);
+    }
+    return count;
+}
+
+CVSTHOST_API void CDECL CVST_SetParameters(CVST_Plugin plugin, int first, const float *values, int count)
+{
+    first = std::max(first, 0);
+    count = std::max(0, std::min(count, plugin->parameters.size() - first));
+    for (int i = 0; i < count; i++) {
+        plugin->setParameter(first + i, values[i]);
+    }
+}
+
+CVSTHOST_API int CDECL CVST_GetChangedParameters(CVST_Plugin plugin, int *indices, int maxIndices)
+{
+    return plugin->parameters.takeChanged(indices, maxIndices);
+}
+
+CVSTHOST_API void CDECL CVST_RefreshParameters(CVST_Plugin plugin)
+{
+    refreshParameters(plugin);
+}
+
+static std::string getParameterString(CVST_Plugin plugin, VstInt32 opcode, int index)
+{
+    char buffer[PARAMETER_TEXT_SIZE] = {};
+    plugin->dispatcher(opcode, index, 0, buffer, 0.0f);
+    buffer[sizeof(buffer) - 1] = 0;
+    return buffer;
+}
+
+// the cached strings for a parameter -- NULL if out of range
+static ParameterShadow::Text *getParameterText(CVST_Plugin plugin, int index)
+{
+    auto &parameters = plugin->parameters;
+    if (index < 0 || index >= parameters.size()) {
+        return nullptr;
+    }
+    if (parameters.textStale.exchange(false)) {
+        parameters.invalidateText();
+    }
+    auto &text = parameters.text[index];
+    if (!text.fetched) {
+        text.name = getParameterString(plugin, effGetParamName, index);
+        text.label = getParameterString(plugin, effGetParamLabel, index);
+        text.fetched = true;
+    }
+    return &text;
+}
+
+CVSTHOST_API bool CDECL CVST_GetParameterInfo(CVST_Plugin plugin, int index, CVST_ParameterInfo *info)
+{
+    auto text = getParameterText(plugin, index);
+    if (!text) {
+        return false;
+    }
+    info->name = text->name.c_str();
+    info->label = text->label.c_str();
+    return true;
+}
+
+CVSTHOST_API const char * CDECL CVST_GetParameterDisplay(CVST_Plugin plugin, int index)
+{
+    auto text = getParameterText(plugin, index);
+    if (!text) {
+        return nullptr;
+    }
+    auto value = plugin->parameters.get(index);
+    if (!text->displayValid || text->displayValue != value) {
+        text->display = getParameterString(plugin, effGetParamDisplay, index);
+        text->displayValue = value;
+        text->displayValid = true;
+    }
+    return text->display.c_str();
+}
+
+CVSTHOST_API void CDECL CVST_SetBlockEvents(CVST_Plugin plugin, CVST_MidiEvent *events, int numEvents)
+{
+    scheduleEvents(plugin, callerPosition(plugin), events, numEvents);
+}
+
+CVSTHOST_API void CDECL CVST_ScheduleEvents(CVST_Plugin plugin, unsigned long long samplePos, const CVST_MidiEvent *events, int numEvents)
+{
+    scheduleEvents(plugin, samplePos, events, numEvents);
+}
+
+CVSTHOST_API unsigned long long CDECL CVST_GetSamplePosition(CVST_Plugin plugin)
+{
+    return callerPosition(plugin);
+}
+
+CVSTHOST_API const CVST_MidiEvent * CDECL CVST_GetOutputEvents(CVST_Plugin plugin, int *numEvents)
+{
+    *numEvents = plugin->hot.numOutputEvents;
+    return plugin->hot.events ? plugin->hot.events->output.data() : nullptr;
+}
+
+CVSTHOST_API void CDECL CVST_SetEventCapacity(CVST_Plugin plugin, int inputEvents, int outputEvents)
+{
+    inputEvents = std::max(inputEvents, 0);
+    outputEvents = std::max(outputEvents, 0);
+    if (inputEvents == 0 && outputEvents == 0) {
+        plugin->hot.events.reset();
+    }
+    else {
+        plugin->hot.events.reset(new EventStorage(inputEvents, outputEvents));
+    }
+    plugin->hot.numOutputEvents = 0;
+}
+
+CVSTHOST_API void CDECL CVST_GetEventCapacity(CVST_Plugin plugin, int *inputEvents, int *outputEvents)
+{
+    auto &events = plugin->hot.events;
+    *inputEvents = events ? events->inputCapacity : 0;
+    *outputEvents = events ? events->outputCapacity : 0;
+}
+
+CVSTHOST_API void CDECL CVST_SetTransport(CVST_Plugin plugin, const CVST_Transport *transport)
+{
+    plugin->transport.set(*transport);
+}
+
+CVSTHOST_API void CDECL CVST_GetTransport(CVST_Plugin plugin, CVST_Transport *transport)
+{
+    *transport = plugin->transport.get();
+}
+
+CVSTHOST_API void CDECL CVST_GetStats(CVST_Plugin plugin, CVST_Stats *stats)
+{
+    plugin->stats.snapshot(stats);
+}
+
+CVSTHOST_API void CDECL CVST_ResetStats(CVST_Plugin plugin)
+{
+    plugin->stats.reset();
+}
+
+CVSTHOST_API void CDECL CVST_SetStatsBudget(CVST_Plugin plugin, double fractionOfDeadline)
+{
+    plugin->stats.budget = fractionOfDeadline;
+}
+
+CVSTHOST_API void CDECL CVST_SetBlockParameterChanges(CVST_Plugin plugin, const CVST_ParameterChange *changes, int numChanges)
+{
+    numChanges = std::max(numChanges, 0);
+    auto &adapter = plugin->blockAdapter;
+    auto room = adapter.mode != BlockMode_Passthrough ? MAX_PARAMETER_CHANGES - adapter.numChanges : MAX_PARAMETER_CHANGES;
+    if (numChanges > room) {
+        logFormat(CVST_LogLevel_Warning, "too many parameter changes (%d pending at most), dropped %d", MAX_PARAMETER_CHANGES, numChanges - room);
+        numChanges = room;
+    }
+    if (adapter.mode != BlockMode_Passthrough) {
+        // kept until the plugin block they fall in (see takeAdapterChanges, which stops at the first one that isn't due:
+        // they're inserted in position order, after any already at the same position)
+        auto blockStart = callerPosition(plugin);
+        auto positions = adapter.changePositions.begin();
+        for (int i = 0; i < numChanges; i++) {
+            auto position = blockStart + changes[i].sampleOffs;
+            auto at = std::upper_bound(positions, positions + adapter.numChanges, position) - positions;
+            std::copy_backward(adapter.changes.begin() + at, adapter.changes.begin() + adapter.numChanges, adapter.changes.begin() + adapter.numChanges + 1);
+            std::copy_backward(positions + at, positions + adapter.numChanges, positions + adapter.numChanges + 1);
+            adapter.changes[at] = changes[i];
+            adapter.changePositions[at] = position;
+            adapter.numChanges++;
+        }
+        return;
+    }
+    std::copy(changes, changes + numChanges, plugin->parameterChanges.begin());
+    plugin->hot.pendingParameterChanges = numChanges;
+}
+
+CVSTHOST_API void CDECL CVST_SetMinSubBlockLength(CVST_Plugin plugin, int frames)
+{
+    plugin->hot.minSubBlockLength = std::max(frames, 1);
+}
+
+CVSTHOST_API void CDECL CVST_RenderOffline(CVST_Plugin plugin, float **inputs, float **outputs, unsigned int totalFrames, int blockSize, CVST_MidiEvent *events, int numEvents)
+{
+    if (blockSize <= 0) {
+        blockSize = (int)std::min(totalFrames, (unsigned int)OFFLINE_DEFAULT_BLOCK_SIZE);
+    }
+    if (blockSize <= 0) {
+        return; // nothing to render
+    }
+
+    auto prevBlockSize = plugin->blockSize;
+    renegotiateBlockSize(plugin, blockSize);
+    plugin->hot.renderingOffline = true;
+    plugin->dispatcher(effSetTotalSampleToProcess, 0, totalFrames, NULL, 0.0f);
+
+    // per-block views into the caller's full-length buffers
+    std::vector<float *> blockInputs(plugin->getNumInputs());
+    std::vector<float *> blockOutputs(plugin->getNumOutputs());
+
+    auto renderStart = callerPosition(plugin); // (events are on the caller's timeline, see CVST_SetBlockEvents)
+    int nextEvent = 0;
+    for (unsigned int blockStart = 0; blockStart < totalFrames; blockStart += blockSize) {
+        auto blockFrames = std::min((unsigned int)blockSize, totalFrames - blockStart);
+        for (size_t i = 0; i < blockInputs.size(); i++) {
+            blockInputs[i] = inputs[i] + blockStart;
+        }
+        for (size_t i = 0; i < blockOutputs.size(); i++) {
+            blockOutputs[i] = outputs[i] + blockStart;
+        }
+
+        // events are sorted, so this block's slice is the run starting at nextEvent
+        auto firstEvent = nextEvent;
+        while (nextEvent < numEvents && events[nextEvent].sampleOffs < blockStart + blockFrames) {
+            nextEvent++;
+        }
+        scheduleEvents(plugin, renderStart, &events[firstEvent], nextEvent - firstEvent);
+
+        CVST_ProcessReplacing(plugin, blockInputs.data(), blockOutputs.data(), blockFrames);
+    }
+
+    plugin->hot.renderingOffline = false;
+    if (prevBlockSize > 0) {
+        renegotiateBlockSize(plugin, prevBlockSize);
+    }
+}
+
+CVSTHOST_API void CDECL CVST_GetProperties(CVST_Plugin plugin, CVST_Properties *props)
+{
+    props->numInputs = plugin->getNumInputs();
+    props->numOutputs = plugin->getNumOutputs();
+    props->isInstrument = plugin->isInstrument; // set on plugin load, so not a function
+    props->canDoubleReplacing = plugin->canDoubleReplacing();
+}
+
+CVSTHOST_API int CDECL CVST_GetLatency(CVST_Plugin plugin)
+{
+    // (an oversampled plugin's initialDelay is at its own rate)
+    auto factor = plugin->oversampler.factor;
+    return (plugin->getInitialDelay() + factor / 2) / factor + plugin->oversampler.latency() + plugin->blockAdapter.latency();
+}
+
+CVSTHOST_API void CDECL CVST_GetPluginInfo(CVST_Plugin plugin, CVST_PluginInfo *info)
+{
+    static const struct {
+        const char *canDo;
+        unsigned int bit;
+    } canDos[] = {
+        { PlugCanDos::canDoSendVstEvents, CVST_PlugCanDo_SendVstEvents },
+        { PlugCanDos::canDoSendVstMidiEvent, CVST_PlugCanDo_SendVstMidiEvent },
+        { PlugCanDos::canDoReceiveVstEvents, CVST_PlugCanDo_ReceiveVstEvents },
+        { PlugCanDos::canDoReceiveVstMidiEvent, CVST_PlugCanDo_ReceiveVstMidiEvent },
+        { PlugCanDos::canDoReceiveVstTimeInfo, CVST_PlugCanDo_ReceiveVstTimeInfo },
+        { PlugCanDos::canDoOffline, CVST_PlugCanDo_Offline },
+        { PlugCanDos::canDoMidiProgramNames, CVST_PlugCanDo_MidiProgramNames },
+        { PlugCanDos::canDoBypass, CVST_PlugCanDo_Bypass },
+    };
+
+    memset(info, 0, sizeof(*info));
+    info->uniqueID = plugin->getUniqueID();
+    info->version = plugin->getVersion();
+    info->category = (int)plugin->dispatcher(effGetPlugCategory, 0, 0, NULL, 0.0f);
+    info->numInputs = plugin->getNumInputs();
+    info->numOutputs = plugin->getNumOutputs();
+    info->numParams = plugin->getNumParams();
+    info->numPrograms = plugin->getNumPrograms();
+    info->flags = plugin->getFlags();
+    info->isInstrument = plugin->isInstrument;
+    for (auto &entry : canDos) {
+        if (plugin->dispatcher(effCanDo, 0, 0, (void *)entry.canDo, 0.0f) == 1) {
+            info->canDos |= entry.bit;
+        }
+    }
+    info->vendorVersion = (int)plugin->dispatcher(effGetVendorVersion, 0, 0, NULL, 0.0f);
+    // (the buffers are bigger than the kVstMax*Len the plugins are supposed to respect, and stay terminated regardless)
+    plugin->dispatcher(effGetEffectName, 0, 0, info->name, 0.0f);
+    plugin->dispatcher(effGetVendorString, 0, 0, info->vendor, 0.0f);
+    plugin->dispatcher(effGetProductString, 0, 0, info->product, 0.0f);
+    info->name[sizeof(info->name) - 1] = 0;
+    info->vendor[sizeof(info->vendor) - 1] = 0;
+    info->product[sizeof(info->product) - 1] = 0;
+}
+
+CVSTHOST_API void CDECL CVST_GetChunk(CVST_Plugin plugin, enum CVST_ChunkType chunkType, void** data, size_t* length)
+{
+    VstInt32 index = chunkType == ChunkType_Bank ? 0 : 1;
+    *length = plugin->dispatcher(effGetChunk, index, 0, data, 0.0f);
+    // will be up to the client to save the block elsewhere immediately
+}
+
+CVSTHOST_API void CDECL CVST_SetChunk(CVST_Plugin plugin, enum CVST_ChunkType chunkType, void* source, size_t length)
+{
+    VstInt32 index = chunkType == ChunkType_Bank ? 0 : 1;
+    plugin->dispatcher(effSetChunk, index, length, source, 0.0f);
+    refreshParameters(plugin);
+}
+
+// on the loader thread: another instance, set up like the plugin, with the chunk loaded and a few blocks processed
+static void prepareStateLoad(CVST_Plugin plugin)
+{
+    auto &load = plugin->stateLoad;
+    AEffect *effect = nullptr;
+    if (plugin->bridge) {
+        load.incomingBridge.reset(BridgeClient::load(bridgePath.c_str(), plugin->path.c_str(), hostCallback));
+        effect = load.incomingBridge ? load.incomingBridge->getEffect() : nullptr;
+    }
+    else {
+        effect = openEffect(plugin->path.c_str(), &load.library); // (the same library again, just another reference to it)
+    }
+    if (!effect) {
+        logFormat(CVST_LogLevel_Error, "state load: couldn't load another instance of [%s]", plugin->path.c_str());
+        load.stage.store(kStateLoadFailed, std::memory_order_release);
+        return;
+    }
+    auto dispatch = [effect](VstInt32 opcode, VstInt32 index, VstIntPtr value, void *ptr, float opt) {
+        return effect->dispatcher(effect, opcode, index, value, ptr, opt);
+    };
+    auto blockSize = load.blockSize > 0 ? load.blockSize : STATE_LOAD_DEFAULT_BLOCK_SIZE;
+    auto pluginBlockSize = blockSize * load.oversampler.factor; // (the plugin's rate, the warmup runs at)
+    dispatch(effOpen, 0, 0, NULL, 0.0f);
+    dispatch(effSetSampleRate, 0, 0, NULL, load.sampleRate * load.oversampler.factor);
+    dispatch(effSetBlockSize, 0, pluginBlockSize, NULL, 0.0f);
+    dispatch(effSetProcessPrecision, 0, load.doublePrecision ? kVstProcessPrecision64 : kVstProcessPrecision32, NULL, 0.0f);
+    dispatch(effSetChunk, load.chunkIndex, (VstIntPtr)load.chunk.size(), load.chunk.data(), 0.0f);
+    std::vector<char>().swap(load.chunk);
+
+    if (load.resumed) {
+        dispatch(effMainsChanged, 0, 1, NULL, 0.0f);
+        dispatch(effStartProcess, 0, 0, NULL, 0.0f);
+        // (silence in, through the scratch buffers: outputs there are overwritten by the fade anyway)
+        auto numChannels = std::max(effect->numInputs, effect->numOutputs);
+        load.allocScratch(numChannels * 2, pluginBlockSize);
+        for (int block = 0; block < STATE_LOAD_WARMUP_BLOCKS; block++) {
+            if (load.doublePrecision) {
+                effect->processDoubleReplacing(effect, load.scratchDouble.data(), load.scratchDouble.data() + numChannels, pluginBlockSize);
+            }
+            else {
+                effect->processReplacing(effect, load.scratchFloat.data(), load.scratchFloat.data() + numChannels, pluginBlockSize);
+            }
+            std::fill(load.scratchStorage.begin(), load.scratchStorage.end(), 0.0);
+        }
+    }
+    load.allocScratch(effect->numOutputs, blockSize);
+    load.incoming = effect;
+    load.stage.store(kStateLoadReady, std::memory_order_release);
+}
+
+CVSTHOST_API bool CDECL CVST_SetChunkAsync(CVST_Plugin plugin, enum CVST_ChunkType chunkType, const void *source, size_t length, int crossfadeFrames)
+{
+    auto stage = settleStateLoad(plugin, false);
+    if (stage == kStateLoadPreparing || stage == kStateLoadReady || stage == kStateLoadFading) {
+        logMessage(CVST_LogLevel_Warning, "CVST_SetChunkAsync: a state load is already in flight");
+        drainLog();
+        return false;
+    }
+    if (plugin->hot.editorOpen) {
+        logMessage(CVST_LogLevel_Warning, "CVST_SetChunkAsync: not while the editor is open (it belongs to the current instance)");
+        drainLog();
+        return false;
+    }
+    auto &load = plugin->stateLoad;
+    load.chunkIndex = chunkType == ChunkType_Bank ? 0 : 1;
+    load.chunk.assign((const char *)source, (const char *)source + length);
+    load.crossfadeFrames = std::max(crossfadeFrames, 0);
+    load.sampleRate = plugin->hot.sampleRate;
+    load.blockSize = plugin->adaptedBlockSize(plugin->blockSize);
+    load.oversampler.init(plugin->oversampler.factor, plugin->getNumInputs(), plugin->getNumOutputs(), plugin->oversampler.getCapacity());
+    load.doublePrecision = plugin->hot.nativeDoublePrecision;
+    load.resumed = plugin->resumed;
+    load.allocEvents(plugin->hot.events ? plugin->hot.events->inputCapacity : 0);
+    load.stage.store(kStateLoadPreparing, std::memory_order_release);
+    plugin->hot.stateLoadPending.store(true, std::memory_order_release);
+    load.loader = std::thread(prepareStateLoad, plugin);
+    drainLog();
+    return true;
+}
+
+CVSTHOST_API enum CVST_StateLoadStatus CDECL CVST_GetStateLoadStatus(CVST_Plugin plugin)
+{
+    auto stage = settleStateLoad(plugin, false);
+    drainLog();
+    switch (stage) {
+    case kStateLoadPreparing:
+    case kStateLoadReady:
+        return StateLoad_Pending;
+    case kStateLoadFading:
+    case kStateLoadRetired:
+        return StateLoad_Crossfading;
+    case kStateLoadDone:
+        return StateLoad_Done;
+    case kStateLoadFailed:
+        return StateLoad_Failed;
+    }
+    return StateLoad_Idle;
+}
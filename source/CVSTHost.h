@@ -7,16 +7,23 @@
 // that uses this DLL. This way any other project whose source files include this file see 
 // CVSTHOST_API functions as being imported from a DLL, whereas this DLL sees symbols
 // defined with this macro as being exported.
+#ifdef _WIN32
 #ifdef CVSTHOST_EXPORTS
 #define CVSTHOST_API __declspec(dllexport)
 #else
 #define CVSTHOST_API __declspec(dllimport)
 #endif
+#else
+// non-Windows builds compile with -fvisibility=hidden, so only the API is exported
+#define CVSTHOST_API __attribute__((visibility("default")))
+#endif
 
 #define CDECL // including Windows.h is a bit overkill just for this
 
 #define APIHANDLE(x) struct _##x; typedef struct _##x* x
 
+#include <stddef.h> // size_t
+
 #ifndef __cplusplus
 #include <stdbool.h>
 #endif
@@ -29,17 +36,26 @@ extern "C" {
 
     typedef enum {
         CVST_EventType_Log,
-        CVST_EventType_Automation,
+        CVST_EventType_Automation, // no longer sent (it came from the audio thread) -- see CVST_PollAutomation
         CVST_EventType_GetVendorInfo,
     } CVST_EventType;
 
+    typedef enum {
+        CVST_LogLevel_Debug,   // per-opcode chatter (canDo queries, edit begin/end, plugin event output ...)
+        CVST_LogLevel_Info,
+        CVST_LogLevel_Warning,
+        CVST_LogLevel_Error,
+        CVST_LogLevel_None
+    } CVST_LogLevel;
+
     typedef struct {
         CVST_EventType eventType;
         bool handled;
         // union of stuff
         union {
             struct {
-                const char *message;
+                const char *message; // only valid during the callback
+                CVST_LogLevel level;
             } logEvent;
             struct {
                 int index;
@@ -58,9 +74,27 @@ extern "C" {
     CVSTHOST_API void CDECL CVST_Init(CVST_EventCallback callback);
     CVSTHOST_API void CDECL CVST_Shutdown();
 
+    // log messages are queued without formatting or locking wherever they originate (often the audio thread), and are
+    // only formatted and delivered (CVST_EventType_Log) by CVST_DrainLog -- which CVST_Idle and the non-realtime API calls
+    // (CVST_Init, CVST_LoadPlugin, ...) also do; call it periodically if you don't use those
+    CVSTHOST_API void CDECL CVST_SetLogLevel(CVST_LogLevel level); // messages below this are discarded at the source (default: Info)
+    CVSTHOST_API void CDECL CVST_DrainLog();
+
     CVSTHOST_API CVST_Plugin CDECL CVST_LoadPlugin(const char *pathToPlugin, void *userData);
     CVSTHOST_API void CDECL CVST_Destroy(CVST_Plugin plugin);
 
+    // out-of-process hosting: the plugin runs in its own bridge process (the cvstbridge executable), so a crash only takes
+    // that down. the handle works with the rest of the API as usual; audio, MIDI and parameters go through shared memory
+    // (no editors, though, and at most 32 channels each way)
+    CVSTHOST_API void CDECL CVST_SetBridgePath(const char *pathToBridge); // the cvstbridge executable, required before loading bridged
+    CVSTHOST_API CVST_Plugin CDECL CVST_LoadPluginBridged(const char *pathToPlugin, void *userData);
+    CVSTHOST_API void CDECL CVST_SetUserData(CVST_Plugin plugin, void *userData); // (as passed to the event callback)
+    // puts the host's side of the plugin back to how it was after loading: sample position 0, no scheduled events or pending
+    // parameter changes, default transport, stats and automation cleared -- the plugin's own state is up to the caller.
+    // a state load in flight (CVST_SetChunkAsync) is brought to an end first; not while processing
+    CVSTHOST_API void CDECL CVST_ResetHostState(CVST_Plugin plugin);
+    CVSTHOST_API bool CDECL CVST_IsAlive(CVST_Plugin plugin); // false once a bridged plugin's process has died (it outputs silence from then on)
+
     CVSTHOST_API void CDECL CVST_Start(CVST_Plugin plugin, float sampleRate);
     CVSTHOST_API void CDECL CVST_SetBlockSize(CVST_Plugin plugin, int blockSize);
     CVSTHOST_API void CDECL CVST_Resume(CVST_Plugin plugin);
@@ -68,32 +102,358 @@ extern "C" {
     CVSTHOST_API void CDECL CVST_GetEditorSize(CVST_Plugin plugin, int *width, int *height);
     CVSTHOST_API void CDECL CVST_OpenEditor(CVST_Plugin plugin, size_t windowHandle);
     CVSTHOST_API void CDECL CVST_CloseEditor(CVST_Plugin plugin);
+    // (denormals are flushed to zero for the duration of a process call -- FTZ/DAZ -- the caller's mode is restored after)
     CVSTHOST_API void CDECL CVST_ProcessReplacing(CVST_Plugin plugin, float **inputs, float **outputs, unsigned int sampleFrames);
+    // works with every plugin -- float-only ones are converted to/from 32-bit internally (see CVST_SetProcessPrecision)
+    CVSTHOST_API void CDECL CVST_ProcessDoubleReplacing(CVST_Plugin plugin, double **inputs, double **outputs, unsigned int sampleFrames);
+
+    enum CVST_ProcessPrecision {
+        ProcessPrecision_32,
+        ProcessPrecision_64
+    };
+    // call while suspended; returns false if the plugin can't process natively at that precision
+    CVSTHOST_API bool CDECL CVST_SetProcessPrecision(CVST_Plugin plugin, enum CVST_ProcessPrecision precision);
     CVSTHOST_API void CDECL CVST_Idle(CVST_Plugin plugin);
 
+    // decouples the caller's block size from the plugin's (for plugins that work best, or only, at a given block size)
+    //   maximum: bigger caller blocks are processed as several plugin blocks of at most blockSize frames
+    //   fixed:   the plugin always processes exactly blockSize frames -- caller audio goes through FIFOs, which adds blockSize
+    //            frames of latency (included in CVST_GetLatency)
+    // (any block size > 0 will do, it needn't be a power of two)
+    // events, parameter changes and CVST_GetSamplePosition stay on the caller's timeline, and are re-timed to the plugin
+    // blocks they fall in; CVST_GetOutputEvents is that of the last plugin block. call while suspended (allocates)
+    enum CVST_BlockMode {
+        BlockMode_Passthrough, // default: the plugin sees the caller's blocks
+        BlockMode_Maximum,
+        BlockMode_Fixed
+    };
+    CVSTHOST_API void CDECL CVST_SetBlockMode(CVST_Plugin plugin, enum CVST_BlockMode mode, int blockSize);
+
+    // runs the plugin at 2, 4 or 8 times the host's sample rate (eg saturators, which alias badly at 44.1kHz): inputs are
+    // upsampled and outputs downsampled around every process call, through linear-phase half-band filters whose delay is
+    // included in CVST_GetLatency. the plugin is told the higher rate and block size; events, parameter changes and the
+    // transport stay on the host's timeline (and are scaled for it). 1 turns it off. call after CVST_Start, while suspended
+    CVSTHOST_API void CDECL CVST_SetOversampling(CVST_Plugin plugin, int factor);
+
+    // lets the host stop calling the plugin while it has nothing to do: once its input has been silent (peak <= threshold,
+    // 0 for exact zeros) with no MIDI, held notes or parameter changes for longer than its tail (effGetTailSize, or
+    // fallbackTailFrames if it doesn't know) plus its latency, its outputs are zeroed instead. the first block with any
+    // of those wakes it. off by default; call while not processing
+    CVSTHOST_API void CDECL CVST_SetSleepMode(CVST_Plugin plugin, bool enabled, int fallbackTailFrames, float threshold);
+    CVSTHOST_API bool CDECL CVST_IsSleeping(CVST_Plugin plugin); // as of the last block, from any thread
+
     typedef struct {
-        unsigned long sampleOffs; // relative to start of block -- NOT deltas, that's calculated in CVSTSetBlockEvents
+        int index;
+        float value;
+    } CVST_AutomationEvent;
+    // drains parameter changes made by the plugin (audioMasterAutomate) since the last poll, returns the number written
+    // repeated changes to the same parameter are coalesced, last value wins; call from a single non-realtime thread (eg UI idle)
+    CVSTHOST_API int CDECL CVST_PollAutomation(CVST_Plugin plugin, CVST_AutomationEvent *events, int maxEvents);
+
+    // parameters, from a host-side copy of all values that's kept current by audioMasterAutomate and by the host's own
+    // changes (CVST_SetParameters, CVST_SetBlockParameterChanges, chunk loads) -- reading it never calls into the plugin
+    // and is fine from any thread. get/set return/take as many as fit in [first, number of parameters)
+    CVSTHOST_API int CDECL CVST_GetNumParameters(CVST_Plugin plugin);
+    CVSTHOST_API int CDECL CVST_GetParameters(CVST_Plugin plugin, int first, float *values, int count);
+    // applied right away (between blocks if from the audio thread -- use CVST_SetBlockParameterChanges for sample accuracy)
+    CVSTHOST_API void CDECL CVST_SetParameters(CVST_Plugin plugin, int first, const float *values, int count);
+    // the parameters whose value changed since they were last returned (ascending), up to maxIndices of them
+    // a single consumer (eg a UI, or a remote control sync) -- unlike CVST_PollAutomation, changes made by the host count too
+    CVSTHOST_API int CDECL CVST_GetChangedParameters(CVST_Plugin plugin, int *indices, int maxIndices);
+    // re-reads every value from the plugin, for changes it didn't report (eg a program change made in its editor)
+    CVSTHOST_API void CDECL CVST_RefreshParameters(CVST_Plugin plugin);
+
+    typedef struct {
+        const char *name;
+        const char *label; // unit, eg "dB"
+    } CVST_ParameterInfo;
+    // asked from the plugin once and cached (again after audioMasterUpdateDisplay); strings valid until the next call
+    // for that parameter. non-realtime, single thread
+    CVSTHOST_API bool CDECL CVST_GetParameterInfo(CVST_Plugin plugin, int index, CVST_ParameterInfo *info);
+    // the value as text (effGetParamDisplay), only asked again once the value changed -- NULL if out of range
+    CVSTHOST_API const char * CDECL CVST_GetParameterDisplay(CVST_Plugin plugin, int index);
+
+    typedef struct {
+        unsigned long sampleOffs; // relative to start of block (re-offset to the sub-block, and scaled when oversampling, as the events are sent)
         union {
             unsigned char bytes[4];
             unsigned int uint32;
         } data;
     } CVST_MidiEvent;
+    // events for the next CVST_ProcessReplacing / CVST_ProcessDoubleReplacing call -- may be called several times per block
+    // (eg once per MIDI port), events need not be sorted, and any past the end of the block are kept for the following ones
     CVSTHOST_API void CDECL CVST_SetBlockEvents(CVST_Plugin plugin, CVST_MidiEvent *events, int numEvents);
+    // same, but relative to an absolute position in the plugin's sample clock, which starts at 0 and is advanced by every
+    // process call -- CVST_GetSamplePosition is the start of the next block; events already in the past go at its start
+    // scheduled events live in a fixed-size timeline, which is merged in O(n) without allocating (audio thread only)
+    CVSTHOST_API void CDECL CVST_ScheduleEvents(CVST_Plugin plugin, unsigned long long samplePos, const CVST_MidiEvent *events, int numEvents);
+    CVSTHOST_API unsigned long long CDECL CVST_GetSamplePosition(CVST_Plugin plugin);
+    // event storage is only allocated for plugins that say they receive (canDo receiveVstMidiEvent) or send MIDI, with room
+    // for 1024 pending input / 1024 output events per block; this resizes (or adds, or with 0/0 frees) it -- not while processing,
+    // and any pending events are discarded. events for a plugin without input storage are dropped (with a warning)
+    CVSTHOST_API void CDECL CVST_SetEventCapacity(CVST_Plugin plugin, int inputEvents, int outputEvents);
+    CVSTHOST_API void CDECL CVST_GetEventCapacity(CVST_Plugin plugin, int *inputEvents, int *outputEvents); // (0/0 without storage)
+    // MIDI the plugin sent during the last process call (sampleOffs relative to the start of that block, in the order sent)
+    // points into the plugin's own storage -- valid until the next process call, don't free
+    CVSTHOST_API const CVST_MidiEvent * CDECL CVST_GetOutputEvents(CVST_Plugin plugin, int *numEvents);
+
+    typedef struct {
+        double samplePos; // song position, in samples
+        double ppqPos;    // in quarter notes
+        double tempo;     // bpm
+        int timeSigNumerator, timeSigDenominator;
+        bool playing, recording, looping;
+        double loopStartPpq, loopEndPpq;
+    } CVST_Transport;
+    // the transport reported to the plugin (audioMasterGetTime), as of the start of the next block -- while playing, every
+    // process call advances it (wrapping around the loop at block boundaries). audio thread, like CVST_SetBlockEvents
+    // default: stopped at 0, 120 bpm, 4/4
+    CVSTHOST_API void CDECL CVST_SetTransport(CVST_Plugin plugin, const CVST_Transport *transport);
+    CVSTHOST_API void CDECL CVST_GetTransport(CVST_Plugin plugin, CVST_Transport *transport);
+
+    typedef struct {
+        unsigned int sampleOffs; // relative to start of block
+        int index;
+        float value;
+    } CVST_ParameterChange;
+    // sample-accurate parameter changes for the next process call (audio thread, like CVST_SetBlockEvents), sorted by sampleOffs
+    // the block is split into several processReplacing calls at the changes, with the events re-offset to match;
+    // a change less than the minimum sub-block length after the previous split is applied at that split instead (early),
+    // and changes at or past the end of the block are applied after it. at most 1024 per call (in a block mode: pending in
+    // all, and in any order), the rest are dropped with a warning
+    CVSTHOST_API void CDECL CVST_SetBlockParameterChanges(CVST_Plugin plugin, const CVST_ParameterChange *changes, int numChanges);
+    CVSTHOST_API void CDECL CVST_SetMinSubBlockLength(CVST_Plugin plugin, int frames); // default 32
+
+    // per-instance DSP load, measured around every process call (including event dispatch and any block splitting)
+    #define CVST_STATS_HISTOGRAM_BUCKETS 24
+    typedef struct {
+        unsigned long long blocks;
+        double lastTime, avgTime, maxTime; // microseconds
+        double lastEventTime, maxEventTime; // part of the above spent in effProcessEvents
+        double lastLoad, avgLoad, maxLoad; // time / block deadline (frames / sample rate)
+        unsigned long long overruns; // blocks whose load exceeded the budget
+        unsigned long long histogram[CVST_STATS_HISTOGRAM_BUCKETS]; // block times: [0] < 1us, [i] 2^(i-1) .. 2^i us, last is open-ended
+    } CVST_Stats;
+    // lock-free and consistent, from any thread (eg a monitoring one)
+    CVSTHOST_API void CDECL CVST_GetStats(CVST_Plugin plugin, CVST_Stats *stats);
+    CVSTHOST_API void CDECL CVST_ResetStats(CVST_Plugin plugin); // takes effect at the next block
+    CVSTHOST_API void CDECL CVST_SetStatsBudget(CVST_Plugin plugin, double fractionOfDeadline); // default 1.0
+
+    // renders an entire (pre-allocated, totalFrames-long) buffer as fast as possible, reporting kVstProcessLevelOffline to the plugin
+    // blockSize <= 0 lets the host choose a large one; the plugin's previous block size is restored afterwards
+    // events: sorted, with sampleOffs relative to the start of the whole render (not per block)
+    // the output is delayed by the plugin's latency (CVST_GetLatency): render that many extra frames and trim them from the start
+    CVSTHOST_API void CDECL CVST_RenderOffline(CVST_Plugin plugin, float **inputs, float **outputs, unsigned int totalFrames, int blockSize, CVST_MidiEvent *events, int numEvents);
 
     typedef struct {
         int numInputs;
         int numOutputs;
         bool isInstrument;
+        bool canDoubleReplacing; // native 64-bit processing (effFlagsCanDoubleReplacing)
     } CVST_Properties;
     CVSTHOST_API void CDECL CVST_GetProperties(CVST_Plugin plugin, CVST_Properties *props);
+    // frames the plugin delays its output by (initialDelay, plus the block adapter's and oversampling filters' delay, if any)
+    // -- plugins change it along with audioMasterIOChanged, so ask again after resuming. wait-free, from any thread
+    CVSTHOST_API int CDECL CVST_GetLatency(CVST_Plugin plugin);
+
+    // everything a host typically wants to know about a plugin before deciding to instantiate it (see also the scan cache below)
+    typedef enum {
+        CVST_PlugCanDo_SendVstEvents = 1 << 0,
+        CVST_PlugCanDo_SendVstMidiEvent = 1 << 1,
+        CVST_PlugCanDo_ReceiveVstEvents = 1 << 2,
+        CVST_PlugCanDo_ReceiveVstMidiEvent = 1 << 3,
+        CVST_PlugCanDo_ReceiveVstTimeInfo = 1 << 4,
+        CVST_PlugCanDo_Offline = 1 << 5,
+        CVST_PlugCanDo_MidiProgramNames = 1 << 6,
+        CVST_PlugCanDo_Bypass = 1 << 7
+    } CVST_PlugCanDo;
+    typedef struct {
+        int uniqueID;
+        int version;
+        int category; // VstPlugCategory
+        int numInputs, numOutputs;
+        int numParams, numPrograms;
+        int flags; // VstAEffectFlags
+        bool isInstrument;
+        unsigned int canDos; // CVST_PlugCanDo bits, for the canDos the plugin answered 1 to
+        int vendorVersion;
+        char name[64];
+        char vendor[64];
+        char product[64];
+    } CVST_PluginInfo;
+    CVSTHOST_API void CDECL CVST_GetPluginInfo(CVST_Plugin plugin, CVST_PluginInfo *info); // some plugins only answer after CVST_Start
 
     enum CVST_ChunkType {
         ChunkType_Bank,
         ChunkType_Program
     };
-    CVSTHOST_API void CDECL CVST_GetChunk(CVST_Plugin plugin, enum CVST_ChunkType chunkType, void** data, size_t* length); // will allocate and copy
+    // *data is owned by the plugin, and only valid until the next call into it -- copy it right away (or see CVST_PresetStoreAdd)
+    CVSTHOST_API void CDECL CVST_GetChunk(CVST_Plugin plugin, enum CVST_ChunkType chunkType, void** data, size_t* length);
     CVSTHOST_API void CDECL CVST_SetChunk(CVST_Plugin plugin, enum CVST_ChunkType chunkType, void* source, size_t length); // set from memory
 
+    // CVST_SetChunk without stalling anyone (sample-based instruments can take seconds): another instance of the plugin is
+    // loaded on a background thread, given the chunk (copied) and warmed up, then swapped in by the next process call --
+    // crossfading from the current one over crossfadeFrames (0: a hard switch at the block boundary). during the fade the old
+    // instance gets the block's MIDI and parameter changes too (at the start of each block); CVST_SetParameters only the new one
+    // the old instance is closed by CVST_GetStateLoadStatus (poll it) or CVST_Destroy; don't reconfigure the plugin
+    // (sample rate, block size, suspend/resume ...) while one is pending. false if one is in flight, or the editor is open
+    enum CVST_StateLoadStatus {
+        StateLoad_Idle, // none requested
+        StateLoad_Pending, // loading, or waiting for the next process call
+        StateLoad_Crossfading,
+        StateLoad_Done, // (the last one, until the next request)
+        StateLoad_Failed
+    };
+    CVSTHOST_API bool CDECL CVST_SetChunkAsync(CVST_Plugin plugin, enum CVST_ChunkType chunkType, const void *source, size_t length, int crossfadeFrames);
+    CVSTHOST_API enum CVST_StateLoadStatus CDECL CVST_GetStateLoadStatus(CVST_Plugin plugin);
+
+    // === sample format conversion ===
+    // fused driver-format <-> plugin-buffer conversion and channel routing, in a single pass (SSE2/AVX2 where available)
+    // integer formats are little-endian and full-scale at +/-1.0f; float -> integer clips
+
+    typedef enum {
+        CVST_SampleFormat_Int16,
+        CVST_SampleFormat_Int24, // packed, 3 bytes per sample
+        CVST_SampleFormat_Int32,
+        CVST_SampleFormat_Float32,
+        CVST_SampleFormat_Float64,
+    } CVST_SampleFormat;
+
+    typedef struct {
+        CVST_SampleFormat format;
+        int numChannels;
+        bool interleaved; // if so, only buffers[0] is used
+    } CVST_BufferLayout;
+
+    // routing[i]: driver channel feeding plugin channel i (numPluginChannels entries), -1 for silence; NULL = 1:1
+    CVSTHOST_API void CDECL CVST_ConvertToFloat(const CVST_BufferLayout *layout, const void * const *driverBuffers, float **pluginBuffers, int numPluginChannels, const int *routing, unsigned int sampleFrames);
+    // routing[i]: plugin channel feeding driver channel i (layout->numChannels entries), -1 for silence; NULL = 1:1
+    CVSTHOST_API void CDECL CVST_ConvertFromFloat(const CVST_BufferLayout *layout, float **pluginBuffers, int numPluginChannels, void **driverBuffers, const int *routing, unsigned int sampleFrames);
+
+    // === plugin graphs ===
+    // plugin nodes connected by audio/MIDI edges, compiled into a schedule that reuses a small pool of intermediate buffers
+    // plugins are still owned (loaded/started/resumed/destroyed) by the client; the graph only processes them
+    // the graph must not be modified concurrently with CVST_GraphProcess
+
+    APIHANDLE(CVST_Graph);
+
+    #define CVST_GRAPH_IO_NODE -1 // the graph's own inputs (as an edge source) and outputs (as an edge destination)
+
+    CVSTHOST_API CVST_Graph CDECL CVST_GraphCreate(int numInputs, int numOutputs, int maxBlockSize);
+    CVSTHOST_API void CDECL CVST_GraphDestroy(CVST_Graph graph);
+    CVSTHOST_API int CDECL CVST_GraphAddPlugin(CVST_Graph graph, CVST_Plugin plugin); // returns node ID
+    // multiple edges into the same input channel are summed; returns false for invalid nodes/channels
+    CVSTHOST_API bool CDECL CVST_GraphConnectAudio(CVST_Graph graph, int srcNode, int srcChannel, int destNode, int destChannel);
+    // srcNode: CVST_GRAPH_IO_NODE (the events passed to CVST_GraphProcess) or a plugin, whose output events are forwarded
+    // each node currently takes MIDI from one source only (returns false for a second one)
+    CVSTHOST_API bool CDECL CVST_GraphConnectMidi(CVST_Graph graph, int srcNode, int destNode);
+    // must be called after the last modification and before processing (allocates), returns false if the graph has a cycle
+    CVSTHOST_API bool CDECL CVST_GraphCompile(CVST_Graph graph);
+    CVSTHOST_API int CDECL CVST_GraphGetBufferCount(CVST_Graph graph); // intermediate buffers allocated by the last compile
+    // events: block-relative, as with CVST_SetBlockEvents; delivered to every node with a MIDI edge from CVST_GRAPH_IO_NODE
+    // outputs may be the inputs (in place)
+    CVSTHOST_API void CDECL CVST_GraphProcess(CVST_Graph graph, float **inputs, float **outputs, unsigned int sampleFrames, CVST_MidiEvent *events, int numEvents);
+
+    // === process groups ===
+    // processes a set of independent plugin instances for one block across a pool of pinned worker threads (the calling
+    // thread works too), with work stealing; members are started in order of their measured cost, most expensive first
+    // members must not be added concurrently with CVST_ProcessGroupProcess
+
+    APIHANDLE(CVST_ProcessGroup);
+
+    CVSTHOST_API CVST_ProcessGroup CDECL CVST_ProcessGroupCreate(int numWorkers); // extra threads besides the caller's, <= 0: one per remaining core
+    CVSTHOST_API void CDECL CVST_ProcessGroupDestroy(CVST_ProcessGroup group);
+    CVSTHOST_API int CDECL CVST_ProcessGroupAdd(CVST_ProcessGroup group, CVST_Plugin plugin, float **inputs, float **outputs); // returns member index
+    CVSTHOST_API void CDECL CVST_ProcessGroupSetBuffers(CVST_ProcessGroup group, int member, float **inputs, float **outputs);
+    // events should be set per plugin (CVST_SetBlockEvents) beforehand; returns once every member has been processed
+    CVSTHOST_API void CDECL CVST_ProcessGroupProcess(CVST_ProcessGroup group, unsigned int sampleFrames);
+
+    // === parallel mixes ===
+    // several plugin instances on the same input, their outputs summed with delay compensation: each one is held back by
+    // the difference between its latency and the largest, so that they line up. the delay lines are allocated when a member
+    // is added (for latencies up to maxLatency), and latency changes are picked up at the next block without allocating.
+    // a member over maxLatency is logged and left late by the excess, and the mix latency reports its own
+    // members are processed in order on the calling thread; outputs may be the inputs (in place)
+
+    APIHANDLE(CVST_ParallelMix);
+
+    CVSTHOST_API CVST_ParallelMix CDECL CVST_ParallelMixCreate(int numChannels, int maxBlockSize, int maxLatency);
+    CVSTHOST_API void CDECL CVST_ParallelMixDestroy(CVST_ParallelMix mix);
+    CVSTHOST_API int CDECL CVST_ParallelMixAdd(CVST_ParallelMix mix, CVST_Plugin plugin, float gain); // returns member index
+    CVSTHOST_API void CDECL CVST_ParallelMixSetGain(CVST_ParallelMix mix, int member, float gain);
+    // the latency of the mix output (that of its slowest member, as of the last block, even beyond maxLatency) -- what an
+    // offline render should trim; may be read from any thread
+    CVSTHOST_API int CDECL CVST_ParallelMixGetLatency(CVST_ParallelMix mix);
+    CVSTHOST_API void CDECL CVST_ParallelMixProcess(CVST_ParallelMix mix, float **inputs, float **outputs, unsigned int sampleFrames);
+
+    // === instance pools ===
+    // keeps a number of instances of one plugin loaded, started (at sampleRate / blockSize) and resumed on a background
+    // thread, so that acquiring one doesn't wait for any of that. released instances are reset (the state they were loaded
+    // with, CVST_ResetHostState, the host settings a new instance has -- block mode, oversampling, sleep mode, precision,
+    // event capacity, stats budget -- suspend/resume) and re-used, or destroyed if the pool is full
+    // acquire/release from any (non-realtime) thread
+
+    APIHANDLE(CVST_InstancePool);
+
+    CVSTHOST_API CVST_InstancePool CDECL CVST_InstancePoolCreate(const char *pathToPlugin, bool bridged, int size, float sampleRate, int blockSize);
+    // destroys the pooled instances; acquired ones are the client's (CVST_Destroy them, they can't be released any more)
+    CVSTHOST_API void CDECL CVST_InstancePoolDestroy(CVST_InstancePool pool);
+    // an instance, with the chunk applied if given -- loaded right here if none is ready; NULL if that fails
+    CVSTHOST_API CVST_Plugin CDECL CVST_InstancePoolAcquire(CVST_InstancePool pool, void *userData,
+        enum CVST_ChunkType chunkType, const void *chunk, size_t chunkSize);
+    CVSTHOST_API void CDECL CVST_InstancePoolRelease(CVST_InstancePool pool, CVST_Plugin plugin); // not while processing it
+    CVSTHOST_API int CDECL CVST_InstancePoolGetReadyCount(CVST_InstancePool pool);
+
+    // === scan cache ===
+    // an on-disk index of CVST_PluginInfo, keyed by path + file size + modification time, so that later runs can answer from
+    // the (memory-mapped) index without loading anything, and only new or changed binaries have to be scanned again
+    // not thread-safe: use a cache from one thread at a time
+
+    APIHANDLE(CVST_ScanCache);
+
+    CVSTHOST_API CVST_ScanCache CDECL CVST_ScanCacheOpen(const char *indexPath); // maps the index if it exists (and is valid), never NULL
+    CVSTHOST_API void CDECL CVST_ScanCacheClose(CVST_ScanCache cache);
+    // stats every path, and loads the new/changed ones (+ CVST_Start) across numThreads threads (<= 0: one per core);
+    // then writes and re-maps the index, which ends up holding exactly these paths (in sorted order)
+    // plugins are loaded bridged once CVST_SetBridgePath is set, so one that crashes is just marked failed -- without a
+    // bridge they're loaded in-process (warned), and a crash takes the host down with it
+    // returns the number of binaries scanned, or -1 if the index couldn't be written (the old one stays usable)
+    CVSTHOST_API int CDECL CVST_ScanCacheUpdate(CVST_ScanCache cache, const char * const *paths, int numPaths, int numThreads);
+    CVSTHOST_API int CDECL CVST_ScanCacheGetCount(CVST_ScanCache cache);
+    CVSTHOST_API const char * CDECL CVST_ScanCacheGetPath(CVST_ScanCache cache, int index); // valid until the next update / close
+    CVSTHOST_API bool CDECL CVST_ScanCacheGetInfo(CVST_ScanCache cache, int index, CVST_PluginInfo *info); // false if it failed to load
+    CVSTHOST_API int CDECL CVST_ScanCacheFind(CVST_ScanCache cache, const char *path); // index, or -1
+
+    // === preset store ===
+    // many named chunks in a single memory-mapped file, stored once per distinct content (and optionally compressed), so that
+    // switching programs is an effSetChunk straight from the mapping -- no file I/O or allocation
+    // additions are kept in memory (and are usable right away) until committed; not thread-safe, like the scan cache
+
+    APIHANDLE(CVST_PresetStore);
+
+    typedef struct {
+        const char *name; // valid until the next commit / close
+        int pluginID; // CVST_PluginInfo.uniqueID of the plugin it was saved from (0: unknown)
+        enum CVST_ChunkType chunkType;
+        size_t size; // uncompressed
+        bool compressed;
+    } CVST_PresetInfo;
+
+    CVSTHOST_API CVST_PresetStore CDECL CVST_PresetStoreOpen(const char *path); // maps the file if it exists (and is valid), never NULL
+    CVSTHOST_API void CDECL CVST_PresetStoreClose(CVST_PresetStore store); // (uncommitted additions are discarded)
+    CVSTHOST_API int CDECL CVST_PresetStoreGetCount(CVST_PresetStore store);
+    CVSTHOST_API bool CDECL CVST_PresetStoreGetInfo(CVST_PresetStore store, int index, CVST_PresetInfo *info);
+    CVSTHOST_API int CDECL CVST_PresetStoreFind(CVST_PresetStore store, const char *name); // index, or -1
+    // the chunk itself: in the mapping, or (compressed entries) a buffer reused by the next call -- NULL if corrupt
+    CVSTHOST_API const void * CDECL CVST_PresetStoreGetData(CVST_PresetStore store, int index, size_t *size);
+    CVSTHOST_API bool CDECL CVST_PresetStoreApply(CVST_PresetStore store, int index, CVST_Plugin plugin); // CVST_SetChunk with the entry's data
+    // adds (or, for an existing name, replaces) an entry, returns its index; identical content is only stored once
+    CVSTHOST_API int CDECL CVST_PresetStoreAdd(CVST_PresetStore store, const char *name, int pluginID, enum CVST_ChunkType chunkType,
+        const void *data, size_t size, bool compress);
+    CVSTHOST_API int CDECL CVST_PresetStoreAddFromPlugin(CVST_PresetStore store, const char *name, CVST_Plugin plugin, enum CVST_ChunkType chunkType, bool compress);
+    // writes everything to the file (replacing it atomically) and re-maps it; content no longer referenced is dropped
+    CVSTHOST_API bool CDECL CVST_PresetStoreCommit(CVST_PresetStore store);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,48 @@
+#ifndef __CVSTHOST_DENORMALS_H__
+#define __CVSTHOST_DENORMALS_H__
+
+// (internal) flush-to-zero / denormals-are-zero for the duration of a process call
+//
+// decaying tails (reverbs, filters, envelopes) end up in the denormal range, where every operation on them can be
+// ~100x slower -- with FTZ/DAZ they're just zero. the calling thread's previous mode is restored afterwards.
+// SSE's MXCSR on x86, FPCR.FZ on 64-bit ARM, a no-op elsewhere.
+
+#include <stdint.h>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define MXCSR_FTZ 0x8000
+#define MXCSR_DAZ 0x0040
+
+class DenormalGuard {
+    unsigned int saved;
+public:
+    DenormalGuard() : saved(_mm_getcsr()) {
+        _mm_setcsr(saved | MXCSR_FTZ | MXCSR_DAZ);
+    }
+    ~DenormalGuard() {
+        _mm_setcsr(saved);
+    }
+};
+#elif defined(__aarch64__) && (defined(__GNUC__) || defined(__clang__))
+#define FPCR_FZ (1ull << 24)
+
+class DenormalGuard {
+    uint64_t saved;
+public:
+    DenormalGuard() {
+        __asm__ __volatile__("mrs %0, fpcr" : "=r"(saved));
+        __asm__ __volatile__("msr fpcr, %0" : : "r"(saved | FPCR_FZ));
+    }
+    ~DenormalGuard() {
+        __asm__ __volatile__("msr fpcr, %0" : : "r"(saved));
+    }
+};
+#else
+class DenormalGuard {
+public:
+    DenormalGuard() {}
+};
+#endif
+
+#endif // __CVSTHOST_DENORMALS_H__
@@ -0,0 +1,126 @@
+#ifndef __CVSTHOST_EVENTTIMELINE_H__
+#define __CVSTHOST_EVENTTIMELINE_H__
+
+// (internal) per-plugin MIDI timeline, keyed by absolute sample position
+//
+// events can be scheduled any number of times per block, and any distance ahead; each process call
+// takes the slice that falls before the end of its block. storage is preallocated by init():
+// a batch is merged with the pending events into the spare array, which is then swapped in -- so
+// merging costs O(pending + batch) and never allocates. a batch that starts at or after the last
+// pending event (the usual case) is simply appended. unsorted batches are merged one sorted run at a time.
+// events at the same position keep the order they were scheduled in.
+// single-threaded: schedule and take from the audio thread.
+
+#include <stdint.h>
+#include <algorithm>
+#include <vector>
+#include <utility>
+#include "CVSTHost.h"
+
+struct TimelineEvent {
+    uint64_t samplePos;
+    uint32_t data;
+};
+
+class EventTimeline {
+    std::vector<TimelineEvent> events;
+    std::vector<TimelineEvent> spare; // merge target
+    size_t head = 0, count = 0; // pending events are events[head, head + count)
+
+    // makes room at the end for 'n' more, if the pending events don't start at the front
+    void compact() {
+        if (head > 0) {
+            std::move(events.begin() + head, events.begin() + head + count, events.begin());
+            head = 0;
+        }
+    }
+
+    void mergeRun(uint64_t basePos, const CVST_MidiEvent *run, size_t n) {
+        if (count == 0 || basePos + run[0].sampleOffs >= events[head + count - 1].samplePos) {
+            if (head + count + n > events.size()) {
+                compact();
+            }
+            auto dest = &events[head + count];
+            for (size_t i = 0; i < n; i++) {
+                dest[i].samplePos = basePos + run[i].sampleOffs;
+                dest[i].data = run[i].data.uint32;
+            }
+            count += n;
+            return;
+        }
+        size_t a = head, aEnd = head + count, b = 0, out = 0;
+        while (a < aEnd && b < n) {
+            auto pos = basePos + run[b].sampleOffs;
+            if (events[a].samplePos <= pos) {
+                spare[out++] = events[a++];
+            }
+            else {
+                spare[out].samplePos = pos;
+                spare[out++].data = run[b++].data.uint32;
+            }
+        }
+        while (a < aEnd) {
+            spare[out++] = events[a++];
+        }
+        for (; b < n; b++) {
+            spare[out].samplePos = basePos + run[b].sampleOffs;
+            spare[out++].data = run[b].data.uint32;
+        }
+        std::swap(events, spare);
+        head = 0;
+        count = out;
+    }
+
+public:
+    void init(size_t capacity) {
+        events.resize(capacity);
+        spare.resize(capacity);
+        head = count = 0;
+    }
+
+    inline size_t pending() const { return count; }
+    inline bool due(uint64_t endPos) const { return count > 0 && events[head].samplePos < endPos; }
+
+    // events' sampleOffs are relative to basePos; returns how many didn't fit (dropped, from the end of the batch)
+    int schedule(uint64_t basePos, const CVST_MidiEvent *batch, int numEvents) {
+        auto room = (int)(events.size() - count);
+        auto dropped = std::max(numEvents - room, 0);
+        numEvents -= dropped;
+        for (int start = 0; start < numEvents; ) {
+            auto end = start + 1;
+            while (end < numEvents && batch[end].sampleOffs >= batch[end - 1].sampleOffs) {
+                end++;
+            }
+            mergeRun(basePos, &batch[start], end - start);
+            start = end;
+        }
+        return dropped;
+    }
+
+    // returns (up to maxEvents of) the events before endPos, in order, leaving them pending -- valid until the next change
+    int peek(uint64_t endPos, int maxEvents, const TimelineEvent **slice) const {
+        *slice = events.data() + head;
+        int n = 0;
+        while (n < maxEvents && (size_t)n < count && events[head + n].samplePos < endPos) {
+            n++;
+        }
+        return n;
+    }
+
+    // removes and returns (up to maxEvents of) the events before endPos, in order -- valid until the next schedule()
+    int take(uint64_t endPos, int maxEvents, const TimelineEvent **slice) {
+        auto n = peek(endPos, maxEvents, slice);
+        head += n;
+        count -= n;
+        if (count == 0) {
+            head = 0;
+        }
+        return n;
+    }
+
+    void clear() {
+        head = count = 0;
+    }
+};
+
+#endif // __CVSTHOST_EVENTTIMELINE_H__
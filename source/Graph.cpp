@@ -0,0 +1,414 @@
+// Graph.cpp : plugin graphs (CVST_Graph*)
+//
+// compiling a graph produces a flat, topologically sorted list of steps (one per plugin node).
+// every plugin output channel is a value with a lifetime (producing step .. last consuming step),
+// and values are packed into a small pool of buffers with a linear scan -- a buffer is returned to
+// the pool as soon as its last consumer has run, and the most recently released one is handed out
+// next, so a long serial chain ping-pongs between a few cache-hot buffers.
+
+#include "CVSTHost.h"
+
+#include <string.h>
+#include <algorithm>
+#include <vector>
+
+#define BUFFER_ALIGN_FLOATS 16 // 64 bytes, keeps every pool buffer cache-line (and AVX) aligned
+
+namespace {
+    const int kNoMidiSource = -2;
+
+    enum RefKind {
+        kRefGraphInput, // caller's input channel
+        kRefBuffer,     // pool buffer
+        kRefSilence     // shared zero buffer
+    };
+
+    struct ChannelRef {
+        RefKind kind;
+        int index;
+    };
+
+    struct AudioEdge {
+        int srcNode, srcChannel;
+        int destNode, destChannel;
+    };
+
+    struct Node {
+        CVST_Plugin plugin;
+        int numInputs;
+        int numOutputs;
+        int midiSource = kNoMidiSource; // CVST_GRAPH_IO_NODE or a plugin node, whose output events are forwarded
+    };
+
+    // one plugin input (or graph output) channel: a single source is passed through untouched,
+    // several are summed into mixBuffer
+    struct InputBinding {
+        std::vector<ChannelRef> sources;
+        int mixBuffer = -1;
+    };
+
+    struct Step {
+        int node;
+        std::vector<InputBinding> inputs;
+        std::vector<int> outputBuffers;
+        // resolved per block (graph input pointers can change between calls), but never reallocated
+        std::vector<float *> inputPtrs;
+        std::vector<float *> outputPtrs;
+    };
+}
+
+struct _CVST_Graph {
+    int numInputs;
+    int numOutputs;
+    int maxBlockSize;
+
+    std::vector<Node> nodes;
+    std::vector<AudioEdge> audioEdges;
+
+    // compiled state
+    bool compiled = false;
+    std::vector<Step> schedule;
+    std::vector<InputBinding> graphOutputs;
+    int numBuffers = 0;
+    size_t bufferStride = 0;
+    std::vector<float> bufferStorage;
+    float *bufferBase = nullptr;
+    std::vector<float> silenceStorage;
+    float *silence = nullptr;
+
+    _CVST_Graph(int numInputs, int numOutputs, int maxBlockSize)
+        :numInputs(numInputs), numOutputs(numOutputs), maxBlockSize(maxBlockSize) {}
+
+    inline bool validNode(int node) {
+        return node >= 0 && node < (int)nodes.size();
+    }
+
+    inline float *bufferAt(int index) {
+        return bufferBase + index * bufferStride;
+    }
+
+    inline float *resolve(const ChannelRef &ref, float **inputs) {
+        switch (ref.kind) {
+        case kRefGraphInput:
+            return inputs[ref.index];
+        case kRefBuffer:
+            return bufferAt(ref.index);
+        default:
+            return silence;
+        }
+    }
+
+    void sumInto(float *dest, const InputBinding &binding, float **inputs, unsigned int sampleFrames) {
+        memcpy(dest, resolve(binding.sources[0], inputs), sampleFrames * sizeof(float));
+        for (size_t i = 1; i < binding.sources.size(); i++) {
+            auto src = resolve(binding.sources[i], inputs);
+            for (unsigned int j = 0; j < sampleFrames; j++) {
+                dest[j] += src[j];
+            }
+        }
+    }
+
+    // returns the pointer to read for this binding, summing into its mix buffer first if needed
+    float *mix(const InputBinding &binding, float **inputs, unsigned int sampleFrames) {
+        if (binding.mixBuffer < 0) {
+            return resolve(binding.sources[0], inputs);
+        }
+        auto dest = bufferAt(binding.mixBuffer);
+        sumInto(dest, binding, inputs, sampleFrames);
+        return dest;
+    }
+};
+
+namespace {
+    // linear-scan buffer allocator: LIFO free list so the warmest buffer is reused first
+    struct BufferAllocator {
+        std::vector<int> freeList;
+        int count = 0;
+
+        int acquire() {
+            if (freeList.empty()) {
+                return count++;
+            }
+            auto ret = freeList.back();
+            freeList.pop_back();
+            return ret;
+        }
+        void release(int buffer) {
+            freeList.push_back(buffer);
+        }
+    };
+
+    // Kahn's algorithm; returns false on a cycle
+    bool topologicalOrder(CVST_Graph graph, const std::vector<std::pair<int, int>> &deps, std::vector<int> &order) {
+        auto numNodes = (int)graph->nodes.size();
+        std::vector<int> inDegree(numNodes, 0);
+        std::vector<std::vector<int>> successors(numNodes);
+        for (auto &dep : deps) {
+            successors[dep.first].push_back(dep.second);
+            inDegree[dep.second]++;
+        }
+        std::vector<int> ready;
+        for (int i = numNodes - 1; i >= 0; i--) {
+            if (inDegree[i] == 0) {
+                ready.push_back(i);
+            }
+        }
+        order.clear();
+        while (!ready.empty()) {
+            // depth-first (stack) order keeps a producer's consumers close behind it, which shortens lifetimes
+            auto node = ready.back();
+            ready.pop_back();
+            order.push_back(node);
+            for (auto it = successors[node].rbegin(); it != successors[node].rend(); ++it) {
+                if (--inDegree[*it] == 0) {
+                    ready.push_back(*it);
+                }
+            }
+        }
+        return (int)order.size() == numNodes;
+    }
+}
+
+CVSTHOST_API CVST_Graph CDECL CVST_GraphCreate(int numInputs, int numOutputs, int maxBlockSize)
+{
+    return new _CVST_Graph(numInputs, numOutputs, maxBlockSize);
+}
+
+CVSTHOST_API void CDECL CVST_GraphDestroy(CVST_Graph graph)
+{
+    delete graph;
+}
+
+CVSTHOST_API int CDECL CVST_GraphAddPlugin(CVST_Graph graph, CVST_Plugin plugin)
+{
+    CVST_Properties props;
+    CVST_GetProperties(plugin, &props);
+
+    Node node;
+    node.plugin = plugin;
+    node.numInputs = props.numInputs;
+    node.numOutputs = props.numOutputs;
+    graph->nodes.push_back(node);
+    graph->compiled = false;
+    return (int)graph->nodes.size() - 1;
+}
+
+CVSTHOST_API bool CDECL CVST_GraphConnectAudio(CVST_Graph graph, int srcNode, int srcChannel, int destNode, int destChannel)
+{
+    auto srcChannels = srcNode == CVST_GRAPH_IO_NODE ? graph->numInputs
+        : graph->validNode(srcNode) ? graph->nodes[srcNode].numOutputs : 0;
+    auto destChannels = destNode == CVST_GRAPH_IO_NODE ? graph->numOutputs
+        : graph->validNode(destNode) ? graph->nodes[destNode].numInputs : 0;
+    if (srcChannel < 0 || srcChannel >= srcChannels || destChannel < 0 || destChannel >= destChannels) {
+        return false;
+    }
+    graph->audioEdges.push_back(AudioEdge{ srcNode, srcChannel, destNode, destChannel });
+    graph->compiled = false;
+    return true;
+}
+
+CVSTHOST_API bool CDECL CVST_GraphConnectMidi(CVST_Graph graph, int srcNode, int destNode)
+{
+    if ((srcNode != CVST_GRAPH_IO_NODE && !graph->validNode(srcNode)) || !graph->validNode(destNode) || srcNode == destNode) {
+        return false;
+    }
+    auto &dest = graph->nodes[destNode];
+    if (dest.midiSource != kNoMidiSource && dest.midiSource != srcNode) {
+        return false;
+    }
+    dest.midiSource = srcNode;
+    graph->compiled = false;
+    return true;
+}
+
+CVSTHOST_API bool CDECL CVST_GraphCompile(CVST_Graph graph)
+{
+    graph->compiled = false;
+    graph->schedule.clear();
+    graph->graphOutputs.clear();
+
+    // ordering constraints
+    std::vector<std::pair<int, int>> deps;
+    for (auto &edge : graph->audioEdges) {
+        if (edge.srcNode != CVST_GRAPH_IO_NODE && edge.destNode != CVST_GRAPH_IO_NODE) {
+            deps.push_back(std::make_pair(edge.srcNode, edge.destNode));
+        }
+    }
+    for (size_t i = 0; i < graph->nodes.size(); i++) {
+        if (graph->nodes[i].midiSource >= 0) {
+            deps.push_back(std::make_pair(graph->nodes[i].midiSource, (int)i));
+        }
+    }
+    std::vector<int> order;
+    if (!topologicalOrder(graph, deps, order)) {
+        return false;
+    }
+
+    auto numSteps = (int)order.size();
+    std::vector<int> stepOfNode(graph->nodes.size());
+    for (int i = 0; i < numSteps; i++) {
+        stepOfNode[order[i]] = i;
+    }
+
+    // lifetimes: the last step reading each plugin output (numSteps == the graph output stage)
+    std::vector<std::vector<int>> lastUse(graph->nodes.size());
+    for (size_t i = 0; i < graph->nodes.size(); i++) {
+        lastUse[i].assign(graph->nodes[i].numOutputs, -1);
+    }
+    for (auto &edge : graph->audioEdges) {
+        if (edge.srcNode != CVST_GRAPH_IO_NODE) {
+            auto consumer = edge.destNode == CVST_GRAPH_IO_NODE ? numSteps : stepOfNode[edge.destNode];
+            auto &last = lastUse[edge.srcNode][edge.srcChannel];
+            last = std::max(last, consumer);
+        }
+    }
+
+    // values dying at each step, released once that step has been laid out
+    std::vector<std::vector<int>> dyingAt(numSteps + 1);
+    std::vector<std::vector<int>> bufferOfOutput(graph->nodes.size());
+
+    BufferAllocator allocator;
+    for (int s = 0; s < numSteps; s++) {
+        auto nodeIndex = order[s];
+        auto &node = graph->nodes[nodeIndex];
+
+        Step step;
+        step.node = nodeIndex;
+        step.inputs.resize(node.numInputs);
+        for (int ch = 0; ch < node.numInputs; ch++) {
+            auto &binding = step.inputs[ch];
+            for (auto &edge : graph->audioEdges) {
+                if (edge.destNode == nodeIndex && edge.destChannel == ch) {
+                    binding.sources.push_back(edge.srcNode == CVST_GRAPH_IO_NODE
+                        ? ChannelRef{ kRefGraphInput, edge.srcChannel }
+                        : ChannelRef{ kRefBuffer, bufferOfOutput[edge.srcNode][edge.srcChannel] });
+                }
+            }
+            if (binding.sources.empty()) {
+                binding.sources.push_back(ChannelRef{ kRefSilence, 0 });
+            }
+        }
+
+        // mix buffers only live for the duration of this step
+        std::vector<int> scratch;
+        for (auto &binding : step.inputs) {
+            if (binding.sources.size() > 1) {
+                binding.mixBuffer = allocator.acquire();
+                scratch.push_back(binding.mixBuffer);
+            }
+        }
+
+        // outputs must not alias anything read by this step, so allocate before releasing
+        bufferOfOutput[nodeIndex].resize(node.numOutputs);
+        step.outputBuffers.resize(node.numOutputs);
+        for (int ch = 0; ch < node.numOutputs; ch++) {
+            auto buffer = allocator.acquire();
+            bufferOfOutput[nodeIndex][ch] = buffer;
+            step.outputBuffers[ch] = buffer;
+            auto last = lastUse[nodeIndex][ch];
+            if (last < 0) {
+                scratch.push_back(buffer); // nobody listens, plugin still needs somewhere to write
+            }
+            else {
+                dyingAt[last].push_back(buffer);
+            }
+        }
+
+        for (auto buffer : scratch) {
+            allocator.release(buffer);
+        }
+        for (auto buffer : dyingAt[s]) {
+            allocator.release(buffer);
+        }
+
+        step.inputPtrs.resize(node.numInputs);
+        step.outputPtrs.resize(node.numOutputs);
+        graph->schedule.push_back(std::move(step));
+    }
+
+    // graph outputs read whatever is still live, and sum into the caller's buffers directly -- except those reading a
+    // graph input, which are staged in a buffer of their own (mixBuffer) first, as the caller's outputs may be its inputs
+    graph->graphOutputs.resize(graph->numOutputs);
+    for (int ch = 0; ch < graph->numOutputs; ch++) {
+        auto &binding = graph->graphOutputs[ch];
+        for (auto &edge : graph->audioEdges) {
+            if (edge.destNode == CVST_GRAPH_IO_NODE && edge.destChannel == ch) {
+                binding.sources.push_back(edge.srcNode == CVST_GRAPH_IO_NODE
+                    ? ChannelRef{ kRefGraphInput, edge.srcChannel }
+                    : ChannelRef{ kRefBuffer, bufferOfOutput[edge.srcNode][edge.srcChannel] });
+                if (edge.srcNode == CVST_GRAPH_IO_NODE && binding.mixBuffer < 0) {
+                    binding.mixBuffer = allocator.acquire();
+                }
+            }
+        }
+    }
+
+    // one contiguous, aligned allocation for the whole pool
+    graph->numBuffers = allocator.count;
+    graph->bufferStride = ((size_t)graph->maxBlockSize + BUFFER_ALIGN_FLOATS - 1) / BUFFER_ALIGN_FLOATS * BUFFER_ALIGN_FLOATS;
+    graph->bufferStorage.assign(graph->numBuffers * graph->bufferStride + BUFFER_ALIGN_FLOATS, 0.0f);
+    auto misalign = ((size_t)graph->bufferStorage.data() / sizeof(float)) % BUFFER_ALIGN_FLOATS;
+    graph->bufferBase = graph->bufferStorage.data() + (misalign ? BUFFER_ALIGN_FLOATS - misalign : 0);
+    graph->silenceStorage.assign(graph->maxBlockSize, 0.0f);
+    graph->silence = graph->silenceStorage.data();
+
+    graph->compiled = true;
+    return true;
+}
+
+CVSTHOST_API int CDECL CVST_GraphGetBufferCount(CVST_Graph graph)
+{
+    return graph->numBuffers;
+}
+
+CVSTHOST_API void CDECL CVST_GraphProcess(CVST_Graph graph, float **inputs, float **outputs, unsigned int sampleFrames, CVST_MidiEvent *events, int numEvents)
+{
+    if (!graph->compiled || sampleFrames > (unsigned int)graph->maxBlockSize) {
+        for (int ch = 0; ch < graph->numOutputs; ch++) {
+            memset(outputs[ch], 0, sampleFrames * sizeof(float));
+        }
+        return;
+    }
+
+    for (auto &step : graph->schedule) {
+        auto &node = graph->nodes[step.node];
+        for (size_t ch = 0; ch < step.inputs.size(); ch++) {
+            step.inputPtrs[ch] = graph->mix(step.inputs[ch], inputs, sampleFrames);
+        }
+        for (size_t ch = 0; ch < step.outputBuffers.size(); ch++) {
+            step.outputPtrs[ch] = graph->bufferAt(step.outputBuffers[ch]);
+        }
+        if (node.midiSource == CVST_GRAPH_IO_NODE && numEvents > 0) {
+            CVST_SetBlockEvents(node.plugin, events, numEvents);
+        }
+        else if (node.midiSource >= 0) {
+            // the source already ran this block (it's ordered before us)
+            int numForwarded;
+            auto forwarded = CVST_GetOutputEvents(graph->nodes[node.midiSource].plugin, &numForwarded);
+            if (numForwarded > 0) {
+                CVST_SetBlockEvents(node.plugin, (CVST_MidiEvent *)forwarded, numForwarded);
+            }
+        }
+        CVST_ProcessReplacing(node.plugin, step.inputPtrs.data(), step.outputPtrs.data(), sampleFrames);
+    }
+
+    // (every graph input read before any output is written)
+    for (auto &binding : graph->graphOutputs) {
+        if (binding.mixBuffer >= 0) {
+            graph->sumInto(graph->bufferAt(binding.mixBuffer), binding, inputs, sampleFrames);
+        }
+    }
+    for (int ch = 0; ch < graph->numOutputs; ch++) {
+        auto &binding = graph->graphOutputs[ch];
+        auto dest = outputs[ch];
+        if (binding.sources.empty()) {
+            memset(dest, 0, sampleFrames * sizeof(float));
+        }
+        else if (binding.mixBuffer >= 0) {
+            memcpy(dest, graph->bufferAt(binding.mixBuffer), sampleFrames * sizeof(float));
+        }
+        else {
+            graph->sumInto(dest, binding, inputs, sampleFrames);
+        }
+    }
+}
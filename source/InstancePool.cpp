@@ -0,0 +1,209 @@
+// InstancePool.cpp : pre-warmed plugin instances (CVST_InstancePool*)
+//
+// a worker thread keeps 'size' instances of one plugin loaded, started and resumed, so that acquiring one is a pop off
+// a list. released instances go back to the worker, which resets them (any state load settled, suspend, the host
+// settings and the state they were loaded with, the host-side state, resume) and re-lists them -- or destroys them, if
+// there are enough already or they died. what to reset to is taken from the first instance, right after starting it:
+// its bank chunk if it has chunks, its parameter values otherwise, and its event capacity (the rest of the host
+// settings are the same for every new instance).
+
+#include "CVSTHost.h"
+#include "../deps/VST2_SDK/pluginterfaces/vst2.x/aeffectx.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct _CVST_InstancePool {
+    std::string path;
+    int size;
+    float sampleRate;
+    int blockSize;
+    bool bridged;
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::vector<CVST_Plugin> ready; // (LIFO: the most recently reset instance is the warmest)
+    std::vector<CVST_Plugin> returned; // waiting for a reset
+    bool quitting = false;
+    bool loadFailed = false; // stop trying -- acquiring falls back to loading on the caller's thread
+    std::thread worker;
+
+    // the state instances are reset to (set once, by the worker, before the first instance is listed)
+    bool haveChunk = false;
+    std::vector<char> defaultChunk;
+    std::vector<float> defaultParameters;
+    int defaultInputEvents = 0, defaultOutputEvents = 0;
+
+    CVST_Plugin load() {
+        auto plugin = bridged ? CVST_LoadPluginBridged(path.c_str(), nullptr) : CVST_LoadPlugin(path.c_str(), nullptr);
+        if (!plugin) {
+            return nullptr;
+        }
+        CVST_Start(plugin, sampleRate);
+        CVST_SetBlockSize(plugin, blockSize);
+        CVST_Resume(plugin);
+        return plugin;
+    }
+
+    void captureDefaults(CVST_Plugin plugin) {
+        CVST_PluginInfo info;
+        CVST_GetPluginInfo(plugin, &info);
+        if (info.flags & effFlagsProgramChunks) {
+            void *data = nullptr;
+            size_t length = 0;
+            CVST_GetChunk(plugin, ChunkType_Bank, &data, &length);
+            if (data && length > 0) {
+                defaultChunk.assign((const char *)data, (const char *)data + length);
+                haveChunk = true;
+            }
+        }
+        defaultParameters.resize(CVST_GetNumParameters(plugin));
+        CVST_GetParameters(plugin, 0, defaultParameters.data(), (int)defaultParameters.size());
+        CVST_GetEventCapacity(plugin, &defaultInputEvents, &defaultOutputEvents);
+    }
+
+    // back to how it was handed out first; false if it can't be reused
+    bool reset(CVST_Plugin plugin) {
+        if (!CVST_IsAlive(plugin)) {
+            return false;
+        }
+        CVST_ResetHostState(plugin); // (first: it settles a state load still in flight, so that what follows reaches the instance that stays)
+        CVST_Suspend(plugin);
+        // the host settings of a new instance (block mode before oversampling, which sizes its buffers for it)
+        CVST_SetBlockMode(plugin, BlockMode_Passthrough, 0);
+        CVST_SetOversampling(plugin, 1);
+        CVST_SetSleepMode(plugin, false, 0, 0.0f);
+        CVST_SetProcessPrecision(plugin, ProcessPrecision_32);
+        CVST_SetEventCapacity(plugin, defaultInputEvents, defaultOutputEvents);
+        CVST_SetStatsBudget(plugin, 1.0);
+        if (haveChunk) {
+            CVST_SetChunk(plugin, ChunkType_Bank, defaultChunk.data(), defaultChunk.size());
+        }
+        else {
+            CVST_SetParameters(plugin, 0, defaultParameters.data(), (int)defaultParameters.size());
+        }
+        CVST_SetUserData(plugin, nullptr);
+        CVST_ResetHostState(plugin); // (again: the changes the state made aren't news to the next user)
+        CVST_SetBlockSize(plugin, blockSize);
+        CVST_Resume(plugin);
+        return true;
+    }
+
+    void run() {
+        bool first = true;
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            wake.wait(lock, [this]() {
+                return quitting || !returned.empty() || (!loadFailed && (int)ready.size() < size);
+            });
+            if (quitting) {
+                break;
+            }
+            if (!returned.empty()) {
+                auto plugin = returned.back();
+                returned.pop_back();
+                lock.unlock();
+                auto reusable = reset(plugin);
+                lock.lock();
+                if (reusable && (int)ready.size() < size) {
+                    ready.push_back(plugin);
+                }
+                else {
+                    lock.unlock();
+                    CVST_Destroy(plugin);
+                    lock.lock();
+                }
+                continue;
+            }
+            lock.unlock();
+            auto plugin = load();
+            if (plugin && first) {
+                captureDefaults(plugin);
+                first = false;
+            }
+            lock.lock();
+            if (plugin) {
+                ready.push_back(plugin);
+            }
+            else {
+                loadFailed = true;
+            }
+        }
+    }
+};
+
+CVSTHOST_API CVST_InstancePool CDECL CVST_InstancePoolCreate(const char *pathToPlugin, bool bridged, int size, float sampleRate, int blockSize)
+{
+    auto pool = new _CVST_InstancePool;
+    pool->path = pathToPlugin;
+    pool->bridged = bridged;
+    pool->size = std::max(size, 0);
+    pool->sampleRate = sampleRate;
+    pool->blockSize = blockSize;
+    pool->worker = std::thread([pool]() { pool->run(); });
+    return pool;
+}
+
+CVSTHOST_API void CDECL CVST_InstancePoolDestroy(CVST_InstancePool pool)
+{
+    {
+        std::lock_guard<std::mutex> lock(pool->mutex);
+        pool->quitting = true;
+    }
+    pool->wake.notify_one();
+    pool->worker.join();
+    for (auto plugin : pool->ready) {
+        CVST_Destroy(plugin);
+    }
+    for (auto plugin : pool->returned) {
+        CVST_Destroy(plugin);
+    }
+    delete pool;
+}
+
+CVSTHOST_API CVST_Plugin CDECL CVST_InstancePoolAcquire(CVST_InstancePool pool, void *userData,
+    enum CVST_ChunkType chunkType, const void *chunk, size_t chunkSize)
+{
+    CVST_Plugin plugin = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(pool->mutex);
+        if (!pool->ready.empty()) {
+            plugin = pool->ready.back();
+            pool->ready.pop_back();
+        }
+    }
+    if (plugin) {
+        pool->wake.notify_one(); // (to replace it)
+    }
+    else {
+        // none ready (yet): the slow way, on this thread
+        plugin = pool->load();
+        if (!plugin) {
+            return nullptr;
+        }
+    }
+    CVST_SetUserData(plugin, userData);
+    if (chunk && chunkSize > 0) {
+        CVST_SetChunk(plugin, chunkType, (void *)chunk, chunkSize);
+    }
+    return plugin;
+}
+
+CVSTHOST_API void CDECL CVST_InstancePoolRelease(CVST_InstancePool pool, CVST_Plugin plugin)
+{
+    {
+        std::lock_guard<std::mutex> lock(pool->mutex);
+        pool->returned.push_back(plugin);
+    }
+    pool->wake.notify_one();
+}
+
+CVSTHOST_API int CDECL CVST_InstancePoolGetReadyCount(CVST_InstancePool pool)
+{
+    std::lock_guard<std::mutex> lock(pool->mutex);
+    return (int)pool->ready.size();
+}
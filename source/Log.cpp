@@ -0,0 +1,155 @@
+// Log.cpp : the deferred log ring and its drain (see Log.h)
+//
+// the ring is a bounded multi-producer queue with a sequence number per slot (after Vyukov):
+// producers claim a slot with one CAS on the tail and publish it by bumping the slot's sequence,
+// the consumer (whoever holds drainMutex) takes slots in order as they become published.
+
+#include "Log.h"
+
+#include <chrono>
+#include <mutex>
+
+#define LOG_RING_SIZE 1024 // entries, power of two
+#define LOG_FORMAT_BUFFER_LEN LOG_STRING_STORAGE
+#define NUM_RATE_KEYS 128 // per opcode namespace -- opcodes beyond this share keys
+#define RATE_LIMIT_PER_SECOND 10
+
+namespace {
+    LogEntry ring[LOG_RING_SIZE];
+    std::atomic<uint32_t> tail{ 0 };
+    uint32_t head = 0; // consumer only
+    std::mutex drainMutex;
+    std::atomic<int> dropped{ 0 };
+
+    std::atomic<int> minLevel{ CVST_LogLevel_Info };
+    std::atomic<CVST_EventCallback> clientCallback{ nullptr };
+
+    struct RateLimit {
+        std::atomic<int64_t> windowStart{ 0 };
+        std::atomic<int> count{ 0 };
+        std::atomic<int> suppressed{ 0 };
+        std::atomic<int> lastOpcode{ 0 }; // (the one suppressed last, for the summary)
+    };
+    RateLimit rateLimits[kNumLogOpcodeSpaces][NUM_RATE_KEYS];
+    const char *opcodeSpaceNames[kNumLogOpcodeSpaces] = { "audioMaster", "eff" };
+
+    struct RingInit {
+        RingInit() {
+            for (uint32_t i = 0; i < LOG_RING_SIZE; i++) {
+                ring[i].sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+    } ringInit;
+
+    void deliver(CVST_LogLevel level, const char *message) {
+        auto callback = clientCallback.load(std::memory_order_acquire);
+        if (callback) {
+            CVST_HostEvent hostEvent;
+            hostEvent.eventType = CVST_EventType_Log;
+            hostEvent.handled = false;
+            hostEvent.logEvent.message = message;
+            hostEvent.logEvent.level = level;
+            callback(&hostEvent, nullptr, nullptr);
+        }
+    }
+}
+
+bool logAllowed(CVST_LogLevel level)
+{
+    return level >= minLevel.load(std::memory_order_relaxed);
+}
+
+bool logRateAllowed(LogOpcodeSpace space, int opcode)
+{
+    auto &limit = rateLimits[space][(unsigned int)opcode % NUM_RATE_KEYS];
+    auto now = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    auto windowStart = limit.windowStart.load(std::memory_order_relaxed);
+    if (now - windowStart >= 1000000000LL && limit.windowStart.compare_exchange_strong(windowStart, now, std::memory_order_relaxed)) {
+        limit.count.store(0, std::memory_order_relaxed);
+    }
+    if (limit.count.fetch_add(1, std::memory_order_relaxed) < RATE_LIMIT_PER_SECOND) {
+        return true;
+    }
+    limit.lastOpcode.store(opcode, std::memory_order_relaxed);
+    limit.suppressed.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+LogEntry *logBegin()
+{
+    auto pos = tail.load(std::memory_order_relaxed);
+    while (true) {
+        auto &entry = ring[pos % LOG_RING_SIZE];
+        auto sequence = entry.sequence.load(std::memory_order_acquire);
+        auto diff = (int32_t)(sequence - pos);
+        if (diff == 0) {
+            if (tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                return &entry;
+            }
+        }
+        else if (diff < 0) {
+            dropped.fetch_add(1, std::memory_order_relaxed); // full
+            return nullptr;
+        }
+        else {
+            pos = tail.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+void logCommit(LogEntry *entry)
+{
+    auto pos = entry->sequence.load(std::memory_order_relaxed);
+    entry->sequence.store(pos + 1, std::memory_order_release);
+}
+
+void logSetClientCallback(CVST_EventCallback callback)
+{
+    clientCallback.store(callback, std::memory_order_release);
+}
+
+void drainLog()
+{
+    std::unique_lock<std::mutex> lock(drainMutex, std::try_to_lock);
+    if (!lock.owns_lock()) {
+        return; // somebody else is already draining
+    }
+    char buffer[LOG_FORMAT_BUFFER_LEN];
+    while (true) {
+        auto &entry = ring[head % LOG_RING_SIZE];
+        if (entry.sequence.load(std::memory_order_acquire) != head + 1) {
+            break;
+        }
+        entry.formatter(buffer, sizeof(buffer), entry);
+        auto level = entry.level;
+        entry.sequence.store(head + LOG_RING_SIZE, std::memory_order_release); // slot free as soon as it's formatted
+        head++;
+        deliver(level, buffer);
+    }
+
+    for (int space = 0; space < kNumLogOpcodeSpaces; space++) {
+        for (auto &limit : rateLimits[space]) {
+            auto suppressed = limit.suppressed.exchange(0, std::memory_order_relaxed);
+            if (suppressed > 0) {
+                snprintf(buffer, sizeof(buffer), "(%d more messages for %s opcode %d suppressed)", suppressed,
+                    opcodeSpaceNames[space], limit.lastOpcode.load(std::memory_order_relaxed));
+                deliver(CVST_LogLevel_Info, buffer);
+            }
+        }
+    }
+    auto lost = dropped.exchange(0, std::memory_order_relaxed);
+    if (lost > 0) {
+        snprintf(buffer, sizeof(buffer), "(%d log messages dropped, log ring full -- drain more often)", lost);
+        deliver(CVST_LogLevel_Warning, buffer);
+    }
+}
+
+CVSTHOST_API void CDECL CVST_SetLogLevel(CVST_LogLevel level)
+{
+    minLevel.store(level, std::memory_order_relaxed);
+}
+
+CVSTHOST_API void CDECL CVST_DrainLog()
+{
+    drainLog();
+}
@@ -0,0 +1,157 @@
+#ifndef __CVSTHOST_LOG_H__
+#define __CVSTHOST_LOG_H__
+
+// (internal) real-time safe, deferred logging
+//
+// logging never formats or calls out to the client on the calling thread -- it only copies the format
+// pointer and the raw arguments into a preallocated lock-free multi-producer ring. CVST_DrainLog (and
+// CVST_Idle) later format the entries and hand them to the client callback.
+//
+// format strings and logMessage messages must be literals (only the pointer is kept);
+// string arguments are copied, truncated if need be.
+// logOpcode additionally rate-limits per VST opcode, since some plugins call the same opcode from every block
+// (audioMaster* and eff* numbers overlap, so each opcode goes with the namespace it's from).
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <stddef.h>
+#include <algorithm>
+#include <atomic>
+#include <utility>
+
+#include "CVSTHost.h"
+
+#define LOG_MAX_ARGS 6
+// shared by all string arguments of one entry: as much as a formatted message can hold (LOG_FORMAT_BUFFER_LEN in
+// Log.cpp), so a long path plus an error message still comes out whole (the ring is ~1MB for it)
+#define LOG_STRING_STORAGE 1024
+
+struct LogEntry;
+typedef void(*LogFormatter)(char *dest, size_t destLen, const LogEntry &entry);
+
+struct LogEntry {
+    std::atomic<uint32_t> sequence;
+    CVST_LogLevel level;
+    const char *format;
+    LogFormatter formatter;
+    uint64_t cells[LOG_MAX_ARGS];
+    char strings[LOG_STRING_STORAGE];
+};
+
+// how each argument type travels through a LogEntry
+template <typename T>
+struct LogArg {
+    static_assert(sizeof(T) <= sizeof(uint64_t), "log arguments must fit in 8 bytes");
+    static void store(LogEntry &entry, int cell, T value, size_t &) {
+        memcpy(&entry.cells[cell], &value, sizeof(T));
+    }
+    static T load(const LogEntry &entry, int cell) {
+        T value;
+        memcpy(&value, &entry.cells[cell], sizeof(T));
+        return value;
+    }
+};
+
+template <>
+struct LogArg<const char *> {
+    static void store(LogEntry &entry, int cell, const char *value, size_t &stringPos) {
+        if (!value) {
+            value = "(null)";
+        }
+        // stringPos never passes the last byte, which is only ever a terminator -- so overflowing strings come out empty/truncated
+        auto length = std::min(strlen(value), LOG_STRING_STORAGE - 1 - stringPos);
+        memcpy(&entry.strings[stringPos], value, length);
+        entry.strings[stringPos + length] = 0;
+        entry.cells[cell] = stringPos;
+        stringPos = std::min(stringPos + length + 1, (size_t)LOG_STRING_STORAGE - 1);
+    }
+    static const char *load(const LogEntry &entry, int cell) {
+        return &entry.strings[entry.cells[cell]];
+    }
+};
+
+template <>
+struct LogArg<char *> : LogArg<const char *> {};
+
+enum LogOpcodeSpace {
+    kLogAudioMaster, // host callback opcodes (plugin -> host)
+    kLogEffect,      // dispatcher opcodes (host -> plugin)
+    kNumLogOpcodeSpaces
+};
+
+// entry points, implemented in Log.cpp
+bool logAllowed(CVST_LogLevel level);
+bool logRateAllowed(LogOpcodeSpace space, int opcode);
+LogEntry *logBegin(); // claims a ring slot, NULL if the ring is full (the message is dropped, and counted)
+void logCommit(LogEntry *entry);
+
+void logSetClientCallback(CVST_EventCallback callback);
+void drainLog();
+
+template <typename... Args, size_t... I>
+void logFormatEntry(char *dest, size_t destLen, const LogEntry &entry, std::index_sequence<I...>) {
+    snprintf(dest, destLen, entry.format, LogArg<Args>::load(entry, (int)I)...);
+}
+
+template <typename... Args>
+void logFormatEntry(char *dest, size_t destLen, const LogEntry &entry) {
+    logFormatEntry<Args...>(dest, destLen, entry, std::index_sequence_for<Args...>());
+}
+
+// messages without arguments are copied verbatim (they may contain '%')
+inline void logCopyEntry(char *dest, size_t destLen, const LogEntry &entry) {
+    snprintf(dest, destLen, "%s", entry.format);
+}
+
+template <typename... Args>
+inline LogFormatter logFormatterFor() {
+    return logFormatEntry<Args...>;
+}
+
+template <>
+inline LogFormatter logFormatterFor<>() {
+    return logCopyEntry;
+}
+
+template <typename... Args>
+void logEnqueue(CVST_LogLevel level, const char *format, Args... args) {
+    static_assert(sizeof...(Args) <= LOG_MAX_ARGS, "too many log arguments");
+    auto entry = logBegin();
+    if (!entry) {
+        return;
+    }
+    entry->level = level;
+    entry->format = format;
+    entry->formatter = logFormatterFor<Args...>();
+    size_t stringPos = 0;
+    int cell = 0;
+    (void)stringPos;
+    (void)cell;
+    int expand[] = { 0, (LogArg<Args>::store(*entry, cell++, args, stringPos), 0)... };
+    (void)expand;
+    logCommit(entry);
+}
+
+template <typename... Args>
+inline void logFormat(CVST_LogLevel level, const char *format, Args... args) {
+    if (logAllowed(level)) {
+        logEnqueue(level, format, args...);
+    }
+}
+
+inline void logMessage(CVST_LogLevel level, const char *message) {
+    if (logAllowed(level)) {
+        logEnqueue(level, message);
+    }
+}
+
+// for messages triggered by plugin opcodes: also rate-limited per opcode
+template <typename... Args>
+inline void logOpcode(CVST_LogLevel level, LogOpcodeSpace space, int opcode, const char *format, Args... args) {
+    if (logAllowed(level) && logRateAllowed(space, opcode)) {
+        logEnqueue(level, format, args...);
+    }
+}
+
+#endif // __CVSTHOST_LOG_H__
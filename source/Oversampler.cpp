@@ -0,0 +1,302 @@
+// Oversampler.cpp : half-band oversampling cascade (see Oversampler.h), and its FIR kernels (AVX2 / SSE2 where
+// available, scalar otherwise)
+//
+// the filters are Kaiser-windowed sincs, designed once per init: the first stage long enough to keep ~90% of the host
+// band flat at 2x (transition centered on the host's Nyquist), the later ones just long enough for their much wider
+// transition bands. all stopbands are ~100dB down
+
+#include "Oversampler.h"
+#include "SampleFormat.h"
+
+#include <math.h>
+#include <string.h>
+
+#define KAISER_BETA 10.0 // ~100dB stopband
+#define PI 3.14159265358979323846
+static const int stageCoeffs[OVERSAMPLING_MAX_STAGES] = { 24, 8, 6 }; // 95, 31 and 23 taps
+
+namespace {
+    typedef void(*HalfBand32)(const float *in, float *out, size_t count, const float *coeffs, int numCoeffs);
+    typedef void(*HalfBand64)(const double *in, double *out, size_t count, const double *coeffs, int numCoeffs);
+
+    // === scalar (also the tail of every vector loop) ===
+
+    template <typename T>
+    void halfBandScalar(const T *in, T *out, size_t i, size_t count, const T *coeffs, int numCoeffs) {
+        for (; i < count; i++) {
+            auto lo = in + i + numCoeffs - 1, hi = in + i + numCoeffs;
+            T acc = 0;
+            for (int j = 0; j < numCoeffs; j++) {
+                acc += coeffs[j] * (*(lo - j) + hi[j]);
+            }
+            out[i] = acc;
+        }
+    }
+
+    void halfBand32Plain(const float *in, float *out, size_t count, const float *coeffs, int numCoeffs) {
+        halfBandScalar(in, out, 0, count, coeffs, numCoeffs);
+    }
+    void halfBand64Plain(const double *in, double *out, size_t count, const double *coeffs, int numCoeffs) {
+        halfBandScalar(in, out, 0, count, coeffs, numCoeffs);
+    }
+
+#ifdef CVST_HAVE_SSE2
+    // === SSE2 ===
+
+    void halfBand32SSE2(const float *in, float *out, size_t count, const float *coeffs, int numCoeffs) {
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            auto lo = in + i + numCoeffs - 1, hi = in + i + numCoeffs;
+            auto acc = _mm_setzero_ps();
+            for (int j = 0; j < numCoeffs; j++) {
+                auto pair = _mm_add_ps(_mm_loadu_ps(lo - j), _mm_loadu_ps(hi + j));
+                acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(coeffs[j]), pair));
+            }
+            _mm_storeu_ps(out + i, acc);
+        }
+        halfBandScalar(in, out, i, count, coeffs, numCoeffs);
+    }
+    void halfBand64SSE2(const double *in, double *out, size_t count, const double *coeffs, int numCoeffs) {
+        size_t i = 0;
+        for (; i + 2 <= count; i += 2) {
+            auto lo = in + i + numCoeffs - 1, hi = in + i + numCoeffs;
+            auto acc = _mm_setzero_pd();
+            for (int j = 0; j < numCoeffs; j++) {
+                auto pair = _mm_add_pd(_mm_loadu_pd(lo - j), _mm_loadu_pd(hi + j));
+                acc = _mm_add_pd(acc, _mm_mul_pd(_mm_set1_pd(coeffs[j]), pair));
+            }
+            _mm_storeu_pd(out + i, acc);
+        }
+        halfBandScalar(in, out, i, count, coeffs, numCoeffs);
+    }
+#endif
+
+#ifdef CVST_HAVE_AVX2
+    // === AVX2 ===
+
+    TARGET_AVX2 void halfBand32AVX2(const float *in, float *out, size_t count, const float *coeffs, int numCoeffs) {
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            auto lo = in + i + numCoeffs - 1, hi = in + i + numCoeffs;
+            auto acc = _mm256_setzero_ps();
+            for (int j = 0; j < numCoeffs; j++) {
+                auto pair = _mm256_add_ps(_mm256_loadu_ps(lo - j), _mm256_loadu_ps(hi + j));
+                acc = _mm256_add_ps(acc, _mm256_mul_ps(_mm256_set1_ps(coeffs[j]), pair));
+            }
+            _mm256_storeu_ps(out + i, acc);
+        }
+        halfBandScalar(in, out, i, count, coeffs, numCoeffs);
+    }
+    TARGET_AVX2 void halfBand64AVX2(const double *in, double *out, size_t count, const double *coeffs, int numCoeffs) {
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            auto lo = in + i + numCoeffs - 1, hi = in + i + numCoeffs;
+            auto acc = _mm256_setzero_pd();
+            for (int j = 0; j < numCoeffs; j++) {
+                auto pair = _mm256_add_pd(_mm256_loadu_pd(lo - j), _mm256_loadu_pd(hi + j));
+                acc = _mm256_add_pd(acc, _mm256_mul_pd(_mm256_set1_pd(coeffs[j]), pair));
+            }
+            _mm256_storeu_pd(out + i, acc);
+        }
+        halfBandScalar(in, out, i, count, coeffs, numCoeffs);
+    }
+#endif
+
+    struct KernelTable {
+        HalfBand32 halfBand32 = halfBand32Plain;
+        HalfBand64 halfBand64 = halfBand64Plain;
+
+        KernelTable() {
+#ifdef CVST_HAVE_SSE2
+            halfBand32 = halfBand32SSE2;
+            halfBand64 = halfBand64SSE2;
+#endif
+#ifdef CVST_HAVE_AVX2
+            if (cpuHasAVX2()) {
+                halfBand32 = halfBand32AVX2;
+                halfBand64 = halfBand64AVX2;
+            }
+#endif
+        }
+    };
+
+    const KernelTable &kernels() {
+        static KernelTable table; // thread-safe init, and nothing to do after that
+        return table;
+    }
+
+    // zeroth-order modified Bessel function of the first kind (power series, converges quickly for the betas used)
+    double besselI0(double x) {
+        double sum = 1.0, term = 1.0;
+        for (int k = 1; k < 50 && term > sum * 1e-12; k++) {
+            term *= (x * x) / (4.0 * k * k);
+            sum += term;
+        }
+        return sum;
+    }
+}
+
+void halfBandKernel(const float *in, float *out, size_t count, const float *coeffs, int numCoeffs)
+{
+    kernels().halfBand32(in, out, count, coeffs, numCoeffs);
+}
+
+void halfBandKernel(const double *in, double *out, size_t count, const double *coeffs, int numCoeffs)
+{
+    kernels().halfBand64(in, out, count, coeffs, numCoeffs);
+}
+
+void Oversampler::init(int factor, int numInputs, int numOutputs, int capacity)
+{
+    numStages = 0;
+    while (numStages < OVERSAMPLING_MAX_STAGES && (2 << numStages) <= factor) {
+        numStages++;
+    }
+    this->factor = 1 << numStages;
+    this->numInputs = numInputs;
+    this->numOutputs = numOutputs;
+    this->capacity = capacity;
+    delay = 0;
+    if (numStages == 0) {
+        this->capacity = 0;
+        std::vector<double>().swap(storage);
+        return;
+    }
+
+    // odd taps a[j] at +-(2j + 1) from the center, normalized so the passband gain is 1 (0.5 center + 2 * sum(a) = 1)
+    int topDelay = 0; // top-rate frames, up and down
+    for (int s = 0; s < numStages; s++) {
+        auto &stage = stages[s];
+        stage.numCoeffs = stageCoeffs[s];
+        stage.history = 2 * stage.numCoeffs - 1;
+        stage.coeffs64.resize(stage.numCoeffs);
+        stage.coeffs32.resize(stage.numCoeffs);
+        double sum = 0.0;
+        for (int j = 0; j < stage.numCoeffs; j++) {
+            auto d = 2 * j + 1;
+            auto x = PI * d / 2.0;
+            auto edge = (double)d / stage.history;
+            auto window = besselI0(KAISER_BETA * sqrt(1.0 - edge * edge)) / besselI0(KAISER_BETA);
+            stage.coeffs64[j] = 0.5 * sin(x) / x * window;
+            sum += stage.coeffs64[j];
+        }
+        for (int j = 0; j < stage.numCoeffs; j++) {
+            stage.coeffs64[j] *= 0.25 / sum;
+            stage.coeffs32[j] = (float)stage.coeffs64[j];
+        }
+        topDelay += stage.history * (this->factor >> s);
+    }
+    pad = (this->factor - topDelay % this->factor) % this->factor;
+    delay = (topDelay + pad) / this->factor;
+    if (capacity <= 0) {
+        this->capacity = 0; // (buffers come with a block size)
+        std::vector<double>().swap(storage);
+        return;
+    }
+
+    size_t size = 0;
+    upOffsets.resize((size_t)numInputs * numStages);
+    for (int i = 0; i < numInputs; i++) {
+        for (int s = 0; s < numStages; s++) {
+            upOffsets[(size_t)i * numStages + s] = size;
+            size += stages[s].history + ((size_t)capacity << s);
+        }
+    }
+    downOffsets.resize((size_t)numOutputs * numStages);
+    for (int i = 0; i < numOutputs; i++) {
+        for (int s = 0; s < numStages; s++) {
+            downOffsets[(size_t)i * numStages + s] = size;
+            size += 2 * (stages[s].history + ((size_t)capacity << s));
+        }
+    }
+    topOffsets.resize(numInputs + numOutputs);
+    for (int i = 0; i < numInputs + numOutputs; i++) {
+        topOffsets[i] = size;
+        size += (i < numInputs ? 0 : pad) + (size_t)capacity * this->factor;
+    }
+    scratchOffset = size;
+    size += (size_t)capacity * this->factor / 2;
+    storage.assign(size, 0.0);
+
+    floatPtrs.resize(numInputs + numOutputs);
+    doublePtrs.resize(numInputs + numOutputs);
+    for (int i = 0; i < numInputs + numOutputs; i++) {
+        auto offset = topOffsets[i] + (i < numInputs ? 0 : pad);
+        floatPtrs[i] = buffer<float>(offset);
+        doublePtrs[i] = buffer<double>(offset);
+    }
+}
+
+void Oversampler::reset()
+{
+    std::fill(storage.begin(), storage.end(), 0.0);
+}
+
+void Oversampler::copyState(const Oversampler &other)
+{
+    if (other.factor == factor && other.capacity == capacity && other.numInputs == numInputs && other.numOutputs == numOutputs) {
+        std::copy(other.storage.begin(), other.storage.end(), storage.begin());
+    }
+    else {
+        reset();
+    }
+}
+
+template <typename T>
+void Oversampler::upsample(int input, const T *source, unsigned int frames)
+{
+    auto scratch = buffer<T>(scratchOffset);
+    size_t n = frames;
+    for (int s = 0; s < numStages; s++, n *= 2) {
+        auto &stage = stages[s];
+        auto buf = buffer<T>(upOffsets[(size_t)input * numStages + s]);
+        if (s == 0) {
+            memcpy(buf + stage.history, source, n * sizeof(T));
+        }
+        auto dest = s + 1 < numStages ? buffer<T>(upOffsets[(size_t)input * numStages + s + 1]) + stages[s + 1].history
+            : buffer<T>(topOffsets[input]);
+        // filtered phase (x2 for the zero-stuffing), then the delayed input as the other
+        halfBandKernel(buf, scratch, n, coeffs(stage, buf), stage.numCoeffs);
+        auto delayed = buf + stage.numCoeffs;
+        for (size_t q = 0; q < n; q++) {
+            dest[2 * q] = scratch[q] * (T)2;
+            dest[2 * q + 1] = delayed[q];
+        }
+        memmove(buf, buf + n, stage.history * sizeof(T));
+    }
+}
+
+template <typename T>
+void Oversampler::downsample(int output, T *dest, unsigned int frames)
+{
+    auto scratch = buffer<T>(scratchOffset);
+    auto top = buffer<T>(topOffsets[numInputs + output]);
+    const T *source = top;
+    for (int s = numStages - 1; s >= 0; s--) {
+        auto &stage = stages[s];
+        auto n = (size_t)frames << s;
+        auto even = buffer<T>(downOffsets[(size_t)output * numStages + s]);
+        auto odd = even + stage.history + ((size_t)capacity << s);
+        for (size_t k = 0; k < n; k++) {
+            even[stage.history + k] = source[2 * k];
+            odd[stage.history + k] = source[2 * k + 1];
+        }
+        // filtered even phase, plus the center tap on the odd one
+        auto out = s == 0 ? dest : scratch;
+        halfBandKernel(even, out, n, coeffs(stage, even), stage.numCoeffs);
+        auto delayed = odd + stage.numCoeffs - 1;
+        for (size_t k = 0; k < n; k++) {
+            out[k] += delayed[k] * (T)0.5;
+        }
+        memmove(even, even + n, stage.history * sizeof(T));
+        memmove(odd, odd + n, stage.history * sizeof(T));
+        source = scratch;
+    }
+    auto topFrames = (size_t)frames * factor;
+    memmove(top, top + topFrames, pad * sizeof(T));
+}
+
+template void Oversampler::upsample<float>(int, const float *, unsigned int);
+template void Oversampler::upsample<double>(int, const double *, unsigned int);
+template void Oversampler::downsample<float>(int, float *, unsigned int);
+template void Oversampler::downsample<double>(int, double *, unsigned int);
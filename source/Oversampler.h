@@ -0,0 +1,92 @@
+#ifndef __CVSTHOST_OVERSAMPLER_H__
+#define __CVSTHOST_OVERSAMPLER_H__
+
+// (internal) per-plugin oversampling, see CVST_SetOversampling
+//
+// the plugin runs at 'factor' times the host rate: its inputs are upsampled, and its outputs downsampled, by a cascade
+// of 2x half-band FIR stages. a half-band's even taps are zero (bar the center one, 0.5), so each stage is polyphase:
+// one phase is a plain delay, the other a symmetric kernel over half the taps, run at the lower of the two rates.
+// the first stage (host rate <-> 2x) carries the steep filter; later ones only have to keep images out of the audible
+// band, so they're short. everything is linear phase -- the total delay is padded to a whole number of host frames
+// (at the top rate, in front of the downsamplers), see latency()
+// buffers hold 'history' frames of the previous pass in front of the current one, so each kernel reads contiguously.
+
+#include <stddef.h>
+#include <algorithm>
+#include <vector>
+
+#define OVERSAMPLING_MAX_STAGES 3 // 8x
+
+// out[i] = sum_j coeffs[j] * (in[i + numCoeffs - 1 - j] + in[i + numCoeffs + j]), i < count
+// (vectorized across i: AVX2 / SSE2 where available, picked once on first use)
+void halfBandKernel(const float *in, float *out, size_t count, const float *coeffs, int numCoeffs);
+void halfBandKernel(const double *in, double *out, size_t count, const double *coeffs, int numCoeffs);
+
+class Oversampler {
+    struct Stage {
+        int numCoeffs = 0; // the symmetric half of the odd taps
+        int history = 0; // 2 * numCoeffs - 1 frames, at the stage's lower rate
+        std::vector<float> coeffs32;
+        std::vector<double> coeffs64;
+    };
+    Stage stages[OVERSAMPLING_MAX_STAGES];
+    int numStages = 0;
+    int pad = 0; // top-rate frames
+    int delay = 0; // host frames, padding included
+
+    int capacity = 0; // host frames per pass
+    int numInputs = 0, numOutputs = 0;
+    std::vector<double> storage; // (big enough for either precision)
+    std::vector<size_t> upOffsets; // per input, per stage: [history | frames at the stage's input rate]
+    std::vector<size_t> downOffsets; // per output, per stage: even then odd phase, [history | frames at the stage's output rate]
+    std::vector<size_t> topOffsets; // per channel, inputs then outputs: the plugin's buffers (outputs: [pad | frames])
+    size_t scratchOffset = 0;
+
+    // the plugin-side channel pointers, inputs then outputs
+    std::vector<float *> floatPtrs;
+    std::vector<double *> doublePtrs;
+
+    template <typename T> inline T *buffer(size_t offset) { return (T *)&storage[0] + offset; }
+    inline float **ptrs(float **) { return floatPtrs.data(); }
+    inline double **ptrs(double **) { return doublePtrs.data(); }
+    inline const float *coeffs(const Stage &stage, float *) const { return stage.coeffs32.data(); }
+    inline const double *coeffs(const Stage &stage, double *) const { return stage.coeffs64.data(); }
+
+    template <typename T> void upsample(int input, const T *source, unsigned int frames);
+    template <typename T> void downsample(int output, T *dest, unsigned int frames);
+
+public:
+    int factor = 1; // 1: off
+
+    // non-realtime: sets up the filters for factor (1, 2, 4 or 8) and buffers for 'capacity' host frames per pass
+    void init(int factor, int numInputs, int numOutputs, int capacity);
+    inline int getCapacity() const { return capacity; }
+    inline bool fits(int inputs, int outputs, int frames) const {
+        return inputs <= numInputs && outputs <= numOutputs && frames <= capacity;
+    }
+    // back to silence
+    void reset();
+    // takes over the filter state of another one set up the same way (otherwise: silence), without allocating
+    void copyState(const Oversampler &other);
+    // host frames the output is delayed by (the plugin's own latency not included)
+    inline int latency() const { return delay; }
+
+    // upsamples the inputs, runs process(inputs, outputs, frames) at the top rate, downsamples the outputs
+    // (in passes of at most 'capacity' host frames; the inputs are read before the outputs are written)
+    template <typename T, typename Process>
+    void process(T **inputs, T **outputs, unsigned int sampleFrames, int pluginInputs, int pluginOutputs, Process process) {
+        auto top = ptrs(inputs);
+        for (unsigned int offset = 0; offset < sampleFrames; offset += capacity) {
+            auto frames = std::min((unsigned int)capacity, sampleFrames - offset);
+            for (int i = 0; i < pluginInputs; i++) {
+                upsample(i, inputs[i] + offset, frames);
+            }
+            process(top, top + numInputs, frames * factor);
+            for (int i = 0; i < pluginOutputs; i++) {
+                downsample(i, outputs[i] + offset, frames);
+            }
+        }
+    }
+};
+
+#endif // __CVSTHOST_OVERSAMPLER_H__
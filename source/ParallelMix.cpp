@@ -0,0 +1,166 @@
+// ParallelMix.cpp : delay-compensated parallel mixes (CVST_ParallelMix*)
+//
+// every member gets the same input, and its output goes through a ring-buffer delay line before being summed, delayed
+// by (mix latency - its own latency) so that all of them line up with the slowest. the rings are sized for maxLatency
+// when the member is added, so a latency change (audioMasterIOChanged -- noticed by comparing initialDelay every block)
+// only moves the read positions. a member later than maxLatency can't be waited for: the others line up at maxLatency,
+// it comes out late by the difference (logged), and the mix latency is its own, so that a render trims at least that.
+
+#include "CVSTHost.h"
+#include "Log.h"
+
+#include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+namespace {
+    struct Member {
+        CVST_Plugin plugin;
+        float gain;
+        int latency = 0; // as of the last block (may exceed maxLatency)
+        int delay = 0; // frames its output is held back by
+
+        std::vector<float *> inputPtrs; // plugin's channels: the mix inputs, then silence
+        std::vector<float *> outputPtrs; // plugin's channels: 'output', then a shared discard buffer
+        std::vector<float> output; // numChannels x maxBlockSize
+        std::vector<float> ring; // numChannels x ringSize
+    };
+}
+
+struct _CVST_ParallelMix {
+    int numChannels;
+    int maxBlockSize;
+    int maxLatency;
+    size_t ringSize; // power of two, >= maxLatency + maxBlockSize
+    size_t writePos = 0; // in every ring
+
+    std::vector<std::unique_ptr<Member>> members;
+    std::atomic<int> latency { 0 }; // of the mix as a whole (set on the processing thread, read from anywhere)
+    std::vector<float> silence; // maxBlockSize
+    std::vector<float> discard; // maxBlockSize, for plugin outputs beyond numChannels
+    std::vector<float> mixed; // numChannels x maxBlockSize: the sum, copied out once every member has read the inputs
+
+    _CVST_ParallelMix(int numChannels, int maxBlockSize, int maxLatency)
+        :numChannels(numChannels), maxBlockSize(maxBlockSize), maxLatency(maxLatency)
+    {
+        ringSize = 1;
+        while (ringSize < (size_t)maxLatency + maxBlockSize) {
+            ringSize <<= 1;
+        }
+        silence.assign(maxBlockSize, 0.0f);
+        discard.assign(maxBlockSize, 0.0f);
+        mixed.assign((size_t)numChannels * maxBlockSize, 0.0f);
+    }
+
+    // picks up latency changes: the mix follows the slowest member, the others are delayed to match (up to maxLatency)
+    void updateLatencies() {
+        bool changed = false;
+        for (auto &member : members) {
+            auto current = std::max(0, CVST_GetLatency(member->plugin));
+            if (current == member->latency) {
+                continue;
+            }
+            if (current > maxLatency) {
+                logFormat(CVST_LogLevel_Warning, "parallel mix: a member's latency (%d) is over the mix's maximum (%d), it will be %d frames late",
+                    current, maxLatency, current - maxLatency);
+            }
+            changed = true;
+            member->latency = current;
+        }
+        if (!changed) {
+            return;
+        }
+        int slowest = 0;
+        for (auto &member : members) {
+            slowest = std::max(slowest, member->latency);
+        }
+        auto aligned = std::min(slowest, maxLatency);
+        for (auto &member : members) {
+            member->delay = aligned - std::min(member->latency, maxLatency);
+        }
+        latency.store(slowest, std::memory_order_relaxed);
+    }
+
+    void processChunk(float **inputs, float **outputs, size_t offset, unsigned int frames) {
+        auto mask = ringSize - 1;
+        std::fill(mixed.begin(), mixed.end(), 0.0f);
+        for (auto &memberPtr : members) {
+            auto &member = *memberPtr;
+            for (size_t i = 0; i < member.inputPtrs.size(); i++) {
+                member.inputPtrs[i] = (int)i < numChannels ? inputs[i] + offset : silence.data();
+            }
+            CVST_ProcessReplacing(member.plugin, member.inputPtrs.data(), member.outputPtrs.data(), frames);
+
+            // through the delay line: write the block, read it back 'delay' frames later (both may wrap)
+            auto readPos = (writePos - member.delay) & mask;
+            for (int ch = 0; ch < numChannels; ch++) {
+                auto source = &member.output[(size_t)ch * maxBlockSize];
+                auto ring = &member.ring[(size_t)ch * ringSize];
+                auto dest = &mixed[(size_t)ch * maxBlockSize];
+                auto first = std::min((size_t)frames, ringSize - writePos);
+                memcpy(ring + writePos, source, first * sizeof(float));
+                memcpy(ring, source + first, (frames - first) * sizeof(float));
+                for (unsigned int i = 0; i < frames; i++) {
+                    dest[i] += ring[(readPos + i) & mask] * member.gain;
+                }
+            }
+        }
+        writePos = (writePos + frames) & mask;
+        for (int ch = 0; ch < numChannels; ch++) {
+            memcpy(outputs[ch] + offset, &mixed[(size_t)ch * maxBlockSize], frames * sizeof(float));
+        }
+    }
+};
+
+CVSTHOST_API CVST_ParallelMix CDECL CVST_ParallelMixCreate(int numChannels, int maxBlockSize, int maxLatency)
+{
+    return new _CVST_ParallelMix(std::max(numChannels, 1), std::max(maxBlockSize, 1), std::max(maxLatency, 0));
+}
+
+CVSTHOST_API void CDECL CVST_ParallelMixDestroy(CVST_ParallelMix mix)
+{
+    delete mix;
+}
+
+CVSTHOST_API int CDECL CVST_ParallelMixAdd(CVST_ParallelMix mix, CVST_Plugin plugin, float gain)
+{
+    CVST_Properties props;
+    CVST_GetProperties(plugin, &props);
+
+    std::unique_ptr<Member> member(new Member);
+    member->plugin = plugin;
+    member->gain = gain;
+    member->latency = -1; // (picked up below)
+    member->inputPtrs.resize(props.numInputs);
+    member->output.assign((size_t)mix->numChannels * mix->maxBlockSize, 0.0f);
+    member->ring.assign((size_t)mix->numChannels * mix->ringSize, 0.0f);
+    for (int i = 0; i < props.numOutputs; i++) {
+        member->outputPtrs.push_back(i < mix->numChannels ? &member->output[(size_t)i * mix->maxBlockSize] : mix->discard.data());
+    }
+    mix->members.push_back(std::move(member));
+    mix->updateLatencies();
+    return (int)mix->members.size() - 1;
+}
+
+CVSTHOST_API void CDECL CVST_ParallelMixSetGain(CVST_ParallelMix mix, int member, float gain)
+{
+    if (member >= 0 && member < (int)mix->members.size()) {
+        mix->members[member]->gain = gain;
+    }
+}
+
+CVSTHOST_API int CDECL CVST_ParallelMixGetLatency(CVST_ParallelMix mix)
+{
+    return mix->latency.load(std::memory_order_relaxed);
+}
+
+CVSTHOST_API void CDECL CVST_ParallelMixProcess(CVST_ParallelMix mix, float **inputs, float **outputs, unsigned int sampleFrames)
+{
+    mix->updateLatencies();
+    // (blocks bigger than announced go through in pieces)
+    for (unsigned int offset = 0; offset < sampleFrames; offset += mix->maxBlockSize) {
+        mix->processChunk(inputs, outputs, offset, std::min((unsigned int)mix->maxBlockSize, sampleFrames - offset));
+    }
+}
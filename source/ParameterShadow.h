@@ -0,0 +1,101 @@
+#ifndef __CVSTHOST_PARAMETERSHADOW_H__
+#define __CVSTHOST_PARAMETERSHADOW_H__
+
+// (internal) per-plugin copy of every parameter value, see CVST_GetParameters
+//
+// written wherever a value changes -- audioMasterAutomate (audio and UI threads), the host's own setParameter calls,
+// and a full re-read after state loads -- and read by the client without calling into the plugin.
+// a value that actually changed raises its bit in the dirty words, which CVST_GetChangedParameters collects and clears.
+// names, labels and display strings are only dispatched for when first asked (the display: again when the value
+// changed), and are cached on the non-realtime side.
+
+#include <stdint.h>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+class ParameterShadow {
+    int numParams = 0;
+    std::unique_ptr<std::atomic<float>[]> values;
+    std::unique_ptr<std::atomic<uint64_t>[]> dirty; // a bit per parameter
+    int numDirtyWords = 0;
+
+public:
+    // non-realtime side only
+    struct Text {
+        bool fetched = false;
+        std::string name, label;
+        bool displayValid = false;
+        float displayValue = 0.0f; // what 'display' was made for
+        std::string display;
+    };
+    std::vector<Text> text;
+    std::atomic<bool> textStale{ false }; // audioMasterUpdateDisplay: names etc may have changed
+
+    void init(int numParams) {
+        this->numParams = numParams;
+        numDirtyWords = (numParams + 63) / 64;
+        values.reset(new std::atomic<float>[numParams]);
+        dirty.reset(new std::atomic<uint64_t>[numDirtyWords]);
+        for (int i = 0; i < numParams; i++) {
+            values[i].store(0.0f, std::memory_order_relaxed);
+        }
+        for (int i = 0; i < numDirtyWords; i++) {
+            dirty[i].store(0, std::memory_order_relaxed);
+        }
+        text.assign(numParams, Text());
+    }
+
+    inline int size() const { return numParams; }
+
+    // wait-free, from any thread
+    void set(int index, float value) {
+        if (index < 0 || index >= numParams) {
+            return;
+        }
+        if (values[index].exchange(value, std::memory_order_relaxed) != value) {
+            dirty[index >> 6].fetch_or(1ull << (index & 63), std::memory_order_release);
+        }
+    }
+
+    inline float get(int index) const {
+        return values[index].load(std::memory_order_relaxed);
+    }
+
+    // the changed parameters (ascending), at most maxIndices of them -- the rest stay dirty for the next call
+    int takeChanged(int *indices, int maxIndices) {
+        int count = 0;
+        for (int word = 0; word < numDirtyWords && count < maxIndices; word++) {
+            auto bits = dirty[word].load(std::memory_order_acquire);
+            if (!bits) {
+                continue;
+            }
+            uint64_t taken = 0;
+            for (int bit = 0; bit < 64 && count < maxIndices; bit++) {
+                if (bits & (1ull << bit)) {
+                    taken |= 1ull << bit;
+                    indices[count++] = word * 64 + bit;
+                }
+            }
+            // (a set() racing with this re-raises the bit after the clear, or lands before the client reads the value)
+            dirty[word].fetch_and(~taken, std::memory_order_acq_rel);
+        }
+        return count;
+    }
+
+    void clearChanged() {
+        for (int i = 0; i < numDirtyWords; i++) {
+            dirty[i].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    void invalidateText() {
+        for (auto &entry : text) {
+            entry.fetched = false;
+            entry.displayValid = false;
+        }
+    }
+};
+
+#endif // __CVSTHOST_PARAMETERSHADOW_H__
@@ -0,0 +1,61 @@
+#ifndef __CVSTHOST_PLATFORM_H__
+#define __CVSTHOST_PLATFORM_H__
+
+// the small set of OS services the host needs -- implemented once per backend
+// (source/win32/Platform.cpp, source/posix/Platform.cpp), everything else is shared
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <atomic>
+
+#ifdef _WIN32
+#define strdup _strdup
+#endif
+
+typedef void* PlatformLibrary;
+
+PlatformLibrary platformLoadLibrary(const char *utf8Path); // NULL on failure
+void *platformGetSymbol(PlatformLibrary library, const char *name);
+void platformFreeLibrary(PlatformLibrary library);
+const char *platformLastError(); // description of the last failed library call (thread-local / static storage)
+
+void platformPinCurrentThread(int cpu); // best effort, silently ignored where unsupported
+
+// files (utf8 paths everywhere)
+bool platformFileStat(const char *utf8Path, uint64_t *size, int64_t *modifiedTime); // false if it doesn't exist; time in OS units
+FILE *platformOpenFile(const char *utf8Path, const char *mode);
+bool platformReplaceFile(const char *fromPath, const char *toPath); // rename, atomically replacing toPath if it exists
+
+struct PlatformMappedFile {
+    const void *data = nullptr;
+    size_t size = 0;
+    void *handle = nullptr; // backend specific
+};
+bool platformMapFile(const char *utf8Path, PlatformMappedFile *mapped); // read-only, whole file
+void platformUnmapFile(PlatformMappedFile *mapped);
+
+// shared memory and child processes, for the out-of-process bridge (see Bridge.h)
+struct PlatformSharedMemory {
+    void *data = nullptr;
+    size_t size = 0;
+    void *handle = nullptr; // backend specific
+};
+bool platformCreateSharedMemory(const char *name, size_t size, PlatformSharedMemory *shm); // zero-filled; fails if 'name' exists
+bool platformOpenSharedMemory(const char *name, size_t size, PlatformSharedMemory *shm);
+void platformCloseSharedMemory(PlatformSharedMemory *shm);
+void platformUnlinkSharedMemory(const char *name); // once every process has it open (no-op where it goes away with the last handle)
+
+// blocks while *word == expected, for at most timeoutMs (spurious returns allowed) -- works across processes
+void platformWaitWord(std::atomic<uint32_t> *word, uint32_t expected, int timeoutMs);
+void platformWakeWord(std::atomic<uint32_t> *word);
+
+typedef intptr_t PlatformProcess; // 0: none (a backend object, released by platformEndProcess)
+PlatformProcess platformSpawnProcess(const char *utf8Path, const char *const *args); // args: NULL-terminated, without argv[0]
+PlatformProcess platformOpenProcess(int pid); // (for watching a process we didn't spawn)
+int platformCurrentProcessId();
+bool platformProcessRunning(PlatformProcess process);
+// waits for it to exit, killing it after timeoutMs if it's ours (spawned, and not yet seen exiting); releases the handle
+void platformEndProcess(PlatformProcess process, int timeoutMs);
+
+#endif // __CVSTHOST_PLATFORM_H__
@@ -0,0 +1,558 @@
+// PresetStore.cpp : many chunks in a single memory-mapped file (CVST_PresetStore*)
+//
+// file layout (native endianness and struct layout, like the scan cache):
+//   StoreHeader
+//   StoreEntry[numEntries], in the order they were added
+//   StoreBlob[numBlobs]
+//   entry names, each 0-terminated
+//   blob data, each blob STORE_DATA_ALIGNMENT-aligned (plugins get pointers straight into it)
+// an entry is a name plus a blob index; blobs are unique by content (hash + size + bytes), so the same state saved
+// under several names is stored once. compression is a small LZ77 variant (lz4-like token stream), done on add only --
+// a compressed entry costs one decompression into a reused buffer when fetched, an uncompressed one nothing at all.
+// a file that doesn't check out (magic, version, record sizes, bounds) counts as empty.
+
+#include "CVSTHost.h"
+
+#include <string.h>
+#include <algorithm>
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Platform.h"
+#include "Log.h"
+
+#define STORE_MAGIC 0x53505643 // "CVPS"
+#define STORE_VERSION 1
+#define STORE_DATA_ALIGNMENT 16
+#define COMPRESS_MIN_SAVING 8 // only keep the compressed form if it saves at least 1/8th
+
+#define LZ_MIN_MATCH 4
+#define LZ_MAX_OFFSET 65535
+#define LZ_HASH_BITS 14
+#define LZ_MAX_EXPANSION 256 // raw bytes per stored byte, at most (a length byte stands for up to 255)
+
+namespace {
+    struct StoreHeader {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t entrySize; // record sizes, to catch layout changes
+        uint32_t blobSize;
+        uint32_t numEntries;
+        uint32_t numBlobs;
+        uint64_t stringsOffset;
+        uint64_t dataOffset;
+    };
+
+    struct StoreEntry {
+        uint32_t nameOffset; // from stringsOffset
+        uint32_t nameLength; // without the terminator
+        int32_t pluginID;
+        int32_t chunkType;
+        uint32_t blob;
+        uint32_t reserved;
+    };
+
+    struct StoreBlob {
+        uint64_t offset; // from dataOffset
+        uint64_t storedSize;
+        uint64_t rawSize;
+        uint64_t hash;
+        uint32_t compressed;
+        uint32_t reserved;
+    };
+
+    inline uint64_t alignUp(uint64_t value) {
+        return (value + STORE_DATA_ALIGNMENT - 1) & ~(uint64_t)(STORE_DATA_ALIGNMENT - 1);
+    }
+
+    // FNV-1a
+    uint64_t hashBytes(const void *data, size_t size) {
+        auto bytes = (const uint8_t *)data;
+        uint64_t hash = 14695981039346656037ull;
+        for (size_t i = 0; i < size; i++) {
+            hash = (hash ^ bytes[i]) * 1099511628211ull;
+        }
+        return hash;
+    }
+
+    // --- compression ---
+    // a stream of sequences: token (literal count << 4 | match length - LZ_MIN_MATCH, 15 = more follow as 255-runs),
+    // literals, 16-bit match offset; the last sequence has literals only
+
+    void putLength(std::vector<char> &dest, size_t length) {
+        for (; length >= 255; length -= 255) {
+            dest.push_back((char)255);
+        }
+        dest.push_back((char)length);
+    }
+
+    bool getLength(const uint8_t *src, size_t size, size_t &pos, size_t &length) {
+        uint8_t byte;
+        do {
+            if (pos >= size) {
+                return false;
+            }
+            byte = src[pos++];
+            length += byte;
+        } while (byte == 255);
+        return true;
+    }
+
+    void putSequence(std::vector<char> &dest, const uint8_t *literals, size_t numLiterals, size_t offset, size_t matchLength) {
+        auto extra = matchLength ? matchLength - LZ_MIN_MATCH : 0;
+        dest.push_back((char)((std::min(numLiterals, (size_t)15) << 4) | std::min(extra, (size_t)15)));
+        if (numLiterals >= 15) {
+            putLength(dest, numLiterals - 15);
+        }
+        dest.insert(dest.end(), (const char *)literals, (const char *)literals + numLiterals);
+        if (matchLength) {
+            dest.push_back((char)(offset & 0xff));
+            dest.push_back((char)(offset >> 8));
+            if (extra >= 15) {
+                putLength(dest, extra - 15);
+            }
+        }
+    }
+
+    void compressBytes(const uint8_t *src, size_t size, std::vector<char> &dest) {
+        dest.clear();
+        dest.reserve(size);
+        std::vector<uint32_t> recent(1 << LZ_HASH_BITS, UINT32_MAX); // last position of each hashed 4-byte sequence
+        size_t pos = 0, anchor = 0;
+        while (pos + LZ_MIN_MATCH <= size) {
+            uint32_t sequence, candidateSequence;
+            memcpy(&sequence, src + pos, 4);
+            auto &slot = recent[(sequence * 2654435761u) >> (32 - LZ_HASH_BITS)];
+            auto candidate = slot;
+            slot = (uint32_t)pos;
+            if (candidate != UINT32_MAX && pos - candidate <= LZ_MAX_OFFSET &&
+                (memcpy(&candidateSequence, src + candidate, 4), candidateSequence == sequence))
+            {
+                size_t length = LZ_MIN_MATCH;
+                while (pos + length < size && src[candidate + length] == src[pos + length]) {
+                    length++;
+                }
+                putSequence(dest, src + anchor, pos - anchor, pos - candidate, length);
+                pos += length;
+                anchor = pos;
+            }
+            else {
+                pos++;
+            }
+        }
+        putSequence(dest, src + anchor, size - anchor, 0, 0);
+    }
+
+    bool decompressBytes(const uint8_t *src, size_t size, uint8_t *dest, size_t rawSize) {
+        size_t in = 0, out = 0;
+        while (in < size) {
+            auto token = src[in++];
+            size_t numLiterals = token >> 4;
+            if (numLiterals == 15 && !getLength(src, size, in, numLiterals)) {
+                return false;
+            }
+            if (numLiterals > size - in || numLiterals > rawSize - out) {
+                return false;
+            }
+            memcpy(dest + out, src + in, numLiterals);
+            in += numLiterals;
+            out += numLiterals;
+            if (in == size) {
+                break; // the last sequence
+            }
+            if (size - in < 2) {
+                return false;
+            }
+            size_t offset = src[in] | ((size_t)src[in + 1] << 8);
+            in += 2;
+            size_t length = token & 15;
+            if (length == 15 && !getLength(src, size, in, length)) {
+                return false;
+            }
+            length += LZ_MIN_MATCH;
+            if (offset == 0 || offset > out || length > rawSize - out) {
+                return false;
+            }
+            if (offset >= length) {
+                memcpy(dest + out, dest + out - offset, length);
+            }
+            else {
+                for (size_t i = 0; i < length; i++) { // (overlapping: a repeating pattern)
+                    dest[out + i] = dest[out - offset + i];
+                }
+            }
+            out += length;
+        }
+        return out == rawSize;
+    }
+
+    struct Entry {
+        std::string name;
+        int32_t pluginID;
+        int32_t chunkType;
+        uint32_t blob;
+    };
+
+    struct Blob {
+        uint64_t rawSize;
+        uint64_t storedSize;
+        uint64_t hash;
+        bool compressed;
+        uint64_t fileOffset; // where it is in the mapped file (0: staged)
+        const char *data; // into the mapping, or 'staged'
+        std::vector<char> staged; // added since the last commit
+    };
+}
+
+struct _CVST_PresetStore {
+    std::string path;
+    PlatformMappedFile mapped;
+    std::deque<Entry> entries; // (deques, so that references stay put as entries are added)
+    std::deque<Blob> blobs;
+    std::unordered_multimap<uint64_t, uint32_t> blobsByHash;
+    std::vector<uint8_t> scratch; // decompression target, sized for the largest compressed blob up front
+
+    _CVST_PresetStore(const char *path)
+        :path(path) {}
+
+    ~_CVST_PresetStore() {
+        platformUnmapFile(&mapped);
+    }
+
+    void clear() {
+        entries.clear();
+        blobs.clear();
+        blobsByHash.clear();
+    }
+
+    // (re)reads the mapped file -- anything invalid leaves the store empty
+    bool load() {
+        clear();
+        if (!platformMapFile(path.c_str(), &mapped)) {
+            return false;
+        }
+        auto base = (const char *)mapped.data;
+        auto header = (const StoreHeader *)base;
+        auto size = (uint64_t)mapped.size;
+        if (size < sizeof(StoreHeader) || header->magic != STORE_MAGIC || header->version != STORE_VERSION ||
+            header->entrySize != sizeof(StoreEntry) || header->blobSize != sizeof(StoreBlob) ||
+            sizeof(StoreHeader) + (uint64_t)header->numEntries * sizeof(StoreEntry) + (uint64_t)header->numBlobs * sizeof(StoreBlob) > header->stringsOffset ||
+            header->stringsOffset > header->dataOffset || header->dataOffset > size)
+        {
+            logFormat(CVST_LogLevel_Warning, "preset store [%s] is invalid, starting empty", path.c_str());
+            platformUnmapFile(&mapped);
+            return false;
+        }
+        auto storeEntries = (const StoreEntry *)(base + sizeof(StoreHeader));
+        auto storeBlobs = (const StoreBlob *)(storeEntries + header->numEntries);
+        auto strings = base + header->stringsOffset;
+        auto stringsSize = header->dataOffset - header->stringsOffset;
+        auto dataSize = size - header->dataOffset;
+        for (uint32_t i = 0; i < header->numBlobs; i++) {
+            auto &source = storeBlobs[i];
+            if (source.offset > dataSize || source.storedSize > dataSize - source.offset) {
+                logFormat(CVST_LogLevel_Warning, "preset store [%s] is truncated, starting empty", path.c_str());
+                clear();
+                platformUnmapFile(&mapped);
+                return false;
+            }
+            // (what's handed out is rawSize bytes: stored as is, that's all there is; compressed, it can only be so much more)
+            if (source.compressed ? source.rawSize / LZ_MAX_EXPANSION > source.storedSize : source.rawSize != source.storedSize) {
+                logFormat(CVST_LogLevel_Warning, "preset store [%s] is invalid, starting empty", path.c_str());
+                clear();
+                platformUnmapFile(&mapped);
+                return false;
+            }
+            blobs.emplace_back();
+            auto &blob = blobs.back();
+            blob.rawSize = source.rawSize;
+            blob.storedSize = source.storedSize;
+            blob.hash = source.hash;
+            blob.compressed = source.compressed != 0;
+            blob.fileOffset = header->dataOffset + source.offset;
+            blob.data = base + blob.fileOffset;
+            blobsByHash.emplace(blob.hash, i);
+            if (blob.compressed && scratch.size() < blob.rawSize) {
+                scratch.resize(blob.rawSize);
+            }
+        }
+        for (uint32_t i = 0; i < header->numEntries; i++) {
+            auto &source = storeEntries[i];
+            if (source.blob >= header->numBlobs || (uint64_t)source.nameOffset + source.nameLength >= stringsSize) {
+                logFormat(CVST_LogLevel_Warning, "preset store [%s] is invalid, starting empty", path.c_str());
+                clear();
+                platformUnmapFile(&mapped);
+                return false;
+            }
+            Entry entry;
+            entry.name.assign(strings + source.nameOffset, source.nameLength);
+            entry.pluginID = source.pluginID;
+            entry.chunkType = source.chunkType;
+            entry.blob = source.blob;
+            entries.push_back(std::move(entry));
+        }
+        return true;
+    }
+
+    const uint8_t *blobData(const Blob &blob) {
+        if (!blob.compressed) {
+            return (const uint8_t *)blob.data;
+        }
+        if (scratch.size() < blob.rawSize) {
+            scratch.resize(blob.rawSize);
+        }
+        if (!decompressBytes((const uint8_t *)blob.data, blob.storedSize, scratch.data(), blob.rawSize)) {
+            return nullptr;
+        }
+        return scratch.data();
+    }
+
+    // an existing blob with this content, or UINT32_MAX
+    uint32_t findBlob(const void *data, size_t size, uint64_t hash) {
+        auto range = blobsByHash.equal_range(hash);
+        for (auto it = range.first; it != range.second; ++it) {
+            auto &blob = blobs[it->second];
+            if (blob.rawSize != size) {
+                continue;
+            }
+            auto bytes = blobData(blob);
+            if (bytes && !memcmp(bytes, data, size)) {
+                return it->second;
+            }
+        }
+        return UINT32_MAX;
+    }
+
+    uint32_t addBlob(const void *data, size_t size, bool compress) {
+        auto hash = hashBytes(data, size);
+        auto existing = findBlob(data, size, hash);
+        if (existing != UINT32_MAX) {
+            return existing;
+        }
+        blobs.emplace_back();
+        auto &blob = blobs.back();
+        blob.rawSize = size;
+        blob.hash = hash;
+        blob.compressed = false;
+        blob.fileOffset = 0;
+        if (compress) {
+            compressBytes((const uint8_t *)data, size, blob.staged);
+            blob.compressed = blob.staged.size() <= size - size / COMPRESS_MIN_SAVING;
+        }
+        if (!blob.compressed) {
+            blob.staged.assign((const char *)data, (const char *)data + size);
+        }
+        else if (scratch.size() < size) {
+            scratch.resize(size);
+        }
+        blob.storedSize = blob.staged.size();
+        blob.data = blob.staged.data();
+        auto index = (uint32_t)blobs.size() - 1;
+        blobsByHash.emplace(hash, index);
+        return index;
+    }
+
+    int find(const char *name) const {
+        for (size_t i = 0; i < entries.size(); i++) {
+            if (entries[i].name == name) {
+                return (int)i;
+            }
+        }
+        return -1;
+    }
+
+    bool write(const char *filePath) {
+        // only the blobs still referenced, in order of first use
+        std::vector<uint32_t> newIndex(blobs.size(), UINT32_MAX);
+        std::vector<uint32_t> kept;
+        for (auto &entry : entries) {
+            if (newIndex[entry.blob] == UINT32_MAX) {
+                newIndex[entry.blob] = (uint32_t)kept.size();
+                kept.push_back(entry.blob);
+            }
+        }
+
+        StoreHeader header;
+        header.magic = STORE_MAGIC;
+        header.version = STORE_VERSION;
+        header.entrySize = sizeof(StoreEntry);
+        header.blobSize = sizeof(StoreBlob);
+        header.numEntries = (uint32_t)entries.size();
+        header.numBlobs = (uint32_t)kept.size();
+        header.stringsOffset = sizeof(StoreHeader) + entries.size() * sizeof(StoreEntry) + kept.size() * sizeof(StoreBlob);
+
+        std::vector<StoreEntry> storeEntries(entries.size());
+        uint64_t stringsSize = 0;
+        for (size_t i = 0; i < entries.size(); i++) {
+            auto &dest = storeEntries[i];
+            memset(&dest, 0, sizeof(dest));
+            dest.nameOffset = (uint32_t)stringsSize;
+            dest.nameLength = (uint32_t)entries[i].name.size();
+            dest.pluginID = entries[i].pluginID;
+            dest.chunkType = entries[i].chunkType;
+            dest.blob = newIndex[entries[i].blob];
+            stringsSize += dest.nameLength + 1;
+        }
+        header.dataOffset = alignUp(header.stringsOffset + stringsSize);
+
+        std::vector<StoreBlob> storeBlobs(kept.size());
+        uint64_t dataSize = 0;
+        for (size_t i = 0; i < kept.size(); i++) {
+            auto &source = blobs[kept[i]];
+            auto &dest = storeBlobs[i];
+            memset(&dest, 0, sizeof(dest));
+            dest.offset = dataSize;
+            dest.storedSize = source.storedSize;
+            dest.rawSize = source.rawSize;
+            dest.hash = source.hash;
+            dest.compressed = source.compressed ? 1 : 0;
+            dataSize = alignUp(dataSize + source.storedSize);
+        }
+
+        auto file = platformOpenFile(filePath, "wb");
+        if (!file) {
+            return false;
+        }
+        static const char padding[STORE_DATA_ALIGNMENT] = {};
+        bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+        ok = ok && (storeEntries.empty() || fwrite(storeEntries.data(), sizeof(StoreEntry), storeEntries.size(), file) == storeEntries.size());
+        ok = ok && (storeBlobs.empty() || fwrite(storeBlobs.data(), sizeof(StoreBlob), storeBlobs.size(), file) == storeBlobs.size());
+        for (auto &entry : entries) {
+            ok = ok && fwrite(entry.name.c_str(), entry.name.size() + 1, 1, file) == 1;
+        }
+        auto pad = header.dataOffset - (header.stringsOffset + stringsSize);
+        ok = ok && (pad == 0 || fwrite(padding, (size_t)pad, 1, file) == 1);
+        for (auto index : kept) {
+            auto &blob = blobs[index];
+            ok = ok && (blob.storedSize == 0 || fwrite(blob.data, (size_t)blob.storedSize, 1, file) == 1);
+            pad = alignUp(blob.storedSize) - blob.storedSize;
+            ok = ok && (pad == 0 || fwrite(padding, (size_t)pad, 1, file) == 1);
+        }
+        return (fclose(file) == 0) && ok;
+    }
+};
+
+CVSTHOST_API CVST_PresetStore CDECL CVST_PresetStoreOpen(const char *path)
+{
+    auto store = new _CVST_PresetStore(path);
+    store->load();
+    drainLog();
+    return store;
+}
+
+CVSTHOST_API void CDECL CVST_PresetStoreClose(CVST_PresetStore store)
+{
+    delete store;
+}
+
+CVSTHOST_API int CDECL CVST_PresetStoreGetCount(CVST_PresetStore store)
+{
+    return (int)store->entries.size();
+}
+
+CVSTHOST_API bool CDECL CVST_PresetStoreGetInfo(CVST_PresetStore store, int index, CVST_PresetInfo *info)
+{
+    if (index < 0 || index >= (int)store->entries.size()) {
+        return false;
+    }
+    auto &entry = store->entries[index];
+    auto &blob = store->blobs[entry.blob];
+    info->name = entry.name.c_str();
+    info->pluginID = entry.pluginID;
+    info->chunkType = (CVST_ChunkType)entry.chunkType;
+    info->size = (size_t)blob.rawSize;
+    info->compressed = blob.compressed;
+    return true;
+}
+
+CVSTHOST_API int CDECL CVST_PresetStoreFind(CVST_PresetStore store, const char *name)
+{
+    return store->find(name);
+}
+
+CVSTHOST_API const void * CDECL CVST_PresetStoreGetData(CVST_PresetStore store, int index, size_t *size)
+{
+    if (index < 0 || index >= (int)store->entries.size()) {
+        return nullptr;
+    }
+    auto &blob = store->blobs[store->entries[index].blob];
+    *size = (size_t)blob.rawSize;
+    return store->blobData(blob);
+}
+
+CVSTHOST_API bool CDECL CVST_PresetStoreApply(CVST_PresetStore store, int index, CVST_Plugin plugin)
+{
+    size_t size;
+    auto data = CVST_PresetStoreGetData(store, index, &size);
+    if (!data) {
+        return false;
+    }
+    CVST_SetChunk(plugin, (CVST_ChunkType)store->entries[index].chunkType, (void *)data, size);
+    return true;
+}
+
+CVSTHOST_API int CDECL CVST_PresetStoreAdd(CVST_PresetStore store, const char *name, int pluginID, enum CVST_ChunkType chunkType,
+    const void *data, size_t size, bool compress)
+{
+    auto blob = store->addBlob(data, size, compress);
+    auto index = store->find(name);
+    if (index < 0) {
+        store->entries.emplace_back();
+        store->entries.back().name = name;
+        index = (int)store->entries.size() - 1;
+    }
+    auto &entry = store->entries[index];
+    entry.pluginID = pluginID;
+    entry.chunkType = chunkType;
+    entry.blob = blob;
+    return index;
+}
+
+CVSTHOST_API int CDECL CVST_PresetStoreAddFromPlugin(CVST_PresetStore store, const char *name, CVST_Plugin plugin, enum CVST_ChunkType chunkType, bool compress)
+{
+    void *data = nullptr;
+    size_t size = 0;
+    CVST_GetChunk(plugin, chunkType, &data, &size);
+    if (!data || size == 0) {
+        return -1;
+    }
+    // (copied by the add before the plugin is called again)
+    auto index = CVST_PresetStoreAdd(store, name, 0, chunkType, data, size, compress);
+    CVST_PluginInfo info;
+    CVST_GetPluginInfo(plugin, &info);
+    store->entries[index].pluginID = info.uniqueID;
+    return index;
+}
+
+CVSTHOST_API bool CDECL CVST_PresetStoreCommit(CVST_PresetStore store)
+{
+    // write beside the file and swap it in, so a crash midway never leaves a truncated store behind
+    auto tempPath = store->path + ".tmp";
+    if (!store->write(tempPath.c_str())) {
+        logFormat(CVST_LogLevel_Error, "couldn't write preset store [%s]", tempPath.c_str());
+        drainLog();
+        return false;
+    }
+    platformUnmapFile(&store->mapped); // (windows can't replace a mapped file)
+    if (!platformReplaceFile(tempPath.c_str(), store->path.c_str())) {
+        logFormat(CVST_LogLevel_Error, "couldn't replace preset store [%s]", store->path.c_str());
+        // back to the old file -- additions (staged) are still in memory, the rest gets re-pointed into the new mapping
+        if (platformMapFile(store->path.c_str(), &store->mapped)) {
+            for (auto &blob : store->blobs) {
+                if (blob.fileOffset) {
+                    blob.data = (const char *)store->mapped.data + blob.fileOffset;
+                }
+            }
+        }
+        else {
+            store->clear();
+        }
+        drainLog();
+        return false;
+    }
+    auto ok = store->load();
+    drainLog();
+    return ok;
+}
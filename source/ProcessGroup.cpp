@@ -0,0 +1,233 @@
+// ProcessGroup.cpp : parallel processing of independent plugin instances (CVST_ProcessGroup*)
+//
+// each block, members are sorted by measured cost (most expensive first) and dealt round-robin
+// onto one queue per worker, the caller's thread being worker 0. workers drain their own queue
+// from the expensive end and then steal from the cheap end of the others', so the long jobs
+// start as early as possible and the short ones fill in the gaps at the end.
+//
+// a queue never holds items of its own -- item k of worker w is always order[w + k * numWorkers] --
+// so it is just a [head, tail) range packed into one atomic word; owner and thieves both CAS it.
+// nothing on the caller's side allocates or locks: the order is re-sorted in place (insertion sort -- costs drift
+// slowly, so it's nearly sorted already), and idle workers sleep on the generation word itself (futex, see
+// platformWaitWord), only woken with a syscall if any of them actually went to sleep.
+
+#include "CVSTHost.h"
+#include "Platform.h"
+
+#include <stdint.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#include <immintrin.h>
+#define CPU_RELAX() _mm_pause()
+#else
+#define CPU_RELAX() std::this_thread::yield()
+#endif
+
+#define SPIN_ITERATIONS 20000 // ~tens of microseconds of spinning before a worker goes to sleep between blocks
+#define COST_SMOOTHING 0.25   // weight of the newest measurement in each member's running cost
+#define WAIT_POLL_MS 100      // sleeping workers re-check regardless, every so often
+
+namespace {
+    struct Member {
+        CVST_Plugin plugin;
+        float **inputs;
+        float **outputs;
+        double cost = 0.0; // seconds, exponentially smoothed
+    };
+
+    struct WorkQueue { // padded to a cache line, they're hammered from every thread
+        std::atomic<uint64_t> range{ 0 };
+        char padding[64 - sizeof(std::atomic<uint64_t>)];
+    };
+
+    inline uint64_t packRange(uint32_t head, uint32_t tail) {
+        return ((uint64_t)head << 32) | tail;
+    }
+}
+
+struct _CVST_ProcessGroup {
+    std::vector<Member> members;
+    std::vector<int> order; // member indices, most expensive first
+
+    int numWorkers; // including the calling thread
+    std::vector<std::thread> threads;
+    std::unique_ptr<WorkQueue[]> queues;
+
+    unsigned int sampleFrames = 0;
+    std::atomic<int> jobsDone{ 0 };
+
+    std::atomic<uint32_t> generation{ 0 }; // bumped for every block (and to quit) -- what sleeping workers wait on
+    std::atomic<int> sleepers{ 0 };
+    std::atomic<bool> quit{ false };
+
+    _CVST_ProcessGroup(int numWorkers)
+        :numWorkers(numWorkers), queues(new WorkQueue[numWorkers])
+    {
+        for (int i = 1; i < numWorkers; i++) {
+            threads.push_back(std::thread(&_CVST_ProcessGroup::workerMain, this, i));
+        }
+    }
+
+    ~_CVST_ProcessGroup() {
+        quit = true;
+        wakeWorkers();
+        for (auto &thread : threads) {
+            thread.join();
+        }
+    }
+
+    int popOwn(int worker) {
+        auto &range = queues[worker].range;
+        auto current = range.load(std::memory_order_acquire);
+        while (true) {
+            auto head = (uint32_t)(current >> 32), tail = (uint32_t)current;
+            if (head >= tail) {
+                return -1;
+            }
+            if (range.compare_exchange_weak(current, packRange(head + 1, tail), std::memory_order_acq_rel)) {
+                return order[worker + head * numWorkers];
+            }
+        }
+    }
+
+    int steal(int victim) {
+        auto &range = queues[victim].range;
+        auto current = range.load(std::memory_order_acquire);
+        while (true) {
+            auto head = (uint32_t)(current >> 32), tail = (uint32_t)current;
+            if (head >= tail) {
+                return -1;
+            }
+            if (range.compare_exchange_weak(current, packRange(head, tail - 1), std::memory_order_acq_rel)) {
+                return order[victim + (tail - 1) * numWorkers];
+            }
+        }
+    }
+
+    void run(int index) {
+        auto &member = members[index];
+        auto start = std::chrono::steady_clock::now();
+        CVST_ProcessReplacing(member.plugin, member.inputs, member.outputs, sampleFrames);
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        member.cost += (elapsed.count() - member.cost) * COST_SMOOTHING;
+        jobsDone.fetch_add(1, std::memory_order_release);
+    }
+
+    void runJobs(int worker) {
+        int index;
+        while ((index = popOwn(worker)) >= 0) {
+            run(index);
+        }
+        for (int i = 1; i < numWorkers; i++) {
+            auto victim = (worker + i) % numWorkers;
+            while ((index = steal(victim)) >= 0) {
+                run(index);
+            }
+        }
+    }
+
+    // (seq_cst on both sides: either the worker sees the new generation before sleeping, or we see it sleeping)
+    void wakeWorkers() {
+        generation.fetch_add(1);
+        if (sleepers.load() > 0) {
+            platformWakeWord(&generation);
+        }
+    }
+
+    void workerMain(int worker) {
+        platformPinCurrentThread(worker % std::max(1u, std::thread::hardware_concurrency()));
+        uint32_t seen = 0;
+        while (true) {
+            // spin briefly (the next block is usually close), then sleep
+            int spins = 0;
+            while (generation.load(std::memory_order_acquire) == seen && !quit && spins < SPIN_ITERATIONS) {
+                CPU_RELAX();
+                spins++;
+            }
+            if (generation.load(std::memory_order_acquire) == seen && !quit) {
+                sleepers.fetch_add(1);
+                while (generation.load() == seen && !quit) {
+                    platformWaitWord(&generation, seen, WAIT_POLL_MS);
+                }
+                sleepers.fetch_sub(1);
+            }
+            if (quit) {
+                return;
+            }
+            seen = generation.load(std::memory_order_acquire);
+            runJobs(worker);
+        }
+    }
+};
+
+CVSTHOST_API CVST_ProcessGroup CDECL CVST_ProcessGroupCreate(int numWorkers)
+{
+    if (numWorkers <= 0) {
+        numWorkers = (int)std::thread::hardware_concurrency() - 1;
+    }
+    return new _CVST_ProcessGroup(std::max(numWorkers, 0) + 1);
+}
+
+CVSTHOST_API void CDECL CVST_ProcessGroupDestroy(CVST_ProcessGroup group)
+{
+    delete group;
+}
+
+CVSTHOST_API int CDECL CVST_ProcessGroupAdd(CVST_ProcessGroup group, CVST_Plugin plugin, float **inputs, float **outputs)
+{
+    Member member;
+    member.plugin = plugin;
+    member.inputs = inputs;
+    member.outputs = outputs;
+    group->members.push_back(member);
+    group->order.push_back((int)group->order.size());
+    return (int)group->members.size() - 1;
+}
+
+CVSTHOST_API void CDECL CVST_ProcessGroupSetBuffers(CVST_ProcessGroup group, int member, float **inputs, float **outputs)
+{
+    group->members[member].inputs = inputs;
+    group->members[member].outputs = outputs;
+}
+
+CVSTHOST_API void CDECL CVST_ProcessGroupProcess(CVST_ProcessGroup group, unsigned int sampleFrames)
+{
+    auto numMembers = (int)group->members.size();
+    if (numMembers == 0) {
+        return;
+    }
+
+    // longest processing time first, by last known cost (ties keep their previous relative order)
+    auto &members = group->members;
+    auto &order = group->order;
+    for (int i = 1; i < numMembers; i++) {
+        auto index = order[i];
+        auto j = i;
+        for (; j > 0 && members[order[j - 1]].cost < members[index].cost; j--) {
+            order[j] = order[j - 1];
+        }
+        order[j] = index;
+    }
+
+    group->sampleFrames = sampleFrames;
+    group->jobsDone.store(0, std::memory_order_relaxed);
+    for (int w = 0; w < group->numWorkers; w++) {
+        auto count = (numMembers - w + group->numWorkers - 1) / group->numWorkers; // items w, w+N, w+2N ...
+        group->queues[w].range.store(packRange(0, (uint32_t)std::max(count, 0)), std::memory_order_release);
+    }
+
+    if (group->numWorkers > 1) {
+        group->wakeWorkers();
+    }
+
+    group->runJobs(0);
+    while (group->jobsDone.load(std::memory_order_acquire) < numMembers) {
+        CPU_RELAX();
+    }
+}
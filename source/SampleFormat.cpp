@@ -0,0 +1,536 @@
+// SampleFormat.cpp : sample conversion and peak kernels (AVX2 / SSE2 where available, scalar otherwise)
+//
+// the span kernels are picked once, on first use, from what the CPU supports
+// (set CVSTHOST_NO_AVX2 in the environment to force the SSE2 path, eg for comparing the two)
+//
+// interleaved buffers are handled in chunks small enough to stay in L1: the contiguous interleaved
+// data is converted in one go, then scattered to / gathered from the plugin's channels
+
+#include "SampleFormat.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <assert.h>
+#include <algorithm>
+
+#define INTERLEAVE_CHUNK_SAMPLES 2048 // 8KB of floats
+
+// full-scale factors, and the clip range in the scaled (integer) domain
+// int32's upper bound is the largest float below 2^31, so the conversion can't wrap
+#define INT16_SCALE 32768.0f
+#define INT16_MAX_F 32767.0f
+#define INT24_SCALE 8388608.0f
+#define INT24_MAX_F 8388607.0f
+#define INT32_SCALE 2147483648.0f
+#define INT32_MAX_F 2147483520.0f
+
+namespace {
+    typedef void(*ToFloatKernel)(const void *source, float *dest, size_t count);
+    typedef void(*FromFloatKernel)(const float *source, void *dest, size_t count);
+    typedef float(*Peak32Kernel)(const float *source, size_t count);
+    typedef double(*Peak64Kernel)(const double *source, size_t count);
+
+    inline float clampf(float x, float lo, float hi) {
+        return std::min(std::max(x, lo), hi);
+    }
+
+    // === scalar (also the tail of every vector loop) ===
+
+    void int16ToFloatScalar(const int16_t *src, float *dst, size_t i, size_t count) {
+        for (; i < count; i++) {
+            dst[i] = src[i] * (1.0f / INT16_SCALE);
+        }
+    }
+    void floatToInt16Scalar(const float *src, int16_t *dst, size_t i, size_t count) {
+        for (; i < count; i++) {
+            dst[i] = (int16_t)lrintf(clampf(src[i] * INT16_SCALE, -INT16_SCALE, INT16_MAX_F));
+        }
+    }
+    void int32ToFloatScalar(const int32_t *src, float *dst, size_t i, size_t count) {
+        for (; i < count; i++) {
+            dst[i] = (float)src[i] * (1.0f / INT32_SCALE);
+        }
+    }
+    void floatToInt32Scalar(const float *src, int32_t *dst, size_t i, size_t count) {
+        for (; i < count; i++) {
+            dst[i] = (int32_t)lrintf(clampf(src[i] * INT32_SCALE, -INT32_SCALE, INT32_MAX_F));
+        }
+    }
+    void doubleToFloatScalar(const double *src, float *dst, size_t i, size_t count) {
+        for (; i < count; i++) {
+            dst[i] = (float)src[i];
+        }
+    }
+    void floatToDoubleScalar(const float *src, double *dst, size_t i, size_t count) {
+        for (; i < count; i++) {
+            dst[i] = src[i];
+        }
+    }
+    template <typename T>
+    T peakScalar(const T *src, T peak, size_t i, size_t count) {
+        for (; i < count; i++) {
+            peak = std::max(peak, (T)fabs(src[i]));
+        }
+        return peak;
+    }
+
+    // packed 24-bit has no natural vector width, it stays scalar on every path
+    void int24ToFloat(const void *source, float *dst, size_t count) {
+        auto src = (const uint8_t *)source;
+        for (size_t i = 0; i < count; i++, src += 3) {
+            auto value = (int32_t)(((uint32_t)src[0] << 8) | ((uint32_t)src[1] << 16) | ((uint32_t)src[2] << 24)) >> 8;
+            dst[i] = (float)value * (1.0f / INT24_SCALE);
+        }
+    }
+    void floatToInt24(const float *src, void *dest, size_t count) {
+        auto dst = (uint8_t *)dest;
+        for (size_t i = 0; i < count; i++, dst += 3) {
+            auto value = (int32_t)lrintf(clampf(src[i] * INT24_SCALE, -INT24_SCALE, INT24_MAX_F));
+            dst[0] = (uint8_t)value;
+            dst[1] = (uint8_t)(value >> 8);
+            dst[2] = (uint8_t)(value >> 16);
+        }
+    }
+
+    void float32Copy(const void *source, float *dest, size_t count) {
+        memcpy(dest, source, count * sizeof(float));
+    }
+    void float32CopyOut(const float *source, void *dest, size_t count) {
+        memcpy(dest, source, count * sizeof(float));
+    }
+
+    void int16ToFloatPlain(const void *source, float *dest, size_t count) {
+        int16ToFloatScalar((const int16_t *)source, dest, 0, count);
+    }
+    void floatToInt16Plain(const float *source, void *dest, size_t count) {
+        floatToInt16Scalar(source, (int16_t *)dest, 0, count);
+    }
+    void int32ToFloatPlain(const void *source, float *dest, size_t count) {
+        int32ToFloatScalar((const int32_t *)source, dest, 0, count);
+    }
+    void floatToInt32Plain(const float *source, void *dest, size_t count) {
+        floatToInt32Scalar(source, (int32_t *)dest, 0, count);
+    }
+    void doubleToFloatPlain(const void *source, float *dest, size_t count) {
+        doubleToFloatScalar((const double *)source, dest, 0, count);
+    }
+    void floatToDoublePlain(const float *source, void *dest, size_t count) {
+        floatToDoubleScalar(source, (double *)dest, 0, count);
+    }
+    float peak32Plain(const float *source, size_t count) {
+        return peakScalar(source, 0.0f, 0, count);
+    }
+    double peak64Plain(const double *source, size_t count) {
+        return peakScalar(source, 0.0, 0, count);
+    }
+
+#ifdef CVST_HAVE_SSE2
+    // === SSE2 ===
+
+    void int16ToFloatSSE2(const void *source, float *dst, size_t count) {
+        auto src = (const int16_t *)source;
+        auto scale = _mm_set1_ps(1.0f / INT16_SCALE);
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            auto x = _mm_loadu_si128((const __m128i *)(src + i));
+            auto lo = _mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16); // sign-extend
+            auto hi = _mm_srai_epi32(_mm_unpackhi_epi16(x, x), 16);
+            _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+            _mm_storeu_ps(dst + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+        }
+        int16ToFloatScalar(src, dst, i, count);
+    }
+    void floatToInt16SSE2(const float *src, void *dest, size_t count) {
+        auto dst = (int16_t *)dest;
+        auto scale = _mm_set1_ps(INT16_SCALE);
+        auto lo = _mm_set1_ps(-INT16_SCALE), hi = _mm_set1_ps(INT16_MAX_F);
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            auto a = _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(src + i), scale), lo), hi));
+            auto b = _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(src + i + 4), scale), lo), hi));
+            _mm_storeu_si128((__m128i *)(dst + i), _mm_packs_epi32(a, b));
+        }
+        floatToInt16Scalar(src, dst, i, count);
+    }
+    void int32ToFloatSSE2(const void *source, float *dst, size_t count) {
+        auto src = (const int32_t *)source;
+        auto scale = _mm_set1_ps(1.0f / INT32_SCALE);
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            auto x = _mm_loadu_si128((const __m128i *)(src + i));
+            _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(x), scale));
+        }
+        int32ToFloatScalar(src, dst, i, count);
+    }
+    void floatToInt32SSE2(const float *src, void *dest, size_t count) {
+        auto dst = (int32_t *)dest;
+        auto scale = _mm_set1_ps(INT32_SCALE);
+        auto lo = _mm_set1_ps(-INT32_SCALE), hi = _mm_set1_ps(INT32_MAX_F);
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            auto x = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(src + i), scale), lo), hi);
+            _mm_storeu_si128((__m128i *)(dst + i), _mm_cvtps_epi32(x));
+        }
+        floatToInt32Scalar(src, dst, i, count);
+    }
+    void doubleToFloatSSE2(const void *source, float *dst, size_t count) {
+        auto src = (const double *)source;
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            auto lo = _mm_cvtpd_ps(_mm_loadu_pd(src + i));
+            auto hi = _mm_cvtpd_ps(_mm_loadu_pd(src + i + 2));
+            _mm_storeu_ps(dst + i, _mm_movelh_ps(lo, hi));
+        }
+        doubleToFloatScalar(src, dst, i, count);
+    }
+    void floatToDoubleSSE2(const float *src, void *dest, size_t count) {
+        auto dst = (double *)dest;
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            auto x = _mm_loadu_ps(src + i);
+            _mm_storeu_pd(dst + i, _mm_cvtps_pd(x));
+            _mm_storeu_pd(dst + i + 2, _mm_cvtps_pd(_mm_movehl_ps(x, x)));
+        }
+        floatToDoubleScalar(src, dst, i, count);
+    }
+    // (abs: the sign bit masked off)
+    float peak32SSE2(const float *src, size_t count) {
+        auto mask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+        auto acc = _mm_setzero_ps();
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            acc = _mm_max_ps(acc, _mm_and_ps(_mm_loadu_ps(src + i), mask));
+        }
+        acc = _mm_max_ps(acc, _mm_movehl_ps(acc, acc));
+        acc = _mm_max_ss(acc, _mm_shuffle_ps(acc, acc, 1));
+        return peakScalar(src, _mm_cvtss_f32(acc), i, count);
+    }
+    double peak64SSE2(const double *src, size_t count) {
+        auto mask = _mm_castsi128_pd(_mm_set1_epi64x(0x7FFFFFFFFFFFFFFFll));
+        auto acc = _mm_setzero_pd();
+        size_t i = 0;
+        for (; i + 2 <= count; i += 2) {
+            acc = _mm_max_pd(acc, _mm_and_pd(_mm_loadu_pd(src + i), mask));
+        }
+        acc = _mm_max_sd(acc, _mm_unpackhi_pd(acc, acc));
+        return peakScalar(src, _mm_cvtsd_f64(acc), i, count);
+    }
+#endif
+
+#ifdef CVST_HAVE_AVX2
+    // === AVX2 ===
+
+    TARGET_AVX2 void int16ToFloatAVX2(const void *source, float *dst, size_t count) {
+        auto src = (const int16_t *)source;
+        auto scale = _mm256_set1_ps(1.0f / INT16_SCALE);
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            auto x = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *)(src + i)));
+            _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_cvtepi32_ps(x), scale));
+        }
+        int16ToFloatScalar(src, dst, i, count);
+    }
+    TARGET_AVX2 void floatToInt16AVX2(const float *src, void *dest, size_t count) {
+        auto dst = (int16_t *)dest;
+        auto scale = _mm256_set1_ps(INT16_SCALE);
+        auto lo = _mm256_set1_ps(-INT16_SCALE), hi = _mm256_set1_ps(INT16_MAX_F);
+        size_t i = 0;
+        for (; i + 16 <= count; i += 16) {
+            auto a = _mm256_cvtps_epi32(_mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(_mm256_loadu_ps(src + i), scale), lo), hi));
+            auto b = _mm256_cvtps_epi32(_mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(_mm256_loadu_ps(src + i + 8), scale), lo), hi));
+            // packs works within 128-bit lanes, so put the quadwords back in order afterwards
+            auto packed = _mm256_permute4x64_epi64(_mm256_packs_epi32(a, b), 0xD8);
+            _mm256_storeu_si256((__m256i *)(dst + i), packed);
+        }
+        floatToInt16Scalar(src, dst, i, count);
+    }
+    TARGET_AVX2 void int32ToFloatAVX2(const void *source, float *dst, size_t count) {
+        auto src = (const int32_t *)source;
+        auto scale = _mm256_set1_ps(1.0f / INT32_SCALE);
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            auto x = _mm256_loadu_si256((const __m256i *)(src + i));
+            _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_cvtepi32_ps(x), scale));
+        }
+        int32ToFloatScalar(src, dst, i, count);
+    }
+    TARGET_AVX2 void floatToInt32AVX2(const float *src, void *dest, size_t count) {
+        auto dst = (int32_t *)dest;
+        auto scale = _mm256_set1_ps(INT32_SCALE);
+        auto lo = _mm256_set1_ps(-INT32_SCALE), hi = _mm256_set1_ps(INT32_MAX_F);
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            auto x = _mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(_mm256_loadu_ps(src + i), scale), lo), hi);
+            _mm256_storeu_si256((__m256i *)(dst + i), _mm256_cvtps_epi32(x));
+        }
+        floatToInt32Scalar(src, dst, i, count);
+    }
+    TARGET_AVX2 void doubleToFloatAVX2(const void *source, float *dst, size_t count) {
+        auto src = (const double *)source;
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            _mm_storeu_ps(dst + i, _mm256_cvtpd_ps(_mm256_loadu_pd(src + i)));
+        }
+        doubleToFloatScalar(src, dst, i, count);
+    }
+    TARGET_AVX2 void floatToDoubleAVX2(const float *src, void *dest, size_t count) {
+        auto dst = (double *)dest;
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            _mm256_storeu_pd(dst + i, _mm256_cvtps_pd(_mm_loadu_ps(src + i)));
+        }
+        floatToDoubleScalar(src, dst, i, count);
+    }
+    TARGET_AVX2 float peak32AVX2(const float *src, size_t count) {
+        auto mask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+        auto acc = _mm256_setzero_ps();
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            acc = _mm256_max_ps(acc, _mm256_and_ps(_mm256_loadu_ps(src + i), mask));
+        }
+        auto half = _mm_max_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+        half = _mm_max_ps(half, _mm_movehl_ps(half, half));
+        half = _mm_max_ss(half, _mm_shuffle_ps(half, half, 1));
+        return peakScalar(src, _mm_cvtss_f32(half), i, count);
+    }
+    TARGET_AVX2 double peak64AVX2(const double *src, size_t count) {
+        auto mask = _mm256_castsi256_pd(_mm256_set1_epi64x(0x7FFFFFFFFFFFFFFFll));
+        auto acc = _mm256_setzero_pd();
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            acc = _mm256_max_pd(acc, _mm256_and_pd(_mm256_loadu_pd(src + i), mask));
+        }
+        auto half = _mm_max_pd(_mm256_castpd256_pd128(acc), _mm256_extractf128_pd(acc, 1));
+        half = _mm_max_sd(half, _mm_unpackhi_pd(half, half));
+        return peakScalar(src, _mm_cvtsd_f64(half), i, count);
+    }
+#endif
+
+    struct KernelTable {
+        ToFloatKernel toFloat[CVST_SampleFormat_Float64 + 1];
+        FromFloatKernel fromFloat[CVST_SampleFormat_Float64 + 1];
+        Peak32Kernel peak32 = peak32Plain;
+        Peak64Kernel peak64 = peak64Plain;
+
+        KernelTable() {
+            toFloat[CVST_SampleFormat_Int16] = int16ToFloatPlain;
+            toFloat[CVST_SampleFormat_Int24] = int24ToFloat;
+            toFloat[CVST_SampleFormat_Int32] = int32ToFloatPlain;
+            toFloat[CVST_SampleFormat_Float32] = float32Copy;
+            toFloat[CVST_SampleFormat_Float64] = doubleToFloatPlain;
+            fromFloat[CVST_SampleFormat_Int16] = floatToInt16Plain;
+            fromFloat[CVST_SampleFormat_Int24] = floatToInt24;
+            fromFloat[CVST_SampleFormat_Int32] = floatToInt32Plain;
+            fromFloat[CVST_SampleFormat_Float32] = float32CopyOut;
+            fromFloat[CVST_SampleFormat_Float64] = floatToDoublePlain;
+#ifdef CVST_HAVE_SSE2
+            toFloat[CVST_SampleFormat_Int16] = int16ToFloatSSE2;
+            toFloat[CVST_SampleFormat_Int32] = int32ToFloatSSE2;
+            toFloat[CVST_SampleFormat_Float64] = doubleToFloatSSE2;
+            fromFloat[CVST_SampleFormat_Int16] = floatToInt16SSE2;
+            fromFloat[CVST_SampleFormat_Int32] = floatToInt32SSE2;
+            fromFloat[CVST_SampleFormat_Float64] = floatToDoubleSSE2;
+            peak32 = peak32SSE2;
+            peak64 = peak64SSE2;
+#endif
+#ifdef CVST_HAVE_AVX2
+            if (cpuHasAVX2()) {
+                toFloat[CVST_SampleFormat_Int16] = int16ToFloatAVX2;
+                toFloat[CVST_SampleFormat_Int32] = int32ToFloatAVX2;
+                toFloat[CVST_SampleFormat_Float64] = doubleToFloatAVX2;
+                fromFloat[CVST_SampleFormat_Int16] = floatToInt16AVX2;
+                fromFloat[CVST_SampleFormat_Int32] = floatToInt32AVX2;
+                fromFloat[CVST_SampleFormat_Float64] = floatToDoubleAVX2;
+                peak32 = peak32AVX2;
+                peak64 = peak64AVX2;
+            }
+#endif
+        }
+    };
+
+    const KernelTable &kernels() {
+        static KernelTable table; // thread-safe init, and nothing to do after that
+        return table;
+    }
+}
+
+bool cpuHasAVX2()
+{
+#ifdef CVST_HAVE_AVX2
+    if (getenv("CVSTHOST_NO_AVX2")) {
+        return false;
+    }
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#else
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) {
+        return false;
+    }
+    __cpuid(info, 1);
+    auto osxsave = (info[2] & (1 << 27)) != 0, avx = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx || (_xgetbv(0) & 6) != 6) { // OS must save the YMM state
+        return false;
+    }
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#endif
+#else
+    return false;
+#endif
+}
+
+float peakLevel(const float *source, size_t count)
+{
+    return kernels().peak32(source, count);
+}
+
+double peakLevel(const double *source, size_t count)
+{
+    return kernels().peak64(source, count);
+}
+
+void convertDoubleToFloat(float *dest, const double *source, size_t count)
+{
+    kernels().toFloat[CVST_SampleFormat_Float64](source, dest, count);
+}
+
+void convertFloatToDouble(double *dest, const float *source, size_t count)
+{
+    kernels().fromFloat[CVST_SampleFormat_Float64](source, dest, count);
+}
+
+void convertSpanToFloat(CVST_SampleFormat format, const void *source, float *dest, size_t count)
+{
+    kernels().toFloat[format](source, dest, count);
+}
+
+void convertSpanFromFloat(CVST_SampleFormat format, const float *source, void *dest, size_t count)
+{
+    kernels().fromFloat[format](source, dest, count);
+}
+
+size_t sampleFormatBytes(CVST_SampleFormat format)
+{
+    switch (format) {
+    case CVST_SampleFormat_Int16:
+        return 2;
+    case CVST_SampleFormat_Int24:
+        return 3;
+    case CVST_SampleFormat_Int32:
+    case CVST_SampleFormat_Float32:
+        return 4;
+    default:
+        return 8;
+    }
+}
+
+CVSTHOST_API void CDECL CVST_ConvertToFloat(const CVST_BufferLayout *layout, const void * const *driverBuffers, float **pluginBuffers, int numPluginChannels, const int *routing, unsigned int sampleFrames)
+{
+    auto numDriverChannels = layout->numChannels;
+    auto sourceChannel = [&](int i) {
+        auto ch = routing ? routing[i] : i;
+        return (ch >= 0 && ch < numDriverChannels) ? ch : -1;
+    };
+
+    // (no driver channels: every plugin channel is silenced, and there's nothing to interleave)
+    if (!layout->interleaved || numDriverChannels <= 0) {
+        for (int i = 0; i < numPluginChannels; i++) {
+            auto ch = sourceChannel(i);
+            if (ch >= 0) {
+                convertSpanToFloat(layout->format, driverBuffers[ch], pluginBuffers[i], sampleFrames);
+            }
+            else {
+                memset(pluginBuffers[i], 0, sampleFrames * sizeof(float));
+            }
+        }
+        return;
+    }
+
+    assert(numDriverChannels <= INTERLEAVE_CHUNK_SAMPLES);
+    float scratch[INTERLEAVE_CHUNK_SAMPLES];
+    auto chunkFrames = (unsigned int)std::max(1, INTERLEAVE_CHUNK_SAMPLES / numDriverChannels);
+    auto frameBytes = sampleFormatBytes(layout->format) * numDriverChannels;
+    auto source = (const uint8_t *)driverBuffers[0];
+    for (unsigned int frame = 0; frame < sampleFrames; frame += chunkFrames) {
+        auto frames = std::min(chunkFrames, sampleFrames - frame);
+        const float *interleaved = scratch;
+        if (layout->format == CVST_SampleFormat_Float32) {
+            interleaved = (const float *)(source + frame * frameBytes); // already float, gather straight from the driver buffer
+        }
+        else {
+            convertSpanToFloat(layout->format, source + frame * frameBytes, scratch, (size_t)frames * numDriverChannels);
+        }
+        for (int i = 0; i < numPluginChannels; i++) {
+            auto ch = sourceChannel(i);
+            auto dest = pluginBuffers[i] + frame;
+            if (ch >= 0) {
+                for (unsigned int j = 0; j < frames; j++) {
+                    dest[j] = interleaved[j * numDriverChannels + ch];
+                }
+            }
+            else {
+                memset(dest, 0, frames * sizeof(float));
+            }
+        }
+    }
+}
+
+CVSTHOST_API void CDECL CVST_ConvertFromFloat(const CVST_BufferLayout *layout, float **pluginBuffers, int numPluginChannels, void **driverBuffers, const int *routing, unsigned int sampleFrames)
+{
+    auto numDriverChannels = layout->numChannels;
+    auto sourceChannel = [&](int i) {
+        auto ch = routing ? routing[i] : i;
+        return (ch >= 0 && ch < numPluginChannels) ? ch : -1;
+    };
+
+    if (numDriverChannels <= 0) {
+        return;
+    }
+    if (!layout->interleaved) {
+        for (int i = 0; i < numDriverChannels; i++) {
+            auto ch = sourceChannel(i);
+            if (ch >= 0) {
+                convertSpanFromFloat(layout->format, pluginBuffers[ch], driverBuffers[i], sampleFrames);
+            }
+            else {
+                memset(driverBuffers[i], 0, sampleFrames * sampleFormatBytes(layout->format)); // all-zero bits is silence in every format
+            }
+        }
+        return;
+    }
+
+    assert(numDriverChannels <= INTERLEAVE_CHUNK_SAMPLES);
+    float scratch[INTERLEAVE_CHUNK_SAMPLES];
+    auto chunkFrames = (unsigned int)std::max(1, INTERLEAVE_CHUNK_SAMPLES / numDriverChannels);
+    auto frameBytes = sampleFormatBytes(layout->format) * numDriverChannels;
+    auto dest = (uint8_t *)driverBuffers[0];
+    for (unsigned int frame = 0; frame < sampleFrames; frame += chunkFrames) {
+        auto frames = std::min(chunkFrames, sampleFrames - frame);
+        auto interleaved = scratch;
+        if (layout->format == CVST_SampleFormat_Float32) {
+            interleaved = (float *)(dest + frame * frameBytes); // scatter straight into the driver buffer
+        }
+        for (int i = 0; i < numDriverChannels; i++) {
+            auto ch = sourceChannel(i);
+            if (ch >= 0) {
+                auto source = pluginBuffers[ch] + frame;
+                for (unsigned int j = 0; j < frames; j++) {
+                    interleaved[j * numDriverChannels + i] = source[j];
+                }
+            }
+            else {
+                for (unsigned int j = 0; j < frames; j++) {
+                    interleaved[j * numDriverChannels + i] = 0.0f;
+                }
+            }
+        }
+        if (interleaved == scratch) {
+            convertSpanFromFloat(layout->format, scratch, dest + frame * frameBytes, (size_t)frames * numDriverChannels);
+        }
+    }
+}
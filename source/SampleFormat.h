@@ -0,0 +1,43 @@
+#ifndef __CVSTHOST_SAMPLEFORMAT_H__
+#define __CVSTHOST_SAMPLEFORMAT_H__
+
+// (internal) vectorized sample conversion (and peak level) kernels
+// contiguous spans only -- interleaving/routing is layered on top, in SampleFormat.cpp
+
+#include <stddef.h>
+#include "CVSTHost.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CVST_HAVE_SSE2 1
+#endif
+
+#ifdef CVST_HAVE_SSE2
+#include <emmintrin.h>
+#include <immintrin.h>
+#if defined(__GNUC__) || defined(__clang__)
+#define CVST_HAVE_AVX2 1
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#elif defined(_MSC_VER)
+#include <intrin.h>
+#define CVST_HAVE_AVX2 1
+#define TARGET_AVX2
+#endif
+#endif
+
+// whether the AVX2 kernels can be used (never with CVSTHOST_NO_AVX2 set in the environment)
+bool cpuHasAVX2();
+
+// largest absolute sample value in the span (silence detection)
+float peakLevel(const float *source, size_t count);
+double peakLevel(const double *source, size_t count);
+
+void convertDoubleToFloat(float *dest, const double *source, size_t count);
+void convertFloatToDouble(double *dest, const float *source, size_t count);
+
+// any driver format <-> float, picking the widest instruction set the CPU supports (AVX2 / SSE2 / scalar)
+void convertSpanToFloat(CVST_SampleFormat format, const void *source, float *dest, size_t count);
+void convertSpanFromFloat(CVST_SampleFormat format, const float *source, void *dest, size_t count);
+
+size_t sampleFormatBytes(CVST_SampleFormat format);
+
+#endif // __CVSTHOST_SAMPLEFORMAT_H__
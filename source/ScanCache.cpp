@@ -0,0 +1,261 @@
+// ScanCache.cpp : persistent plugin scan index (CVST_ScanCache*)
+//
+// index file layout (native endianness and struct layout -- it's a local cache, not an interchange format):
+//   IndexHeader
+//   IndexRecord[count], sorted by path (strcmp order), so lookups are a binary search straight on the mapping
+//   path strings, each 0-terminated (offset/length in its record)
+// anything that doesn't check out (magic, version, record size, bounds) makes the index count as empty,
+// so everything just gets scanned again.
+
+#include "CVSTHost.h"
+
+#include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Platform.h"
+#include "Bridge.h"
+#include "Log.h"
+
+#define INDEX_MAGIC 0x43535643 // "CVSC"
+#define INDEX_VERSION 1
+#define SCAN_SAMPLE_RATE 44100.0f // some plugins only answer queries once opened
+
+namespace {
+    struct IndexHeader {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t recordSize; // catches layout changes of CVST_PluginInfo
+        uint32_t count;
+    };
+
+    struct IndexRecord {
+        uint64_t fileSize;
+        int64_t modifiedTime;
+        uint32_t pathOffset; // from the start of the string area
+        uint32_t pathLength; // without the terminator
+        uint32_t scanFailed;
+        uint32_t reserved;
+        CVST_PluginInfo info;
+    };
+
+    struct Entry {
+        std::string path;
+        IndexRecord record;
+    };
+
+    // bridged, a plugin that crashes while loading (or while being asked) only fails its own entry
+    void scanEntry(Entry &entry, bool bridged)
+    {
+        auto plugin = bridged ? CVST_LoadPluginBridged(entry.path.c_str(), nullptr) : CVST_LoadPlugin(entry.path.c_str(), nullptr);
+        if (!plugin) {
+            entry.record.scanFailed = 1;
+            return;
+        }
+        CVST_Start(plugin, SCAN_SAMPLE_RATE);
+        CVST_GetPluginInfo(plugin, &entry.record.info);
+        if (!CVST_IsAlive(plugin)) {
+            entry.record.scanFailed = 1;
+        }
+        CVST_Destroy(plugin);
+    }
+}
+
+struct _CVST_ScanCache {
+    std::string indexPath;
+    PlatformMappedFile mapped;
+    const IndexRecord *records = nullptr;
+    const char *strings = nullptr;
+    int count = 0;
+
+    _CVST_ScanCache(const char *indexPath)
+        :indexPath(indexPath) {}
+
+    ~_CVST_ScanCache() {
+        unmap();
+    }
+
+    void unmap() {
+        platformUnmapFile(&mapped);
+        records = nullptr;
+        strings = nullptr;
+        count = 0;
+    }
+
+    void map() {
+        unmap();
+        if (!platformMapFile(indexPath.c_str(), &mapped)) {
+            return;
+        }
+        auto base = (const char *)mapped.data;
+        auto header = (const IndexHeader *)base;
+        if (mapped.size < sizeof(IndexHeader) || header->magic != INDEX_MAGIC || header->version != INDEX_VERSION ||
+            header->recordSize != sizeof(IndexRecord) ||
+            (mapped.size - sizeof(IndexHeader)) / sizeof(IndexRecord) < header->count)
+        {
+            unmap();
+            return;
+        }
+        auto recordsBegin = (const IndexRecord *)(base + sizeof(IndexHeader));
+        auto stringsBegin = (const char *)(recordsBegin + header->count);
+        auto stringsSize = mapped.size - (stringsBegin - base);
+        for (uint32_t i = 0; i < header->count; i++) {
+            auto &record = recordsBegin[i];
+            if ((uint64_t)record.pathOffset + record.pathLength >= stringsSize || stringsBegin[record.pathOffset + record.pathLength] != 0) {
+                unmap();
+                return;
+            }
+        }
+        records = recordsBegin;
+        strings = stringsBegin;
+        count = (int)header->count;
+    }
+
+    inline const char *pathAt(int index) const {
+        return strings + records[index].pathOffset;
+    }
+
+    int find(const char *path) const {
+        int lo = 0, hi = count;
+        while (lo < hi) {
+            auto mid = lo + (hi - lo) / 2;
+            if (strcmp(pathAt(mid), path) < 0) {
+                lo = mid + 1;
+            }
+            else {
+                hi = mid;
+            }
+        }
+        return (lo < count && !strcmp(pathAt(lo), path)) ? lo : -1;
+    }
+
+    bool write(const char *path, std::vector<Entry> &entries) {
+        auto file = platformOpenFile(path, "wb");
+        if (!file) {
+            return false;
+        }
+        IndexHeader header;
+        header.magic = INDEX_MAGIC;
+        header.version = INDEX_VERSION;
+        header.recordSize = sizeof(IndexRecord);
+        header.count = (uint32_t)entries.size();
+        uint32_t stringOffset = 0;
+        for (auto &entry : entries) {
+            entry.record.pathOffset = stringOffset;
+            entry.record.pathLength = (uint32_t)entry.path.size();
+            stringOffset += entry.record.pathLength + 1;
+        }
+        bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+        for (auto &entry : entries) {
+            ok = ok && fwrite(&entry.record, sizeof(IndexRecord), 1, file) == 1;
+        }
+        for (auto &entry : entries) {
+            ok = ok && fwrite(entry.path.c_str(), entry.path.size() + 1, 1, file) == 1;
+        }
+        return (fclose(file) == 0) && ok;
+    }
+};
+
+CVSTHOST_API CVST_ScanCache CDECL CVST_ScanCacheOpen(const char *indexPath)
+{
+    auto cache = new _CVST_ScanCache(indexPath);
+    cache->map();
+    return cache;
+}
+
+CVSTHOST_API void CDECL CVST_ScanCacheClose(CVST_ScanCache cache)
+{
+    delete cache;
+}
+
+CVSTHOST_API int CDECL CVST_ScanCacheUpdate(CVST_ScanCache cache, const char * const *paths, int numPaths, int numThreads)
+{
+    std::vector<Entry> entries;
+    entries.reserve(numPaths);
+    std::vector<size_t> toScan;
+    for (int i = 0; i < numPaths; i++) {
+        Entry entry;
+        entry.path = paths[i];
+        uint64_t fileSize;
+        int64_t modifiedTime;
+        if (!platformFileStat(paths[i], &fileSize, &modifiedTime)) {
+            continue; // gone
+        }
+        auto found = cache->find(paths[i]);
+        if (found >= 0 && cache->records[found].fileSize == fileSize && cache->records[found].modifiedTime == modifiedTime) {
+            entry.record = cache->records[found];
+        }
+        else {
+            memset(&entry.record, 0, sizeof(entry.record));
+            entry.record.fileSize = fileSize;
+            entry.record.modifiedTime = modifiedTime;
+            toScan.push_back(entries.size());
+        }
+        entries.push_back(std::move(entry));
+    }
+
+    // loading is mostly waiting on the disk and the plugins' static initializers, so scan in parallel
+    if (numThreads <= 0) {
+        numThreads = std::max((int)std::thread::hardware_concurrency(), 1);
+    }
+    numThreads = std::min(numThreads, (int)toScan.size());
+    auto bridged = bridgeAvailable();
+    if (!bridged && !toScan.empty()) {
+        logMessage(CVST_LogLevel_Warning, "scan cache: no bridge executable set (CVST_SetBridgePath), scanning in-process");
+        drainLog();
+    }
+    std::atomic<size_t> next{ 0 };
+    auto work = [&]() {
+        for (auto i = next++; i < toScan.size(); i = next++) {
+            scanEntry(entries[toScan[i]], bridged);
+        }
+    };
+    std::vector<std::thread> threads;
+    for (int i = 1; i < numThreads; i++) {
+        threads.emplace_back(work);
+    }
+    work();
+    for (auto &thread : threads) {
+        thread.join();
+    }
+
+    std::sort(entries.begin(), entries.end(), [](const Entry &a, const Entry &b) { return strcmp(a.path.c_str(), b.path.c_str()) < 0; });
+    entries.erase(std::unique(entries.begin(), entries.end(), [](const Entry &a, const Entry &b) { return a.path == b.path; }), entries.end());
+
+    // write beside the index and swap it in, so a crash midway never leaves a truncated index behind
+    auto tempPath = cache->indexPath + ".tmp";
+    if (!cache->write(tempPath.c_str(), entries)) {
+        return -1;
+    }
+    cache->unmap(); // (windows can't replace a mapped file)
+    auto replaced = platformReplaceFile(tempPath.c_str(), cache->indexPath.c_str());
+    cache->map();
+    return replaced ? (int)toScan.size() : -1;
+}
+
+CVSTHOST_API int CDECL CVST_ScanCacheGetCount(CVST_ScanCache cache)
+{
+    return cache->count;
+}
+
+CVSTHOST_API const char * CDECL CVST_ScanCacheGetPath(CVST_ScanCache cache, int index)
+{
+    return (index >= 0 && index < cache->count) ? cache->pathAt(index) : nullptr;
+}
+
+CVSTHOST_API bool CDECL CVST_ScanCacheGetInfo(CVST_ScanCache cache, int index, CVST_PluginInfo *info)
+{
+    if (index < 0 || index >= cache->count || cache->records[index].scanFailed) {
+        return false;
+    }
+    *info = cache->records[index].info;
+    return true;
+}
+
+CVSTHOST_API int CDECL CVST_ScanCacheFind(CVST_ScanCache cache, const char *path)
+{
+    return cache->find(path);
+}
@@ -0,0 +1,79 @@
+#ifndef __CVSTHOST_SLEEP_H__
+#define __CVSTHOST_SLEEP_H__
+
+// (internal) per-plugin sleep on silence, see CVST_SetSleepMode
+//
+// counts the frames since the plugin last had anything to do -- input above the threshold, MIDI, a held note or
+// sustain pedal, a parameter change -- and once that's more than its tail plus its latency (its output has died away
+// by then), process calls skip the plugin and zero the outputs instead. the first block with anything to do wakes it:
+// nothing else changes, it just missed some silence. notes are followed as they're sent to the plugin, so that a note
+// held through silent input (an instrument, or a vocoder's carrier) keeps it awake.
+// audio thread only, apart from 'sleeping' (CVST_IsSleeping).
+
+#include <stdint.h>
+#include <string.h>
+#include <atomic>
+
+struct SleepState {
+    // (whether it's on at all is _CVST_Plugin::hot.sleepEnabled, checked before anything here)
+    float threshold = 0.0f; // peak level that still counts as silence
+    int fallbackTail = 0; // frames, for plugins that don't know theirs (effGetTailSize 0)
+    int tail = 0; // frames, at the host rate
+
+    uint64_t quietFrames = 0; // processed since the last activity
+    std::atomic<bool> sleeping{ false };
+
+    uint64_t heldNotes[16 * 128 / 64]; // a bit per channel and note
+    uint16_t sustain = 0; // a bit per channel (CC64)
+    int numHeld = 0; // bits set in heldNotes
+
+    SleepState() {
+        reset();
+    }
+
+    void reset() {
+        quietFrames = 0;
+        sleeping.store(false, std::memory_order_relaxed);
+        memset(heldNotes, 0, sizeof(heldNotes));
+        sustain = 0;
+        numHeld = 0;
+    }
+
+    // a MIDI message on its way to the plugin
+    void trackMidi(const char *data) {
+        auto status = (uint8_t)data[0] & 0xF0;
+        auto channel = (uint8_t)data[0] & 0x0F;
+        auto data1 = (uint8_t)data[1] & 0x7F, data2 = (uint8_t)data[2] & 0x7F;
+        if (status == 0x90 || status == 0x80) {
+            auto bit = channel * 128 + data1;
+            auto &word = heldNotes[bit >> 6];
+            auto mask = 1ull << (bit & 63);
+            auto wasHeld = (word & mask) != 0;
+            if (status == 0x90 && data2 > 0) {
+                word |= mask;
+                numHeld += wasHeld ? 0 : 1;
+            }
+            else {
+                word &= ~mask;
+                numHeld -= wasHeld ? 1 : 0;
+            }
+        }
+        else if (status == 0xB0 && data1 == 64) {
+            sustain = data2 >= 64 ? (uint16_t)(sustain | (1 << channel)) : (uint16_t)(sustain & ~(1 << channel));
+        }
+        else if (status == 0xB0 && (data1 == 120 || data1 == 123)) {
+            // all sound / all notes off: the channel's two words
+            for (int i = 0; i < 2; i++) {
+                for (auto &word = heldNotes[channel * 2 + i]; word; word &= word - 1) {
+                    numHeld--;
+                }
+            }
+        }
+    }
+
+    inline bool holding() const {
+        return numHeld > 0 || sustain != 0;
+    }
+};
+
+#endif // __CVSTHOST_SLEEP_H__
@@ -0,0 +1,118 @@
+#ifndef __CVSTHOST_STATELOAD_H__
+#define __CVSTHOST_STATELOAD_H__
+
+// (internal) per-plugin asynchronous state change, see CVST_SetChunkAsync
+//
+// a second instance of the plugin is loaded, given the chunk and warmed up on a loader thread, then swapped in by the
+// audio thread at the start of a block. when crossfading, the old instance keeps running on the same input until the
+// fade is over, and gets the same MIDI and block parameter changes (all at the start of each block: it's only heard
+// fading out) -- CVST_SetParameters meanwhile only reaches the new one. closing it is left to the next non-realtime call
+// that notices (CVST_GetStateLoadStatus, CVST_Destroy).
+// 'stage' hands the instances back and forth, each stage has a single owner:
+//   Preparing   the loader thread ('incoming')
+//   Ready       the audio thread may swap, at its next block
+//   Fading      the audio thread ('outgoing' runs alongside, into 'scratch')
+//   Retired     the fade is over, non-realtime side closes 'outgoing'
+//   Failed      the loader gave up (nothing was swapped), non-realtime side cleans up
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "../deps/VST2_SDK/pluginterfaces/vst2.x/aeffectx.h"
+
+#include "CVSTHost.h"
+#include "Bridge.h"
+#include "Oversampler.h"
+
+#define STATE_LOAD_WARMUP_BLOCKS 4 // of silence, so first-block allocations and lazy init happen off the audio thread
+#define STATE_LOAD_DEFAULT_BLOCK_SIZE 512 // for the warmup, if the plugin has none yet
+
+enum StateLoadStage {
+    kStateLoadIdle,
+    kStateLoadPreparing,
+    kStateLoadReady,
+    kStateLoadFading,
+    kStateLoadRetired,
+    kStateLoadDone,
+    kStateLoadFailed
+};
+
+struct StateLoad {
+    std::atomic<int> stage{ kStateLoadIdle };
+    std::thread loader;
+
+    // the request, and the plugin's setup at the time (the new instance gets the same)
+    VstInt32 chunkIndex = 0;
+    std::vector<char> chunk;
+    int crossfadeFrames = 0;
+    float sampleRate = 44100.0f;
+    int blockSize = 0; // per plugin call, at the host rate
+    bool doublePrecision = false; // native 64-bit processing
+    bool resumed = false;
+
+    AEffect *incoming = nullptr; // until swapped
+    PlatformLibrary library = NULL; // in-process: incoming's reference to the library (traded for outgoing's at the end)
+    std::unique_ptr<BridgeClient> incomingBridge; // bridged: incoming's proxy (becomes the plugin's bridge once 'outgoing' is closed)
+    AEffect *outgoing = nullptr; // after the swap
+    Oversampler oversampler; // outgoing's, set up with the request (the filter state is copied over at the swap)
+
+    // the MIDI sent to the outgoing instance during the fade (as many events as the plugin's own storage takes)
+    std::vector<VstMidiEvent> midi;
+    std::unique_ptr<char[]> vstEventsMemory;
+    VstEvents *vstEvents = nullptr;
+
+    // the outgoing instance's output during the fade
+    int fadePosition = 0;
+    int scratchFrames = 0;
+    std::vector<double> scratchStorage; // (big enough for either precision)
+    std::vector<float *> scratchFloat;
+    std::vector<double *> scratchDouble;
+
+    void allocScratch(int numOutputs, int frames) {
+        scratchStorage.assign((size_t)numOutputs * frames, 0.0);
+        scratchFloat.resize(numOutputs);
+        scratchDouble.resize(numOutputs);
+        for (int i = 0; i < numOutputs; i++) {
+            scratchFloat[i] = (float *)&scratchStorage[(size_t)i * frames];
+            scratchDouble[i] = &scratchStorage[(size_t)i * frames];
+        }
+        scratchFrames = frames;
+    }
+
+    void allocEvents(int capacity) {
+        if ((int)midi.size() == capacity) {
+            return;
+        }
+        midi.resize(capacity);
+        for (auto &vme : midi) {
+            vme.type = kVstMidiType;
+            vme.byteSize = sizeof(VstMidiEvent);
+            vme.flags = kVstMidiEventIsRealtime;
+        }
+        // VstEvents declares events[2]
+        vstEventsMemory.reset(new char[sizeof(VstEvents) + sizeof(VstEvent *) * std::max(capacity - 2, 0)]);
+        vstEvents = (VstEvents *)vstEventsMemory.get();
+        vstEvents->reserved = 0;
+    }
+
+    inline float **scratch(float **) { return scratchFloat.data(); }
+    inline double **scratch(double **) { return scratchDouble.data(); }
+
+    // linear crossfade (the two instances are the same plugin, so their outputs are largely correlated) from the scratch
+    // buffers into outputs, over the next 'frames' of the fade
+    template <typename T>
+    void mix(T **outputs, int numOutputs, unsigned int frames) {
+        auto faded = scratch(outputs);
+        auto step = (T)1 / (T)crossfadeFrames;
+        for (int ch = 0; ch < numOutputs; ch++) {
+            auto gain = (T)fadePosition * step;
+            for (unsigned int i = 0; i < frames; i++, gain += step) {
+                outputs[ch][i] = faded[ch][i] + (outputs[ch][i] - faded[ch][i]) * gain;
+            }
+        }
+        fadePosition += (int)frames;
+    }
+};
+
+#endif
@@ -0,0 +1,151 @@
+#ifndef __CVSTHOST_STATS_H__
+#define __CVSTHOST_STATS_H__
+
+// (internal) per-plugin DSP load statistics, see CVST_GetStats
+//
+// written by the audio thread once per block, read from any thread (eg a monitoring one) without locking:
+// the writer bumps a sequence counter to odd before updating and back to even after, and readers retry
+// a snapshot that straddled an update. every field is a relaxed atomic, so a torn read is merely retried.
+// resets are requested by readers and carried out by the writer at the next block.
+
+#include <stdint.h>
+#include <string.h>
+#include <atomic>
+#include <chrono>
+#include "CVSTHost.h"
+
+inline uint64_t statsNow() {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+class PluginStats {
+    std::atomic<uint32_t> sequence{ 0 };
+    std::atomic<bool> resetRequested{ false };
+
+    std::atomic<uint64_t> blocks{ 0 };
+    std::atomic<uint64_t> lastNanos{ 0 }, totalNanos{ 0 }, maxNanos{ 0 };
+    std::atomic<uint64_t> lastEventNanos{ 0 }, maxEventNanos{ 0 };
+    std::atomic<double> lastLoad{ 0.0 }, maxLoad{ 0.0 }, totalLoad{ 0.0 };
+    std::atomic<uint64_t> overruns{ 0 };
+    std::atomic<uint64_t> histogram[CVST_STATS_HISTOGRAM_BUCKETS];
+
+    // only touched by the writer
+    uint64_t blockEventNanos = 0;
+
+    template <typename T>
+    static inline void bump(std::atomic<T> &field, T amount) {
+        field.store(field.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+
+    template <typename T>
+    static inline void raise(std::atomic<T> &field, T value) {
+        if (value > field.load(std::memory_order_relaxed)) {
+            field.store(value, std::memory_order_relaxed);
+        }
+    }
+
+    // bucket 0: under 1us, bucket i: [2^(i-1), 2^i) us, the last one is open-ended
+    static inline int bucketOf(uint64_t nanos) {
+        auto micros = nanos / 1000;
+        int bucket = 0;
+        while (micros && bucket < CVST_STATS_HISTOGRAM_BUCKETS - 1) {
+            micros >>= 1;
+            bucket++;
+        }
+        return bucket;
+    }
+
+    void clear() {
+        blocks.store(0, std::memory_order_relaxed);
+        lastNanos.store(0, std::memory_order_relaxed);
+        totalNanos.store(0, std::memory_order_relaxed);
+        maxNanos.store(0, std::memory_order_relaxed);
+        lastEventNanos.store(0, std::memory_order_relaxed);
+        maxEventNanos.store(0, std::memory_order_relaxed);
+        lastLoad.store(0.0, std::memory_order_relaxed);
+        maxLoad.store(0.0, std::memory_order_relaxed);
+        totalLoad.store(0.0, std::memory_order_relaxed);
+        overruns.store(0, std::memory_order_relaxed);
+        for (auto &bucket : histogram) {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+    }
+
+public:
+    std::atomic<double> budget{ 1.0 }; // fraction of the block deadline a block may take before it counts as an overrun
+
+    PluginStats() {
+        for (auto &bucket : histogram) {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    // writer (audio thread): event dispatch time is accumulated over the block's sub-blocks
+    inline void addEventTime(uint64_t nanos) {
+        blockEventNanos += nanos;
+    }
+
+    void recordBlock(uint64_t nanos, unsigned int sampleFrames, float sampleRate) {
+        auto deadlineNanos = sampleFrames * 1e9 / sampleRate;
+        auto load = deadlineNanos > 0.0 ? nanos / deadlineNanos : 0.0;
+        auto eventNanos = blockEventNanos;
+        blockEventNanos = 0;
+
+        auto seq = sequence.load(std::memory_order_relaxed);
+        sequence.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        if (resetRequested.exchange(false, std::memory_order_relaxed)) {
+            clear();
+        }
+        bump(blocks, (uint64_t)1);
+        lastNanos.store(nanos, std::memory_order_relaxed);
+        bump(totalNanos, nanos);
+        raise(maxNanos, nanos);
+        lastEventNanos.store(eventNanos, std::memory_order_relaxed);
+        raise(maxEventNanos, eventNanos);
+        lastLoad.store(load, std::memory_order_relaxed);
+        bump(totalLoad, load);
+        raise(maxLoad, load);
+        if (load > budget.load(std::memory_order_relaxed)) {
+            bump(overruns, (uint64_t)1);
+        }
+        bump(histogram[bucketOf(nanos)], (uint64_t)1);
+
+        sequence.store(seq + 2, std::memory_order_release);
+    }
+
+    // readers (any thread)
+    void snapshot(CVST_Stats *stats) {
+        while (true) {
+            auto seq = sequence.load(std::memory_order_acquire);
+            if (seq & 1) {
+                continue;
+            }
+            auto n = blocks.load(std::memory_order_relaxed);
+            stats->blocks = n;
+            stats->lastTime = lastNanos.load(std::memory_order_relaxed) * 1e-3;
+            stats->avgTime = n ? totalNanos.load(std::memory_order_relaxed) * 1e-3 / n : 0.0;
+            stats->maxTime = maxNanos.load(std::memory_order_relaxed) * 1e-3;
+            stats->lastEventTime = lastEventNanos.load(std::memory_order_relaxed) * 1e-3;
+            stats->maxEventTime = maxEventNanos.load(std::memory_order_relaxed) * 1e-3;
+            stats->lastLoad = lastLoad.load(std::memory_order_relaxed);
+            stats->avgLoad = n ? totalLoad.load(std::memory_order_relaxed) / n : 0.0;
+            stats->maxLoad = maxLoad.load(std::memory_order_relaxed);
+            stats->overruns = overruns.load(std::memory_order_relaxed);
+            for (int i = 0; i < CVST_STATS_HISTOGRAM_BUCKETS; i++) {
+                stats->histogram[i] = histogram[i].load(std::memory_order_relaxed);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (sequence.load(std::memory_order_relaxed) == seq) {
+                return;
+            }
+        }
+    }
+
+    inline void reset() {
+        resetRequested.store(true, std::memory_order_relaxed);
+    }
+};
+
+#endif // __CVSTHOST_STATS_H__
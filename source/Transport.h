@@ -0,0 +1,127 @@
+#ifndef __CVSTHOST_TRANSPORT_H__
+#define __CVSTHOST_TRANSPORT_H__
+
+// (internal) per-plugin host transport, and the VstTimeInfo handed out for audioMasterGetTime
+//
+// some plugins ask for the time dozens of times per block, so there is one VstTimeInfo snapshot per (sub-)block:
+// the first request fills the basics plus whatever fields its filter mask asks for, later requests only compute
+// fields that haven't been yet -- usually none, so it's just a pointer return.
+
+#include <math.h>
+#include <string.h>
+#include "../deps/VST2_SDK/pluginterfaces/vst2.x/aeffectx.h"
+#include "CVSTHost.h"
+
+#define MIDI_CLOCKS_PER_QUARTER 24
+
+class Transport {
+    CVST_Transport state; // at the start of the current block
+    bool changed = true;  // play/record/loop state changed since the last block
+
+    VstTimeInfo timeInfo;
+    bool stale = true;
+    unsigned int snapshotOffset = 0; // (sub-)block start, relative to the block
+    int rateFactor = 1; // plugin samples per host frame (oversampling) -- positions and rates are reported in the former
+
+    inline double quartersPerSample(double sampleRate) const {
+        return state.tempo / (60.0 * sampleRate);
+    }
+
+public:
+    Transport() {
+        state.samplePos = 0.0;
+        state.ppqPos = 0.0;
+        state.tempo = 120.0;
+        state.timeSigNumerator = 4;
+        state.timeSigDenominator = 4;
+        state.playing = false;
+        state.recording = false;
+        state.looping = false;
+        state.loopStartPpq = 0.0;
+        state.loopEndPpq = 0.0;
+        memset(&timeInfo, 0, sizeof(timeInfo));
+    }
+
+    void set(const CVST_Transport &transport) {
+        changed = changed || transport.playing != state.playing || transport.recording != state.recording || transport.looping != state.looping;
+        state = transport;
+        stale = true;
+    }
+
+    inline const CVST_Transport &get() const { return state; }
+
+    inline void setRateFactor(int factor) {
+        rateFactor = factor;
+        stale = true;
+    }
+
+    // a new (sub-)block starts at 'offset' frames into the current block
+    inline void invalidate(unsigned int offset) {
+        snapshotOffset = offset;
+        stale = true;
+    }
+
+    // the current snapshot, first filling in the 'filter' fields (kVst*Valid) it doesn't have yet
+    VstTimeInfo *getTimeInfo(VstInt32 filter, double sampleRate) {
+        auto offset = state.playing ? (double)snapshotOffset : 0.0;
+        if (stale) {
+            timeInfo.samplePos = (state.samplePos + offset) * rateFactor;
+            timeInfo.sampleRate = sampleRate * rateFactor;
+            timeInfo.flags = (changed ? kVstTransportChanged : 0) |
+                (state.playing ? kVstTransportPlaying : 0) |
+                (state.recording ? kVstTransportRecording : 0) |
+                (state.looping ? kVstTransportCycleActive : 0);
+            stale = false;
+        }
+        auto wanted = filter & (kVstPpqPosValid | kVstTempoValid | kVstBarsValid | kVstCyclePosValid | kVstTimeSigValid | kVstClockValid) & ~timeInfo.flags;
+        if (!wanted) {
+            return &timeInfo;
+        }
+        auto ppqPos = state.ppqPos + offset * quartersPerSample(sampleRate);
+        if (wanted & kVstPpqPosValid) {
+            timeInfo.ppqPos = ppqPos;
+        }
+        if (wanted & kVstTempoValid) {
+            timeInfo.tempo = state.tempo;
+        }
+        if (wanted & kVstBarsValid) {
+            // (assumes the time signature hasn't changed since the start of the song)
+            auto barLength = state.timeSigNumerator * 4.0 / state.timeSigDenominator;
+            timeInfo.barStartPos = floor(ppqPos / barLength) * barLength;
+        }
+        if (wanted & kVstCyclePosValid) {
+            timeInfo.cycleStartPos = state.loopStartPpq;
+            timeInfo.cycleEndPos = state.loopEndPpq;
+        }
+        if (wanted & kVstTimeSigValid) {
+            timeInfo.timeSigNumerator = state.timeSigNumerator;
+            timeInfo.timeSigDenominator = state.timeSigDenominator;
+        }
+        if (wanted & kVstClockValid) {
+            auto clocks = ppqPos * MIDI_CLOCKS_PER_QUARTER;
+            timeInfo.samplesToNextClock = (VstInt32)((ceil(clocks) - clocks) / MIDI_CLOCKS_PER_QUARTER / quartersPerSample(sampleRate) * rateFactor + 0.5);
+        }
+        timeInfo.flags |= wanted;
+        return &timeInfo;
+    }
+
+    inline VstTimeInfo *getLastTimeInfo() { return &timeInfo; }
+
+    // after each block; the loop wraps at block boundaries only
+    void advance(unsigned int sampleFrames, double sampleRate) {
+        if (state.playing) {
+            state.samplePos += sampleFrames;
+            state.ppqPos += sampleFrames * quartersPerSample(sampleRate);
+            auto loopLength = state.loopEndPpq - state.loopStartPpq;
+            if (state.looping && loopLength > 0.0 && state.ppqPos >= state.loopEndPpq) {
+                auto wraps = floor((state.ppqPos - state.loopStartPpq) / loopLength);
+                state.ppqPos -= wraps * loopLength;
+                state.samplePos -= wraps * loopLength / quartersPerSample(sampleRate);
+            }
+        }
+        changed = false;
+        invalidate(0);
+    }
+};
+
+#endif // __CVSTHOST_TRANSPORT_H__
@@ -0,0 +1,283 @@
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE // pthread_setaffinity_np
+#endif
+#include "../Platform.h"
+
+#include <dlfcn.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <spawn.h>
+#include <stdio.h>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#endif
+
+extern char **environ;
+
+PlatformLibrary platformLoadLibrary(const char *utf8Path)
+{
+    // RTLD_LOCAL so that plugins built from the same framework don't resolve each other's symbols
+    return (PlatformLibrary)dlopen(utf8Path, RTLD_NOW | RTLD_LOCAL);
+}
+
+void *platformGetSymbol(PlatformLibrary library, const char *name)
+{
+    return dlsym(library, name);
+}
+
+void platformFreeLibrary(PlatformLibrary library)
+{
+    dlclose(library);
+}
+
+const char *platformLastError()
+{
+    auto error = dlerror();
+    return error ? error : "(no error)";
+}
+
+void platformPinCurrentThread(int cpu)
+{
+#ifdef __linux__
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    CPU_SET(cpu, &cpuSet);
+    pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet);
+#else
+    (void)cpu; // eg macOS has no hard affinity, only hints
+#endif
+}
+
+bool platformFileStat(const char *utf8Path, uint64_t *size, int64_t *modifiedTime)
+{
+    struct stat info;
+    if (stat(utf8Path, &info) != 0) {
+        return false;
+    }
+    *size = (uint64_t)info.st_size;
+#ifdef __APPLE__
+    *modifiedTime = (int64_t)info.st_mtimespec.tv_sec * 1000000000 + info.st_mtimespec.tv_nsec;
+#else
+    *modifiedTime = (int64_t)info.st_mtim.tv_sec * 1000000000 + info.st_mtim.tv_nsec;
+#endif
+    return true;
+}
+
+FILE *platformOpenFile(const char *utf8Path, const char *mode)
+{
+    return fopen(utf8Path, mode);
+}
+
+bool platformReplaceFile(const char *fromPath, const char *toPath)
+{
+    return rename(fromPath, toPath) == 0;
+}
+
+bool platformMapFile(const char *utf8Path, PlatformMappedFile *mapped)
+{
+    auto fd = open(utf8Path, O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size == 0) {
+        close(fd);
+        return false;
+    }
+    auto data = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd); // the mapping keeps the file referenced
+    if (data == MAP_FAILED) {
+        return false;
+    }
+    mapped->data = data;
+    mapped->size = (size_t)info.st_size;
+    mapped->handle = nullptr;
+    return true;
+}
+
+void platformUnmapFile(PlatformMappedFile *mapped)
+{
+    if (mapped->data) {
+        munmap((void *)mapped->data, mapped->size);
+    }
+    mapped->data = nullptr;
+    mapped->size = 0;
+}
+
+static bool mapSharedMemory(int fd, size_t size, PlatformSharedMemory *shm)
+{
+    auto data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        return false;
+    }
+    shm->data = data;
+    shm->size = size;
+    shm->handle = nullptr;
+    return true;
+}
+
+bool platformCreateSharedMemory(const char *name, size_t size, PlatformSharedMemory *shm)
+{
+    auto path = std::string("/") + name;
+    auto fd = shm_open(path.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd < 0) {
+        return false;
+    }
+    if (ftruncate(fd, (off_t)size) != 0) {
+        close(fd);
+        shm_unlink(path.c_str());
+        return false;
+    }
+    if (!mapSharedMemory(fd, size, shm)) {
+        shm_unlink(path.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool platformOpenSharedMemory(const char *name, size_t size, PlatformSharedMemory *shm)
+{
+    auto fd = shm_open((std::string("/") + name).c_str(), O_RDWR, 0600);
+    return fd >= 0 && mapSharedMemory(fd, size, shm);
+}
+
+void platformCloseSharedMemory(PlatformSharedMemory *shm)
+{
+    if (shm->data) {
+        munmap(shm->data, shm->size);
+    }
+    shm->data = nullptr;
+    shm->size = 0;
+}
+
+void platformUnlinkSharedMemory(const char *name)
+{
+    shm_unlink((std::string("/") + name).c_str());
+}
+
+#ifdef __linux__
+// (not FUTEX_PRIVATE_FLAG -- the word is shared between processes)
+void platformWaitWord(std::atomic<uint32_t> *word, uint32_t expected, int timeoutMs)
+{
+    struct timespec timeout;
+    timeout.tv_sec = timeoutMs / 1000;
+    timeout.tv_nsec = (long)(timeoutMs % 1000) * 1000000;
+    syscall(SYS_futex, (uint32_t *)word, FUTEX_WAIT, expected, &timeout, nullptr, 0);
+}
+
+void platformWakeWord(std::atomic<uint32_t> *word)
+{
+    syscall(SYS_futex, (uint32_t *)word, FUTEX_WAKE, INT32_MAX, nullptr, nullptr, 0);
+}
+#else
+// no portable cross-process futex elsewhere -- poll, backing off to short sleeps
+void platformWaitWord(std::atomic<uint32_t> *word, uint32_t expected, int timeoutMs)
+{
+    struct timespec start, now;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    while (word->load(std::memory_order_acquire) == expected) {
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        if ((now.tv_sec - start.tv_sec) * 1000 + (now.tv_nsec - start.tv_nsec) / 1000000 >= timeoutMs) {
+            return;
+        }
+        usleep(20);
+    }
+}
+
+void platformWakeWord(std::atomic<uint32_t> *)
+{
+}
+#endif
+
+// a process handle: spawned ones are our children, and once reaped their pid may be reused by anything -- so it's never
+// signalled or even looked up again (until reaped, the zombie keeps it from being reused, so signalling is safe)
+namespace {
+    struct ProcessHandle {
+        pid_t pid;
+        bool child;
+        std::atomic<bool> reaped{ false };
+    };
+}
+
+PlatformProcess platformSpawnProcess(const char *utf8Path, const char *const *args)
+{
+    std::vector<char *> argv;
+    argv.push_back((char *)utf8Path);
+    for (auto arg = args; *arg; arg++) {
+        argv.push_back((char *)*arg);
+    }
+    argv.push_back(nullptr);
+    pid_t pid;
+    if (posix_spawn(&pid, utf8Path, nullptr, nullptr, argv.data(), environ) != 0) {
+        return 0;
+    }
+    auto handle = new ProcessHandle;
+    handle->pid = pid;
+    handle->child = true;
+    return (PlatformProcess)handle;
+}
+
+PlatformProcess platformOpenProcess(int pid)
+{
+    auto handle = new ProcessHandle;
+    handle->pid = (pid_t)pid;
+    handle->child = false;
+    return (PlatformProcess)handle;
+}
+
+int platformCurrentProcessId()
+{
+    return (int)getpid();
+}
+
+bool platformProcessRunning(PlatformProcess process)
+{
+    auto handle = (ProcessHandle *)process;
+    if (!handle->child) {
+        // (only watched: the best there is without being its parent)
+        return kill(handle->pid, 0) == 0 || errno == EPERM;
+    }
+    if (handle->reaped.load(std::memory_order_acquire)) {
+        return false;
+    }
+    int status;
+    pid_t result;
+    do {
+        result = waitpid(handle->pid, &status, WNOHANG);
+    } while (result == -1 && errno == EINTR);
+    if (result == 0) {
+        return true;
+    }
+    // exited and reaped now -- or (-1) reaped by another thread's call a moment ago: gone either way
+    handle->reaped.store(true, std::memory_order_release);
+    return false;
+}
+
+void platformEndProcess(PlatformProcess process, int timeoutMs)
+{
+    auto handle = (ProcessHandle *)process;
+    for (int waited = 0; waited < timeoutMs; waited++) {
+        if (!platformProcessRunning(process)) {
+            break;
+        }
+        usleep(1000);
+    }
+    // a child we haven't reaped is still ours to kill (not running any more just means it's a zombie until waited for)
+    if (handle->child && !handle->reaped.load(std::memory_order_acquire)) {
+        kill(handle->pid, SIGKILL);
+        waitpid(handle->pid, nullptr, 0);
+    }
+    delete handle;
+}
@@ -0,0 +1,207 @@
+#include "../../build/msvc/2019/header.h"
+#include "../Platform.h"
+
+#include <stdio.h>
+#include <string>
+#include "unicodestuff.h"
+
+PlatformLibrary platformLoadLibrary(const char *utf8Path)
+{
+    auto widePath = utf8_to_wstring(utf8Path);
+    return (PlatformLibrary)LoadLibraryW(widePath.c_str());
+}
+
+void *platformGetSymbol(PlatformLibrary library, const char *name)
+{
+    return (void *)GetProcAddress((HMODULE)library, name);
+}
+
+void platformFreeLibrary(PlatformLibrary library)
+{
+    FreeLibrary((HMODULE)library);
+}
+
+const char *platformLastError()
+{
+    static thread_local char errorBuffer[64];
+    snprintf(errorBuffer, sizeof(errorBuffer), "win32 error %lu", GetLastError());
+    return errorBuffer;
+}
+
+void platformPinCurrentThread(int cpu)
+{
+    SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)1 << cpu);
+}
+
+bool platformFileStat(const char *utf8Path, uint64_t *size, int64_t *modifiedTime)
+{
+    WIN32_FILE_ATTRIBUTE_DATA info;
+    if (!GetFileAttributesExW(utf8_to_wstring(utf8Path).c_str(), GetFileExInfoStandard, &info)) {
+        return false;
+    }
+    *size = ((uint64_t)info.nFileSizeHigh << 32) | info.nFileSizeLow;
+    *modifiedTime = (int64_t)(((uint64_t)info.ftLastWriteTime.dwHighDateTime << 32) | info.ftLastWriteTime.dwLowDateTime);
+    return true;
+}
+
+FILE *platformOpenFile(const char *utf8Path, const char *mode)
+{
+    return _wfopen(utf8_to_wstring(utf8Path).c_str(), utf8_to_wstring(mode).c_str());
+}
+
+bool platformReplaceFile(const char *fromPath, const char *toPath)
+{
+    return MoveFileExW(utf8_to_wstring(fromPath).c_str(), utf8_to_wstring(toPath).c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+}
+
+bool platformMapFile(const char *utf8Path, PlatformMappedFile *mapped)
+{
+    auto file = CreateFileW(utf8_to_wstring(utf8Path).c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+        CloseHandle(file);
+        return false;
+    }
+    auto mapping = CreateFileMappingW(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(file); // the mapping keeps the file referenced
+    if (!mapping) {
+        return false;
+    }
+    auto data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!data) {
+        CloseHandle(mapping);
+        return false;
+    }
+    mapped->data = data;
+    mapped->size = (size_t)size.QuadPart;
+    mapped->handle = mapping;
+    return true;
+}
+
+void platformUnmapFile(PlatformMappedFile *mapped)
+{
+    if (mapped->data) {
+        UnmapViewOfFile(mapped->data);
+        CloseHandle((HANDLE)mapped->handle);
+    }
+    mapped->data = nullptr;
+    mapped->size = 0;
+    mapped->handle = nullptr;
+}
+
+static std::wstring sharedMemoryName(const char *name)
+{
+    return L"Local\\" + utf8_to_wstring(name);
+}
+
+static bool mapSharedMemory(HANDLE mapping, size_t size, PlatformSharedMemory *shm)
+{
+    auto data = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, size);
+    if (!data) {
+        CloseHandle(mapping);
+        return false;
+    }
+    shm->data = data;
+    shm->size = size;
+    shm->handle = mapping;
+    return true;
+}
+
+bool platformCreateSharedMemory(const char *name, size_t size, PlatformSharedMemory *shm)
+{
+    auto mapping = CreateFileMappingW(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, (DWORD)((uint64_t)size >> 32), (DWORD)size, sharedMemoryName(name).c_str());
+    if (!mapping) {
+        return false;
+    }
+    if (GetLastError() == ERROR_ALREADY_EXISTS) {
+        CloseHandle(mapping);
+        return false;
+    }
+    return mapSharedMemory(mapping, size, shm);
+}
+
+bool platformOpenSharedMemory(const char *name, size_t size, PlatformSharedMemory *shm)
+{
+    auto mapping = OpenFileMappingW(FILE_MAP_ALL_ACCESS, FALSE, sharedMemoryName(name).c_str());
+    return mapping && mapSharedMemory(mapping, size, shm);
+}
+
+void platformCloseSharedMemory(PlatformSharedMemory *shm)
+{
+    if (shm->data) {
+        UnmapViewOfFile(shm->data);
+        CloseHandle((HANDLE)shm->handle);
+    }
+    shm->data = nullptr;
+    shm->size = 0;
+    shm->handle = nullptr;
+}
+
+void platformUnlinkSharedMemory(const char *)
+{
+    // named mappings go away with their last handle
+}
+
+// WaitOnAddress is process-local -- poll, backing off from yielding to short sleeps
+void platformWaitWord(std::atomic<uint32_t> *word, uint32_t expected, int timeoutMs)
+{
+    auto start = GetTickCount64();
+    for (int spins = 0; word->load(std::memory_order_acquire) == expected; spins++) {
+        if (GetTickCount64() - start >= (ULONGLONG)timeoutMs) {
+            return;
+        }
+        if (spins < 1000) {
+            SwitchToThread();
+        }
+        else {
+            Sleep(1);
+        }
+    }
+}
+
+void platformWakeWord(std::atomic<uint32_t> *)
+{
+}
+
+PlatformProcess platformSpawnProcess(const char *utf8Path, const char *const *args)
+{
+    auto commandLine = L"\"" + utf8_to_wstring(utf8Path) + L"\"";
+    for (auto arg = args; *arg; arg++) {
+        commandLine += L" \"" + utf8_to_wstring(*arg) + L"\""; // (none of our arguments contain quotes)
+    }
+    STARTUPINFOW startupInfo = {};
+    startupInfo.cb = sizeof(startupInfo);
+    PROCESS_INFORMATION processInfo;
+    if (!CreateProcessW(utf8_to_wstring(utf8Path).c_str(), &commandLine[0], NULL, NULL, FALSE, 0, NULL, NULL, &startupInfo, &processInfo)) {
+        return 0;
+    }
+    CloseHandle(processInfo.hThread);
+    return (PlatformProcess)processInfo.hProcess;
+}
+
+PlatformProcess platformOpenProcess(int pid)
+{
+    return (PlatformProcess)OpenProcess(SYNCHRONIZE | PROCESS_TERMINATE, FALSE, (DWORD)pid);
+}
+
+int platformCurrentProcessId()
+{
+    return (int)GetCurrentProcessId();
+}
+
+bool platformProcessRunning(PlatformProcess process)
+{
+    return WaitForSingleObject((HANDLE)process, 0) == WAIT_TIMEOUT;
+}
+
+void platformEndProcess(PlatformProcess process, int timeoutMs)
+{
+    if (WaitForSingleObject((HANDLE)process, (DWORD)timeoutMs) == WAIT_TIMEOUT) {
+        TerminateProcess((HANDLE)process, 1);
+        WaitForSingleObject((HANDLE)process, INFINITE);
+    }
+    CloseHandle((HANDLE)process);
+}
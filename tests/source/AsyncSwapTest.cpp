@@ -0,0 +1,115 @@
+// AsyncSwapTest.cpp : CVST_SetChunkAsync -- the new state comes in with a crossfade at a block boundary, the old instance
+// gets the block's MIDI and parameter changes while it fades out, the new instance is warmed up and then carries on,
+// and (where it can be seen) the extra reference to the library goes away with the old instance
+
+#include "TestCommon.h"
+
+#include <chrono>
+#include <thread>
+
+#define BLOCK_SIZE 256
+#define FADE_FRAMES (2 * BLOCK_SIZE)
+#define MARKER_AT 100
+#define SECOND_MARKER_AT 200
+
+// whether the plugin library is still loaded (linux only, elsewhere unknown: true)
+static bool libraryLoaded(const char *path)
+{
+#ifdef __linux__
+    auto maps = readFile("/proc/self/maps");
+    return maps.find(path) != std::string::npos;
+#else
+    (void)path;
+    return true;
+#endif
+}
+
+// one block of 1.0 on input 0, with notes at MARKER_AT and SECOND_MARKER_AT, and 'changes'
+static void processBlock(CVST_Plugin plugin, TestBuffers<> &outputs, const std::vector<CVST_ParameterChange> &changes = {})
+{
+    TestBuffers<> inputs(2, BLOCK_SIZE);
+    std::fill(inputs[0].begin(), inputs[0].end(), 1.0f);
+    CVST_MidiEvent notes[2];
+    notes[0].sampleOffs = MARKER_AT;
+    notes[1].sampleOffs = SECOND_MARKER_AT;
+    notes[0].data.uint32 = notes[1].data.uint32 = 0x00403C90;
+    CVST_SetBlockEvents(plugin, notes, 2);
+    if (!changes.empty()) {
+        CVST_SetBlockParameterChanges(plugin, changes.data(), (int)changes.size());
+    }
+    CVST_ProcessReplacing(plugin, inputs.view(0), outputs.view(0), BLOCK_SIZE);
+}
+
+int main()
+{
+    CVST_Init(testCallback);
+
+    // the state to load: half gain
+    std::vector<char> chunk;
+    {
+        auto source = loadStarted(PROBEPLUGIN_PATH, BLOCK_SIZE);
+        setParameter(source, kProbeGain, 0.5f);
+        void *data;
+        size_t size;
+        CVST_GetChunk(source, ChunkType_Program, &data, &size);
+        chunk.assign((char *)data, (char *)data + size);
+        CVST_Destroy(source);
+    }
+
+    auto plugin = loadStarted(PROBEPLUGIN_PATH, BLOCK_SIZE);
+    TestBuffers<> outputs(2, BLOCK_SIZE);
+    processBlock(plugin, outputs);
+    CHECK(outputs[0][BLOCK_SIZE - 1] == 1.0f);
+    CHECK(CVST_GetStateLoadStatus(plugin) == StateLoad_Idle);
+    CHECK(CVST_SetChunkAsync(plugin, ChunkType_Program, chunk.data(), chunk.size(), FADE_FRAMES));
+    CHECK(!CVST_SetChunkAsync(plugin, ChunkType_Program, chunk.data(), chunk.size(), FADE_FRAMES)); // (one at a time)
+
+    // the old state plays on until the new instance is ready, the first faded block is the swap
+    int waited = 0;
+    for (;; waited++) {
+        CHECK(waited < 1000);
+        processBlock(plugin, outputs);
+        CHECK(outputs[0][0] == 1.0f);
+        if (outputs[0][BLOCK_SIZE - 1] != 1.0f) {
+            break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    CHECK(CVST_GetStateLoadStatus(plugin) == StateLoad_Crossfading);
+    // old (1.0) to new (0.5), linearly -- and both instances marked both notes, on their frames
+    CHECK(outputs[0][BLOCK_SIZE / 2] == 1.0f - 0.5f * (BLOCK_SIZE / 2) / FADE_FRAMES);
+    CHECK((nonZero(outputs[1]) == std::vector<size_t>{ MARKER_AT, SECOND_MARKER_AT }));
+    CHECK(outputs[1][MARKER_AT] == 1.0f && outputs[1][SECOND_MARKER_AT] == 1.0f);
+
+    // a change in the fade's second block reaches both, so nothing of the old gain is left in the mix
+    CVST_ParameterChange change;
+    change.sampleOffs = 0;
+    change.index = kProbeGain;
+    change.value = 0.25f;
+    processBlock(plugin, outputs, { change });
+    CHECK(outputs[0][0] == 0.25f && outputs[0][BLOCK_SIZE - 1] == 0.25f);
+    CHECK(outputs[1][MARKER_AT] == 1.0f && outputs[1][SECOND_MARKER_AT] == 1.0f);
+
+    // the fade's over: the old instance is closed on the next poll, the new one carries on
+    processBlock(plugin, outputs);
+    CHECK(CVST_GetStateLoadStatus(plugin) == StateLoad_Done);
+    CHECK(outputs[0][BLOCK_SIZE - 1] == 0.25f);
+    CHECK(getParameter(plugin, kProbeGain) == 0.25f);
+    CHECK(getParameter(plugin, kProbeCalls) < 3 + waited + 4 + 1); // (the warmup's, and the blocks since the swap)
+    CHECK(getParameter(plugin, kProbeBlockSize) == BLOCK_SIZE);
+
+    // swapped while suspended: right away, on the next poll
+    CVST_Suspend(plugin);
+    CHECK(CVST_SetChunkAsync(plugin, ChunkType_Program, chunk.data(), chunk.size(), 0));
+    for (int i = 0; CVST_GetStateLoadStatus(plugin) != StateLoad_Done; i++) {
+        CHECK(i < 1000);
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    CHECK(getParameter(plugin, kProbeGain) == 0.5f);
+
+    CVST_Destroy(plugin);
+    CHECK(!libraryLoaded(PROBEPLUGIN_PATH));
+    CVST_Shutdown();
+    printf("ok\n");
+    return 0;
+}
@@ -0,0 +1,88 @@
+// AutomationTest.cpp : CVST_PollAutomation -- the plugin's automation is queued, not called out; repeated changes to
+// a parameter coalesce (last value wins, in the order parameters first changed), and however many changes come in
+// before a poll, there's at most one entry per parameter, left for the next poll if the caller takes fewer
+
+#include "TestCommon.h"
+
+#include <map>
+
+#define BLOCK_SIZE 256
+
+// one block with a control change per (parameter, value) pair, which the probe reports as automation
+static void automate(CVST_Plugin plugin, const std::vector<std::pair<int, int>> &changes)
+{
+    std::vector<CVST_MidiEvent> events(changes.size());
+    for (size_t i = 0; i < changes.size(); i++) {
+        events[i].sampleOffs = (unsigned long)i;
+        events[i].data.uint32 = 0xB0 | (changes[i].first << 8) | (changes[i].second << 16);
+    }
+    CVST_SetBlockEvents(plugin, events.data(), (int)events.size());
+    TestBuffers<> inputs(2, BLOCK_SIZE), outputs(2, BLOCK_SIZE);
+    CVST_ProcessReplacing(plugin, inputs.view(0), outputs.view(0), BLOCK_SIZE);
+}
+
+static std::vector<std::pair<int, float>> poll(CVST_Plugin plugin, int maxEvents)
+{
+    std::vector<CVST_AutomationEvent> events(maxEvents);
+    auto count = CVST_PollAutomation(plugin, events.data(), maxEvents);
+    CHECK(count >= 0 && count <= maxEvents);
+    std::vector<std::pair<int, float>> result;
+    for (int i = 0; i < count; i++) {
+        result.push_back(std::make_pair(events[i].index, events[i].value));
+    }
+    return result;
+}
+
+int main()
+{
+    CVST_Init(testCallback);
+    auto plugin = loadStarted(PROBEPLUGIN_PATH, BLOCK_SIZE);
+    poll(plugin, 64); // (whatever loading turned up)
+
+    // coalesced within a block: one entry per parameter, last value, first-changed order; out-of-range indices dropped
+    automate(plugin, { { kProbeTail, 10 }, { kProbeLastFrames, 20 }, { kProbeTail, 30 }, { 100, 1 }, { kProbeMaxFrames, 40 }, { kProbeLastFrames, 50 } });
+    CHECK((poll(plugin, 16) == std::vector<std::pair<int, float>>{
+        { kProbeTail, 30 / 127.0f }, { kProbeLastFrames, 50 / 127.0f }, { kProbeMaxFrames, 40 / 127.0f } }));
+    CHECK(poll(plugin, 16).empty());
+
+    // and across blocks, until the next poll -- after which a change is queued afresh
+    automate(plugin, { { kProbeTail, 1 } });
+    automate(plugin, { { kProbeTail, 2 }, { kProbeEvents, 3 } });
+    CHECK((poll(plugin, 16) == std::vector<std::pair<int, float>>{ { kProbeTail, 2 / 127.0f }, { kProbeEvents, 3 / 127.0f } }));
+    automate(plugin, { { kProbeTail, 4 } });
+    CHECK((poll(plugin, 16) == std::vector<std::pair<int, float>>{ { kProbeTail, 4 / 127.0f } }));
+
+    // every parameter, many times over: never more than one entry each, taken a few at a time
+    for (int round = 0; round < 4; round++) {
+        std::vector<std::pair<int, int>> changes;
+        for (int value = 1; value <= 3; value++) {
+            for (int index = 0; index < kNumProbeParams; index++) {
+                changes.push_back(std::make_pair(index, round * 10 + value));
+            }
+        }
+        automate(plugin, changes);
+    }
+    {
+        std::map<int, float> latest;
+        for (auto batch = poll(plugin, 5); !batch.empty(); batch = poll(plugin, 5)) {
+            for (auto &change : batch) {
+                CHECK(latest.count(change.first) == 0);
+                latest[change.first] = change.second;
+            }
+        }
+        CHECK((int)latest.size() == kNumProbeParams);
+        for (auto &change : latest) {
+            CHECK(change.second == 33 / 127.0f);
+        }
+    }
+
+    // what's pending when the host state is reset is gone
+    automate(plugin, { { kProbeTail, 5 } });
+    CVST_ResetHostState(plugin);
+    CHECK(poll(plugin, 16).empty());
+
+    CVST_Destroy(plugin);
+    CVST_Shutdown();
+    printf("ok\n");
+    return 0;
+}
@@ -0,0 +1,91 @@
+// BlockAdapterTest.cpp : CVST_SetBlockMode -- the plugin only sees blocks of the adapter's size (any size, not just powers
+// of two), fixed mode delays by exactly that (CVST_GetLatency), and parameter changes land on the caller's frames
+// whatever the order they were given in; changes over the limit are dropped, and said so
+
+#include "TestCommon.h"
+
+#define ADAPTER_SIZE 96
+#define CALLER_SIZE 100
+#define TOTAL_FRAMES 1000
+
+static CVST_ParameterChange gainChange(unsigned int sampleOffs, float value)
+{
+    CVST_ParameterChange change;
+    change.sampleOffs = sampleOffs;
+    change.index = kProbeGain;
+    change.value = value;
+    return change;
+}
+
+// runs a constant 1 through the plugin in caller blocks, with 'changes' per block; returns output 0
+static std::vector<float> runGain(CVST_Plugin plugin, const std::vector<std::vector<CVST_ParameterChange>> &changes)
+{
+    TestBuffers<> inputs(2, TOTAL_FRAMES), outputs(2, TOTAL_FRAMES);
+    std::fill(inputs[0].begin(), inputs[0].end(), 1.0f);
+    for (unsigned int offset = 0, block = 0; offset < TOTAL_FRAMES; offset += CALLER_SIZE, block++) {
+        if (block < changes.size()) {
+            CVST_SetBlockParameterChanges(plugin, changes[block].data(), (int)changes[block].size());
+        }
+        CVST_ProcessReplacing(plugin, inputs.view(offset), outputs.view(offset), CALLER_SIZE);
+    }
+    return outputs[0];
+}
+
+// frames [from, to) of 'output' are all 'value'
+static bool allOf(const std::vector<float> &output, size_t from, size_t to, float value)
+{
+    return std::all_of(output.begin() + from, output.begin() + to, [value](float x) { return x == value; });
+}
+
+int main()
+{
+    CVST_Init(testCallback);
+    auto plugin = loadStarted(PROBEPLUGIN_PATH, CALLER_SIZE);
+    setParameter(plugin, kProbeGain, 1.0f);
+    CVST_SetMinSubBlockLength(plugin, 1); // (every change exactly where it's due)
+
+    // maximum: caller blocks are cut down to size, no delay
+    CVST_Suspend(plugin);
+    CVST_SetBlockMode(plugin, BlockMode_Maximum, ADAPTER_SIZE);
+    CVST_Resume(plugin);
+    CHECK(CVST_GetLatency(plugin) == 0);
+    {
+        auto output = runGain(plugin, { { gainChange(50, 2.0f) } });
+        CHECK(getParameter(plugin, kProbeMaxFrames) == ADAPTER_SIZE);
+        CHECK(allOf(output, 0, 50, 1.0f) && allOf(output, 50, TOTAL_FRAMES, 2.0f));
+    }
+
+    // fixed: only whole adapter blocks, a block late -- changes given out of order (and ahead of time) still land on
+    // their frames, at the plugin's block boundaries or inside its blocks
+    setParameter(plugin, kProbeGain, 1.0f);
+    CVST_Suspend(plugin);
+    CVST_SetBlockMode(plugin, BlockMode_Fixed, ADAPTER_SIZE);
+    CVST_Resume(plugin);
+    CHECK(CVST_GetLatency(plugin) == ADAPTER_SIZE);
+    {
+        auto output = runGain(plugin, {
+            { gainChange(70, 4.0f), gainChange(30, 2.0f), gainChange(192, 8.0f) }, // (the last: two adapter blocks on)
+            { gainChange(10, 0.5f) }, // frame 110, before the 192 given earlier
+        });
+        CHECK(getParameter(plugin, kProbeMaxFrames) == ADAPTER_SIZE);
+        CHECK(getParameter(plugin, kProbeLastFrames) == ADAPTER_SIZE);
+        CHECK(allOf(output, 0, ADAPTER_SIZE, 0.0f)); // (the FIFO's initial silence)
+        CHECK(allOf(output, ADAPTER_SIZE, ADAPTER_SIZE + 30, 1.0f));
+        CHECK(allOf(output, ADAPTER_SIZE + 30, ADAPTER_SIZE + 70, 2.0f));
+        CHECK(allOf(output, ADAPTER_SIZE + 70, ADAPTER_SIZE + 110, 4.0f));
+        CHECK(allOf(output, ADAPTER_SIZE + 110, ADAPTER_SIZE + 192, 0.5f));
+        CHECK(allOf(output, ADAPTER_SIZE + 192, TOTAL_FRAMES, 8.0f));
+    }
+
+    // more than can be pending: the first ones are kept, the rest reported
+    takeLogged("");
+    std::vector<CVST_ParameterChange> many(1100, gainChange(10, 1.0f));
+    CVST_SetBlockParameterChanges(plugin, many.data(), (int)many.size());
+    CHECK(takeLogged("dropped 76"));
+
+    CVST_Suspend(plugin);
+    CVST_Destroy(plugin);
+    CVST_Shutdown();
+    printf("ok\n");
+    return 0;
+}
@@ -0,0 +1,150 @@
+// BridgeTest.cpp : CVST_LoadPluginBridged -- audio, MIDI timing and sample-accurate parameter changes (queued, several
+// to a process request) make it across the process boundary, parameters can be set from another thread while processing, a plugin with more channels than
+// cross still processes the ones that do, and a crashing plugin only silences itself
+
+#include "TestCommon.h"
+
+#include <atomic>
+#include <thread>
+
+#define BLOCK_SIZE 256
+#define NUM_BLOCKS 100
+
+static CVST_Plugin loadBridged(const char *path)
+{
+    auto plugin = CVST_LoadPluginBridged(path, nullptr);
+    CHECK(plugin != nullptr);
+    CVST_Start(plugin, 44100.0f);
+    CVST_SetBlockSize(plugin, BLOCK_SIZE);
+    CVST_Resume(plugin);
+    return plugin;
+}
+
+int main()
+{
+    CVST_Init(testCallback);
+    CVST_SetBridgePath(CVSTBRIDGE_PATH);
+    auto plugin = loadBridged(PROBEPLUGIN_PATH);
+
+    // set from here (not a processing thread), applied before the next block
+    setParameter(plugin, kProbeGain, 0.5f);
+    setParameter(plugin, kProbeDelay, 0.01f);
+    CHECK(getParameter(plugin, kProbeGain) == 0.5f);
+    CHECK(CVST_GetLatency(plugin) == 10);
+    {
+        TestBuffers<> inputs(2, BLOCK_SIZE), outputs(2, BLOCK_SIZE);
+        inputs[0][20] = 1.0f;
+        CVST_MidiEvent events[2];
+        events[0].sampleOffs = 5;
+        events[1].sampleOffs = 200;
+        events[0].data.uint32 = events[1].data.uint32 = 0x00403C90;
+        CVST_SetBlockEvents(plugin, events, 2);
+        CVST_ProcessReplacing(plugin, inputs.view(0), outputs.view(0), BLOCK_SIZE);
+        CHECK(nonZero(outputs[0]) == std::vector<size_t>{ 30 });
+        CHECK(outputs[0][30] == 0.5f);
+        CHECK((nonZero(outputs[1]) == std::vector<size_t>{ 5, 200 }));
+    }
+    setParameter(plugin, kProbeDelay, 0.0f);
+
+    // sample-accurate changes, from the processing thread
+    {
+        TestBuffers<> inputs(2, BLOCK_SIZE), outputs(2, BLOCK_SIZE);
+        std::fill(inputs[0].begin(), inputs[0].end(), 1.0f);
+        CVST_ParameterChange change;
+        change.sampleOffs = 100;
+        change.index = kProbeGain;
+        change.value = 0.25f;
+        CVST_SetBlockParameterChanges(plugin, &change, 1);
+        CVST_ProcessReplacing(plugin, inputs.view(0), outputs.view(0), BLOCK_SIZE);
+        CHECK(outputs[0][99] == 0.5f && outputs[0][100] == 0.25f && outputs[0][BLOCK_SIZE - 1] == 0.25f);
+    }
+
+    // several changes for one sub-block (queued to go with its process request, in order), and more than fit in a queue
+    {
+        TestBuffers<> inputs(2, BLOCK_SIZE), outputs(2, BLOCK_SIZE);
+        std::fill(inputs[0].begin(), inputs[0].end(), 1.0f);
+        CVST_ParameterChange changes[4];
+        const float values[4] = { 0.1f, 0.2f, 0.3f, 0.75f };
+        for (int i = 0; i < 4; i++) {
+            changes[i].sampleOffs = i < 3 ? 100 : 110; // (the last one is merged into the same sub-block)
+            changes[i].index = kProbeGain;
+            changes[i].value = values[i];
+        }
+        CVST_SetBlockParameterChanges(plugin, changes, 4);
+        CVST_ProcessReplacing(plugin, inputs.view(0), outputs.view(0), BLOCK_SIZE);
+        CHECK(outputs[0][99] == 0.25f && outputs[0][100] == 0.75f && outputs[0][BLOCK_SIZE - 1] == 0.75f);
+
+        for (int i = 0; i <= 3000; i++) {
+            setParameter(plugin, kProbeGain, i / 1000.0f);
+        }
+        CVST_ProcessReplacing(plugin, inputs.view(0), outputs.view(0), BLOCK_SIZE);
+        CHECK(outputs[0][0] == 3.0f);
+        setParameter(plugin, kProbeGain, 0.125f);
+        CHECK(getParameter(plugin, kProbeGain) == 0.125f); // (what's queued goes ahead of anything else from this thread)
+        setParameter(plugin, kProbeGain, 0.5f);
+    }
+
+    // another thread setting parameters throughout (over the control channel) holds nothing up
+    {
+        std::atomic<bool> done{ false };
+        std::thread setter([&]() {
+            for (int i = 0; !done; i++) {
+                setParameter(plugin, kProbeGain, (i % 2) ? 1.0f : 0.5f);
+            }
+        });
+        auto calls = getParameter(plugin, kProbeCalls);
+        TestBuffers<> inputs(2, BLOCK_SIZE), outputs(2, BLOCK_SIZE);
+        std::fill(inputs[0].begin(), inputs[0].end(), 1.0f);
+        for (int block = 0; block < NUM_BLOCKS; block++) {
+            CVST_ProcessReplacing(plugin, inputs.view(0), outputs.view(0), BLOCK_SIZE);
+            CHECK(outputs[0][0] == 0.5f || outputs[0][0] == 1.0f);
+        }
+        done = true;
+        setter.join();
+        CHECK(getParameter(plugin, kProbeCalls) == calls + NUM_BLOCKS);
+    }
+    setParameter(plugin, kProbeGain, 1.0f);
+
+    // 40 channels each way: the first 32 cross (and are processed), the rest are silent
+    setParameter(plugin, kProbeWide, 1.0f);
+    CVST_Suspend(plugin);
+    CVST_Resume(plugin);
+    {
+        CVST_PluginInfo info;
+        CVST_GetPluginInfo(plugin, &info);
+        CHECK(info.numInputs == 40 && info.numOutputs == 40);
+        TestBuffers<> inputs(40, BLOCK_SIZE), outputs(40, BLOCK_SIZE);
+        for (auto &channel : outputs.channels) {
+            std::fill(channel.begin(), channel.end(), 9.0f); // (anything left over would show)
+        }
+        inputs[0][7] = 1.0f;
+        inputs[31][8] = 1.0f;
+        inputs[35][9] = 1.0f;
+        CVST_ProcessReplacing(plugin, inputs.view(0), outputs.view(0), BLOCK_SIZE);
+        CHECK(nonZero(outputs[0]) == std::vector<size_t>{ 7 });
+        CHECK(nonZero(outputs[1]).empty());
+        CHECK(nonZero(outputs[31]) == std::vector<size_t>{ 8 });
+        CHECK(nonZero(outputs[35]).empty());
+    }
+    CVST_Suspend(plugin);
+    CVST_Destroy(plugin);
+
+    // a plugin that dies (here, when it's opened) leaves a silent stand-in
+    plugin = CVST_LoadPluginBridged(CRASHPLUGIN_PATH, nullptr);
+    CHECK(plugin != nullptr);
+    CVST_Start(plugin, 44100.0f);
+    CHECK(!CVST_IsAlive(plugin));
+    CHECK(takeLogged("died"));
+    {
+        TestBuffers<> inputs(2, BLOCK_SIZE), outputs(2, BLOCK_SIZE);
+        std::fill(inputs[0].begin(), inputs[0].end(), 1.0f);
+        std::fill(outputs[0].begin(), outputs[0].end(), 9.0f);
+        CVST_ProcessReplacing(plugin, inputs.view(0), outputs.view(0), BLOCK_SIZE);
+        CHECK(nonZero(outputs[0]).empty());
+    }
+    CVST_Destroy(plugin);
+
+    CVST_Shutdown();
+    printf("ok\n");
+    return 0;
+}
@@ -0,0 +1,47 @@
+// CrashPlugin.cpp : a plugin that crashes as soon as it's opened -- for the tests of what survives that (bridged loads)
+
+#include <stdlib.h>
+#include <string.h>
+#include "../../deps/VST2_SDK/pluginterfaces/vst2.x/aeffectx.h"
+
+#ifdef _WIN32
+#define PLUGIN_EXPORT extern "C" __declspec(dllexport)
+#else
+#define PLUGIN_EXPORT extern "C" __attribute__((visibility("default")))
+#endif
+
+static VstIntPtr VSTCALLBACK dispatcherProc(AEffect*, VstInt32 opcode, VstInt32, VstIntPtr, void*, float)
+{
+    if (opcode == effOpen) {
+        abort();
+    }
+    return 0;
+}
+
+static void VSTCALLBACK processReplacingProc(AEffect*, float**, float**, VstInt32)
+{
+}
+
+static void VSTCALLBACK setParameterProc(AEffect*, VstInt32, float)
+{
+}
+
+static float VSTCALLBACK getParameterProc(AEffect*, VstInt32)
+{
+    return 0.0f;
+}
+
+PLUGIN_EXPORT AEffect *VSTPluginMain(audioMasterCallback)
+{
+    static AEffect effect;
+    memset(&effect, 0, sizeof(effect));
+    effect.magic = kEffectMagic;
+    effect.dispatcher = dispatcherProc;
+    effect.setParameter = setParameterProc;
+    effect.getParameter = getParameterProc;
+    effect.processReplacing = processReplacingProc;
+    effect.numInputs = 2;
+    effect.numOutputs = 2;
+    effect.flags = effFlagsCanReplacing;
+    return &effect;
+}
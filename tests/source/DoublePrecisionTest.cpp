@@ -0,0 +1,67 @@
+// DoublePrecisionTest.cpp : CVST_ProcessDoubleReplacing -- straight through to processDoubleReplacing once 64-bit
+// processing is on, and converted around processReplacing otherwise (a float-only plugin, or precision left at 32),
+// in chunks of the announced block size when the block is bigger
+
+#include "TestCommon.h"
+
+#define BLOCK_SIZE 64
+#define TOTAL_FRAMES 333 // (five chunks and a bit)
+
+int main()
+{
+    CVST_Init(testCallback);
+
+    // native: the plugin gets the doubles
+    auto plugin = loadStarted(PROBEPLUGIN_PATH, BLOCK_SIZE);
+    CVST_Properties props;
+    CVST_GetProperties(plugin, &props);
+    CHECK(props.canDoubleReplacing);
+    CHECK(CVST_SetProcessPrecision(plugin, ProcessPrecision_64));
+    {
+        TestBuffers<double> inputs(2, BLOCK_SIZE), outputs(2, BLOCK_SIZE);
+        inputs[0][10] = 0.25;
+        CVST_ProcessDoubleReplacing(plugin, inputs.view(0), outputs.view(0), BLOCK_SIZE);
+        CHECK(nonZero(outputs[0]) == std::vector<size_t>{ 10 });
+        CHECK(outputs[0][10] == 0.25);
+        CHECK(getParameter(plugin, kProbeDoubleCalls) == 1.0f && getParameter(plugin, kProbeCalls) == 1.0f);
+
+        // back at 32 bits: converted, even though the plugin could (with buffers allocated there and then, and said so)
+        CHECK(CVST_SetProcessPrecision(plugin, ProcessPrecision_32));
+        takeLogged("");
+        CVST_ProcessDoubleReplacing(plugin, inputs.view(0), outputs.view(0), BLOCK_SIZE);
+        CHECK(takeLogged("allocating them on the audio thread"));
+        CHECK(nonZero(outputs[0]) == std::vector<size_t>{ 10 });
+        CHECK(getParameter(plugin, kProbeDoubleCalls) == 1.0f && getParameter(plugin, kProbeCalls) == 2.0f);
+    }
+    CVST_Destroy(plugin);
+
+    // float-only: 64 bits is refused, and every block goes through float, in chunks of at most the block size
+    plugin = loadStarted(PROBEPLUGIN_PATH, BLOCK_SIZE);
+    setParameter(plugin, kProbeFloatOnly, 1.0f);
+    setParameter(plugin, kProbeDelay, 0.1f);
+    setParameter(plugin, kProbeGain, 0.5f);
+    CVST_GetProperties(plugin, &props);
+    CHECK(!props.canDoubleReplacing);
+    CHECK(!CVST_SetProcessPrecision(plugin, ProcessPrecision_64));
+    takeLogged("");
+    {
+        TestBuffers<double> inputs(2, TOTAL_FRAMES), outputs(2, TOTAL_FRAMES);
+        inputs[0][30] = inputs[0][150] = 0.1;
+        outputs[1][200] = 1.0; // (overwritten)
+        CVST_ProcessDoubleReplacing(plugin, inputs.view(0), outputs.view(0), TOTAL_FRAMES);
+        // (delayed across chunk boundaries, at float precision)
+        CHECK((nonZero(outputs[0]) == std::vector<size_t>{ 130, 250 }));
+        CHECK(outputs[0][130] == (double)(0.1f * 0.5f) && outputs[0][250] == (double)(0.1f * 0.5f));
+        CHECK(nonZero(outputs[1]).empty());
+        CHECK(getParameter(plugin, kProbeDoubleCalls) == 0.0f);
+        CHECK(getParameter(plugin, kProbeCalls) == 6.0f);
+        CHECK(getParameter(plugin, kProbeMaxFrames) == BLOCK_SIZE);
+        CHECK(getParameter(plugin, kProbeLastFrames) == TOTAL_FRAMES - 5 * BLOCK_SIZE);
+        CHECK(!takeLogged("allocating")); // (they were, when 64 bits was asked for)
+    }
+    CVST_Destroy(plugin);
+
+    CVST_Shutdown();
+    printf("ok\n");
+    return 0;
+}
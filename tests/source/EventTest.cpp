@@ -0,0 +1,73 @@
+// EventTest.cpp : MIDI timing -- several events in one block reach the plugin with deltaFrames from the start of the
+// process call they go with (VST2's definition), including when the block is split at parameter changes, and what the
+// plugin sends back comes out of CVST_GetOutputEvents on the frames it was sent for (also when oversampling)
+
+#include "TestCommon.h"
+
+#define BLOCK_SIZE 256
+
+// a note at each of 'offsets' (in that order), over one block of silence; returns the frames the probe marked (output 1)
+static std::vector<size_t> markers(CVST_Plugin plugin, const std::vector<unsigned long> &offsets,
+    const std::vector<CVST_ParameterChange> &changes = {})
+{
+    std::vector<CVST_MidiEvent> events(offsets.size());
+    for (size_t i = 0; i < offsets.size(); i++) {
+        events[i].sampleOffs = offsets[i];
+        events[i].data.uint32 = 0x00403C90;
+    }
+    CVST_SetBlockEvents(plugin, events.data(), (int)events.size());
+    if (!changes.empty()) {
+        CVST_SetBlockParameterChanges(plugin, changes.data(), (int)changes.size());
+    }
+    TestBuffers<> inputs(2, BLOCK_SIZE), outputs(2, BLOCK_SIZE);
+    CVST_ProcessReplacing(plugin, inputs.view(0), outputs.view(0), BLOCK_SIZE);
+    return nonZero(outputs[1]);
+}
+
+// the probe echoes what it gets: the offsets CVST_GetOutputEvents has for the last block
+static std::vector<size_t> echoed(CVST_Plugin plugin)
+{
+    int numEvents = 0;
+    auto events = CVST_GetOutputEvents(plugin, &numEvents);
+    std::vector<size_t> offsets;
+    for (int i = 0; i < numEvents; i++) {
+        offsets.push_back(events[i].sampleOffs);
+    }
+    return offsets;
+}
+
+int main()
+{
+    CVST_Init(testCallback);
+    auto plugin = loadStarted(PROBEPLUGIN_PATH, BLOCK_SIZE);
+
+    // several per block, some on the same frame
+    CHECK((markers(plugin, { 3, 17, 100, 100, 101, 255 }) == std::vector<size_t>{ 3, 17, 100, 101, 255 }));
+    CHECK(getParameter(plugin, kProbeEvents) == 6);
+    CHECK((echoed(plugin) == std::vector<size_t>{ 3, 17, 100, 100, 101, 255 }));
+    // (given out of order: sorted on the way in)
+    CHECK((markers(plugin, { 200, 10, 50 }) == std::vector<size_t>{ 10, 50, 200 }));
+
+    // split into three process calls at 64 and 160: each call's events are offset from its own start
+    CVST_SetMinSubBlockLength(plugin, 1);
+    CVST_ParameterChange changes[2];
+    changes[0].sampleOffs = 64;
+    changes[1].sampleOffs = 160;
+    changes[0].index = changes[1].index = kProbeGain;
+    changes[0].value = changes[1].value = 1.0f;
+    CHECK((markers(plugin, { 5, 40, 64, 70, 150, 160, 161, 250 }, { changes[0], changes[1] })
+        == std::vector<size_t>{ 5, 40, 64, 70, 150, 160, 161, 250 }));
+    CHECK((echoed(plugin) == std::vector<size_t>{ 5, 40, 64, 70, 150, 160, 161, 250 }));
+
+    // oversampled: sent at twice the offsets, echoed back at the host's
+    CVST_Suspend(plugin);
+    CVST_SetOversampling(plugin, 2);
+    CVST_Resume(plugin);
+    markers(plugin, { 10, 20, 21, 200 });
+    CHECK((echoed(plugin) == std::vector<size_t>{ 10, 20, 21, 200 }));
+
+    CVST_Destroy(plugin);
+    CVST_Shutdown();
+    printf("ok\n");
+    return 0;
+}
@@ -0,0 +1,128 @@
+// GraphTest.cpp : CVST_Graph -- nodes run in dependency order whatever order they were added in, fan-in is summed,
+// MIDI follows its edges, a long chain gets by with a few buffers, cycles are refused, and processing in place works
+
+#include "TestCommon.h"
+
+#define BLOCK_SIZE 128
+#define NUM_BLOCKS 8
+
+// runs an impulse (at frame 'at', on both inputs) through the graph, with 'events' in the first block, returns the whole output
+static TestBuffers<> runImpulse(CVST_Graph graph, size_t at, std::vector<CVST_MidiEvent> events = {})
+{
+    TestBuffers<> inputs(2, BLOCK_SIZE * NUM_BLOCKS), outputs(2, BLOCK_SIZE * NUM_BLOCKS);
+    inputs[0][at] = inputs[1][at] = 1.0f;
+    for (int block = 0; block < NUM_BLOCKS; block++) {
+        auto offset = (size_t)block * BLOCK_SIZE;
+        auto numEvents = offset == 0 ? (int)events.size() : 0;
+        CVST_GraphProcess(graph, inputs.view(offset), outputs.view(offset), BLOCK_SIZE, events.data(), numEvents);
+    }
+    return outputs;
+}
+
+int main()
+{
+    CVST_Init(testCallback);
+
+    // a serial chain, added in scrambled order: every node halves, and delays by its position in the chain
+    const int chainLength = 16;
+    const int added[chainLength] = { 9, 3, 14, 0, 7, 12, 1, 5, 15, 10, 2, 8, 13, 4, 11, 6 };
+    std::vector<CVST_Plugin> chain(chainLength);
+    std::vector<int> nodeOf(chainLength);
+    auto graph = CVST_GraphCreate(2, 2, BLOCK_SIZE);
+    for (int i = 0; i < chainLength; i++) {
+        auto position = added[i];
+        chain[position] = loadStarted(PROBEPLUGIN_PATH, BLOCK_SIZE);
+        setParameter(chain[position], kProbeGain, 0.5f);
+        setParameter(chain[position], kProbeDelay, position / 1000.0f);
+        nodeOf[position] = CVST_GraphAddPlugin(graph, chain[position]);
+    }
+    CHECK(CVST_GraphConnectAudio(graph, CVST_GRAPH_IO_NODE, 0, nodeOf[0], 0));
+    for (int i = 1; i < chainLength; i++) {
+        CHECK(CVST_GraphConnectAudio(graph, nodeOf[i - 1], 0, nodeOf[i], 0));
+    }
+    CHECK(CVST_GraphConnectAudio(graph, nodeOf[chainLength - 1], 0, CVST_GRAPH_IO_NODE, 0));
+    CHECK(!CVST_GraphConnectAudio(graph, nodeOf[0], 2, nodeOf[1], 0)); // (no such channel)
+    CHECK(!CVST_GraphConnectAudio(graph, chainLength, 0, nodeOf[1], 0)); // (no such node)
+    CHECK(CVST_GraphCompile(graph));
+    // (each step needs its outputs while its inputs are still live: two plugin-sized sets, whatever the length)
+    CHECK(CVST_GraphGetBufferCount(graph) <= 4);
+    {
+        auto totalDelay = (size_t)chainLength * (chainLength - 1) / 2;
+        auto outputs = runImpulse(graph, 10);
+        CHECK(nonZero(outputs[0]) == std::vector<size_t>{ 10 + totalDelay });
+        CHECK(outputs[0][10 + totalDelay] == 1.0f / (1 << chainLength));
+        CHECK(nonZero(outputs[1]).empty()); // (nothing connected)
+    }
+
+    // closing the chain into a loop
+    CHECK(CVST_GraphConnectAudio(graph, nodeOf[chainLength - 1], 0, nodeOf[0], 1));
+    CHECK(!CVST_GraphCompile(graph));
+    CVST_GraphDestroy(graph);
+
+    // fan-out and fan-in: input -> a, b -> c (summed), with MIDI input -> a -> c
+    auto a = loadStarted(PROBEPLUGIN_PATH, BLOCK_SIZE);
+    auto b = loadStarted(PROBEPLUGIN_PATH, BLOCK_SIZE);
+    auto c = loadStarted(PROBEPLUGIN_PATH, BLOCK_SIZE);
+    setParameter(a, kProbeGain, 0.5f);
+    setParameter(b, kProbeGain, 0.25f);
+    setParameter(b, kProbeDelay, 0.01f);
+    graph = CVST_GraphCreate(2, 2, BLOCK_SIZE);
+    auto nodeC = CVST_GraphAddPlugin(graph, c);
+    auto nodeB = CVST_GraphAddPlugin(graph, b);
+    auto nodeA = CVST_GraphAddPlugin(graph, a);
+    CHECK(CVST_GraphConnectAudio(graph, CVST_GRAPH_IO_NODE, 0, nodeA, 0));
+    CHECK(CVST_GraphConnectAudio(graph, CVST_GRAPH_IO_NODE, 0, nodeB, 0));
+    CHECK(CVST_GraphConnectAudio(graph, nodeA, 0, nodeC, 0));
+    CHECK(CVST_GraphConnectAudio(graph, nodeB, 0, nodeC, 0));
+    CHECK(CVST_GraphConnectAudio(graph, nodeC, 0, CVST_GRAPH_IO_NODE, 0));
+    CHECK(CVST_GraphConnectAudio(graph, nodeC, 1, CVST_GRAPH_IO_NODE, 1));
+    CHECK(CVST_GraphConnectMidi(graph, CVST_GRAPH_IO_NODE, nodeA));
+    CHECK(CVST_GraphConnectMidi(graph, nodeA, nodeC));
+    CHECK(!CVST_GraphConnectMidi(graph, nodeB, nodeC)); // (one MIDI source per node)
+    CHECK(CVST_GraphCompile(graph));
+    {
+        std::vector<CVST_MidiEvent> notes(3);
+        notes[0].sampleOffs = 40;
+        notes[1].sampleOffs = 77;
+        notes[2].sampleOffs = 120;
+        for (auto &note : notes) {
+            note.data.uint32 = 0x00403C90;
+        }
+        auto outputs = runImpulse(graph, 200, notes);
+        CHECK((nonZero(outputs[0]) == std::vector<size_t>{ 200, 210 }));
+        CHECK(outputs[0][200] == 0.5f && outputs[0][210] == 0.25f);
+        // (a echoed the events, c marked them -- every one on its frame)
+        CHECK((nonZero(outputs[1]) == std::vector<size_t>{ 40, 77, 120 }));
+    }
+    CVST_GraphDestroy(graph);
+
+    // in place, with graph inputs going straight out as well: out 0 = a(in 0) + in 1, out 1 = in 0
+    graph = CVST_GraphCreate(2, 2, BLOCK_SIZE);
+    nodeA = CVST_GraphAddPlugin(graph, a);
+    CHECK(CVST_GraphConnectAudio(graph, CVST_GRAPH_IO_NODE, 0, nodeA, 0));
+    CHECK(CVST_GraphConnectAudio(graph, nodeA, 0, CVST_GRAPH_IO_NODE, 0));
+    CHECK(CVST_GraphConnectAudio(graph, CVST_GRAPH_IO_NODE, 1, CVST_GRAPH_IO_NODE, 0));
+    CHECK(CVST_GraphConnectAudio(graph, CVST_GRAPH_IO_NODE, 0, CVST_GRAPH_IO_NODE, 1));
+    CHECK(CVST_GraphCompile(graph));
+    {
+        TestBuffers<> buffers(2, BLOCK_SIZE);
+        buffers[0][20] = 1.0f;
+        buffers[1][30] = 1.0f;
+        CVST_GraphProcess(graph, buffers.view(0), buffers.view(0), BLOCK_SIZE, nullptr, 0);
+        CHECK((nonZero(buffers[0]) == std::vector<size_t>{ 20, 30 }));
+        CHECK(buffers[0][20] == 0.5f && buffers[0][30] == 1.0f);
+        CHECK(nonZero(buffers[1]) == std::vector<size_t>{ 20 });
+        CHECK(buffers[1][20] == 1.0f);
+    }
+    CVST_GraphDestroy(graph);
+
+    for (auto plugin : { a, b, c }) {
+        CVST_Destroy(plugin);
+    }
+    for (auto plugin : chain) {
+        CVST_Destroy(plugin);
+    }
+    CVST_Shutdown();
+    printf("ok\n");
+    return 0;
+}
@@ -0,0 +1,127 @@
+// InstancePoolTest.cpp : CVST_InstancePool -- whatever was done to an instance before it was released (parameters, host
+// settings, a state load still in flight), it comes back out of the pool like a newly loaded one
+
+#include "TestCommon.h"
+
+#include <chrono>
+#include <thread>
+
+#define POOL_SIZE 2
+#define BLOCK_SIZE 128
+#define MAX_ROUNDS 50
+
+// what a newly loaded instance has
+struct Defaults {
+    float gain;
+    int inputEvents, outputEvents;
+};
+
+static void waitReady(CVST_InstancePool pool)
+{
+    while (CVST_InstancePoolGetReadyCount(pool) < POOL_SIZE) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+static void processBlocks(CVST_Plugin plugin, int numBlocks)
+{
+    TestBuffers<> inputs(2, BLOCK_SIZE), outputs(2, BLOCK_SIZE);
+    inputs[0][0] = 1.0f;
+    for (int i = 0; i < numBlocks; i++) {
+        CVST_ProcessReplacing(plugin, inputs.view(0), outputs.view(0), BLOCK_SIZE);
+    }
+}
+
+// everything a user might leave behind
+static void messUp(CVST_Plugin plugin, const std::vector<char> &otherState)
+{
+    setParameter(plugin, kProbeGain, 3.0f);
+    CVST_Suspend(plugin);
+    CVST_SetBlockMode(plugin, BlockMode_Fixed, 64);
+    CVST_SetOversampling(plugin, 2);
+    CVST_SetSleepMode(plugin, true, 0, 0.0f);
+    CVST_SetProcessPrecision(plugin, ProcessPrecision_64);
+    CVST_SetEventCapacity(plugin, 0, 0);
+    CVST_SetStatsBudget(plugin, 1e-9);
+    CVST_Resume(plugin);
+    processBlocks(plugin, 4);
+    // (released before the next block would swap it in)
+    CHECK(CVST_SetChunkAsync(plugin, ChunkType_Program, otherState.data(), otherState.size(), 0));
+}
+
+static void checkNew(CVST_Plugin plugin, const Defaults &defaults)
+{
+    CHECK(getParameter(plugin, kProbeGain) == defaults.gain);
+    CHECK(CVST_GetLatency(plugin) == 0); // (no adapter, no oversampling filters)
+    CHECK(getParameter(plugin, kProbeSampleRate) == 44100.0f);
+    CHECK(getParameter(plugin, kProbeBlockSize) == BLOCK_SIZE);
+    int inputEvents, outputEvents;
+    CVST_GetEventCapacity(plugin, &inputEvents, &outputEvents);
+    CHECK(inputEvents == defaults.inputEvents && outputEvents == defaults.outputEvents);
+    CHECK(CVST_GetStateLoadStatus(plugin) != StateLoad_Pending);
+    CHECK(CVST_GetSamplePosition(plugin) == 0);
+
+    // processing: every block reaches the plugin, at the caller's size (no sleep, no adapter), nothing is swapped in,
+    // and no block is an overrun against the default budget
+    auto calls = getParameter(plugin, kProbeCalls);
+    processBlocks(plugin, 2);
+    CHECK(getParameter(plugin, kProbeCalls) == calls + 2);
+    CHECK(getParameter(plugin, kProbeLastFrames) == BLOCK_SIZE);
+    CHECK(getParameter(plugin, kProbeGain) == defaults.gain);
+    CVST_Stats stats;
+    CVST_GetStats(plugin, &stats);
+    CHECK(stats.overruns == 0);
+}
+
+int main()
+{
+    CVST_Init(testCallback);
+
+    Defaults defaults;
+    std::vector<char> otherState;
+    {
+        auto plugin = loadStarted(PROBEPLUGIN_PATH, BLOCK_SIZE);
+        defaults.gain = getParameter(plugin, kProbeGain);
+        CVST_GetEventCapacity(plugin, &defaults.inputEvents, &defaults.outputEvents);
+        CHECK(defaults.inputEvents > 0);
+        setParameter(plugin, kProbeGain, 5.0f);
+        void *data;
+        size_t size;
+        CVST_GetChunk(plugin, ChunkType_Program, &data, &size);
+        otherState.assign((char *)data, (char *)data + size);
+        CVST_Destroy(plugin);
+    }
+
+    // released instances race the worker's refills, so it takes a few rounds for some to be reset and re-listed
+    // (the probe's call counter survives a reset: a fresh instance has never been processed)
+    auto pool = CVST_InstancePoolCreate(PROBEPLUGIN_PATH, false, POOL_SIZE, 44100.0f, BLOCK_SIZE);
+    int reused = 0;
+    for (int round = 0; round < MAX_ROUNDS && reused < 3; round++) {
+        waitReady(pool);
+        CVST_Plugin plugins[POOL_SIZE];
+        for (auto &plugin : plugins) {
+            plugin = CVST_InstancePoolAcquire(pool, nullptr, ChunkType_Program, nullptr, 0);
+            CHECK(plugin != nullptr);
+        }
+        for (auto plugin : plugins) {
+            reused += getParameter(plugin, kProbeCalls) > 0 ? 1 : 0;
+            checkNew(plugin, defaults);
+            messUp(plugin, otherState);
+        }
+        for (auto plugin : plugins) {
+            CVST_InstancePoolRelease(pool, plugin);
+        }
+    }
+    CHECK(reused > 0);
+
+    // a chunk given to acquire is applied on top
+    waitReady(pool);
+    auto plugin = CVST_InstancePoolAcquire(pool, nullptr, ChunkType_Program, otherState.data(), otherState.size());
+    CHECK(getParameter(plugin, kProbeGain) == 5.0f);
+    CVST_Destroy(plugin);
+
+    CVST_InstancePoolDestroy(pool);
+    CVST_Shutdown();
+    printf("ok\n");
+    return 0;
+}
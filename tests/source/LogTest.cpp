@@ -0,0 +1,31 @@
+// LogTest.cpp : the deferred log -- string arguments come out whole, even a long plugin path together with the
+// loader's error message (which repeats it)
+
+#include "TestCommon.h"
+
+// the logged message starting with 'prefix' (empty if there's none)
+static std::string loggedWith(const char *prefix)
+{
+    CVST_DrainLog();
+    for (auto &message : testLog) {
+        if (message.compare(0, strlen(prefix), prefix) == 0) {
+            return message;
+        }
+    }
+    return "";
+}
+
+int main()
+{
+    CVST_Init(testCallback);
+
+    std::string path = "/nonexistent/" + std::string(200, 'x') + "/plugin.so";
+    CHECK(CVST_LoadPlugin(path.c_str(), nullptr) == nullptr);
+    CHECK(loggedWith("** loading [") == "** loading [" + path + "] **");
+    auto error = loggedWith("library not found / load failed: ");
+    CHECK(error.find(path) != std::string::npos);
+
+    CVST_Shutdown();
+    printf("ok\n");
+    return 0;
+}
@@ -0,0 +1,107 @@
+// OversamplerTest.cpp : CVST_SetOversampling -- the plugin runs at factor x the rate and block size, DC goes through at
+// unity, and an impulse comes out at exactly CVST_GetLatency (the filters' delay plus the plugin's own, in host frames),
+// symmetric around it; for either precision
+
+#include "TestCommon.h"
+
+#include <math.h>
+
+#define BLOCK_SIZE 128
+#define TOTAL_FRAMES 4096
+#define IMPULSE_AT 100
+
+static void process(CVST_Plugin plugin, float **inputs, float **outputs)
+{
+    CVST_ProcessReplacing(plugin, inputs, outputs, BLOCK_SIZE);
+}
+
+static void process(CVST_Plugin plugin, double **inputs, double **outputs)
+{
+    CVST_ProcessDoubleReplacing(plugin, inputs, outputs, BLOCK_SIZE);
+}
+
+// 'input' (on input 0) through the plugin in blocks, from silence, returns output 0
+template <typename T>
+static std::vector<T> run(CVST_Plugin plugin, const std::vector<T> &input)
+{
+    TestBuffers<T> inputs(2, TOTAL_FRAMES), outputs(2, TOTAL_FRAMES);
+    // (the filters emptied, then a block of silence through the plugin's own delay line)
+    CVST_ResetHostState(plugin);
+    process(plugin, inputs.view(0), outputs.view(0));
+    inputs[0] = input;
+    for (size_t offset = 0; offset < TOTAL_FRAMES; offset += BLOCK_SIZE) {
+        process(plugin, inputs.view(offset), outputs.view(offset));
+    }
+    return outputs[0];
+}
+
+template <typename T>
+static void checkResponse(CVST_Plugin plugin, int latency, double tolerance)
+{
+    // a step: settles at unity
+    auto step = run(plugin, std::vector<T>(TOTAL_FRAMES, (T)1));
+    for (size_t i = TOTAL_FRAMES / 2; i < TOTAL_FRAMES; i++) {
+        CHECK(fabs(step[i] - 1.0) < tolerance);
+    }
+
+    // an impulse: peaks at exactly the latency, linear phase around it
+    std::vector<T> impulse(TOTAL_FRAMES, (T)0);
+    impulse[IMPULSE_AT] = (T)1;
+    auto response = run(plugin, impulse);
+    auto peak = std::max_element(response.begin(), response.end(), [](T a, T b) { return fabs(a) < fabs(b); }) - response.begin();
+    CHECK(peak == IMPULSE_AT + latency);
+    for (int k = 1; k <= IMPULSE_AT; k++) {
+        CHECK(fabs(response[peak - k] - response[peak + k]) < tolerance);
+    }
+    CHECK(std::all_of(response.begin(), response.begin() + IMPULSE_AT, [](T x) { return x == 0; }));
+}
+
+int main()
+{
+    CVST_Init(testCallback);
+    auto plugin = loadStarted(PROBEPLUGIN_PATH, BLOCK_SIZE);
+
+    for (int factor : { 2, 4, 8 }) {
+        CVST_Suspend(plugin);
+        CVST_SetOversampling(plugin, factor);
+        CVST_Resume(plugin);
+        CHECK(getParameter(plugin, kProbeSampleRate) == 44100.0f * factor);
+        CHECK(getParameter(plugin, kProbeBlockSize) == BLOCK_SIZE * factor);
+        auto filterLatency = CVST_GetLatency(plugin);
+        CHECK(filterLatency > 0);
+        checkResponse<float>(plugin, filterLatency, 1e-4);
+        CHECK(getParameter(plugin, kProbeMaxFrames) == BLOCK_SIZE * factor);
+
+        // the plugin's own delay (in its frames) adds, in host frames
+        setParameter(plugin, kProbeDelay, factor * 10 / 1000.0f);
+        CHECK(CVST_GetLatency(plugin) == filterLatency + 10);
+        checkResponse<float>(plugin, filterLatency + 10, 1e-4);
+        setParameter(plugin, kProbeDelay, 0.0f);
+
+        CVST_Suspend(plugin);
+        CHECK(CVST_SetProcessPrecision(plugin, ProcessPrecision_64));
+        CVST_Resume(plugin);
+        checkResponse<double>(plugin, filterLatency, 1e-4);
+        CVST_Suspend(plugin);
+        CVST_SetProcessPrecision(plugin, ProcessPrecision_32);
+        CVST_Resume(plugin);
+    }
+
+    // and off again
+    CVST_Suspend(plugin);
+    CVST_SetOversampling(plugin, 1);
+    CVST_Resume(plugin);
+    CHECK(CVST_GetLatency(plugin) == 0);
+    CHECK(getParameter(plugin, kProbeSampleRate) == 44100.0f);
+    {
+        std::vector<float> impulse(TOTAL_FRAMES, 0.0f);
+        impulse[IMPULSE_AT] = 1.0f;
+        CHECK(nonZero(run(plugin, impulse)) == std::vector<size_t>{ IMPULSE_AT });
+    }
+
+    CVST_Suspend(plugin);
+    CVST_Destroy(plugin);
+    CVST_Shutdown();
+    printf("ok\n");
+    return 0;
+}
@@ -0,0 +1,85 @@
+// ParallelMixTest.cpp : CVST_ParallelMix -- members with different latencies line up with the slowest, whatever the
+// block size, and follow latency changes; a member beyond maxLatency is reported, and the mix latency says where it is;
+// processing in place works
+
+#include "TestCommon.h"
+
+#define BLOCK_SIZE 128
+#define MAX_LATENCY 1000
+#define TOTAL_FRAMES 4000
+
+// runs an impulse (at frame 'at') through the mix in blocks of 'blockSize', returns output 0
+// (in place: the outputs are the inputs)
+static std::vector<float> runImpulse(CVST_ParallelMix mix, size_t at, unsigned int blockSize, bool inPlace = false)
+{
+    TestBuffers<> inputs(2, TOTAL_FRAMES), outputs(2, TOTAL_FRAMES);
+    inputs[0][at] = 1.0f;
+    auto &dest = inPlace ? inputs : outputs;
+    for (unsigned int offset = 0; offset < TOTAL_FRAMES; offset += blockSize) {
+        CVST_ParallelMixProcess(mix, inputs.view(offset), dest.view(offset), std::min(blockSize, TOTAL_FRAMES - offset));
+    }
+    return dest[0];
+}
+
+int main()
+{
+    CVST_Init(testCallback);
+
+    // latencies of 0, 100 and 237 frames, gains of 1, 2 and 4: one impulse of 7 at the slowest's latency
+    const float delays[3] = { 0.0f, 0.1f, 0.237f };
+    CVST_Plugin plugins[3];
+    auto mix = CVST_ParallelMixCreate(2, BLOCK_SIZE, MAX_LATENCY);
+    for (int i = 0; i < 3; i++) {
+        plugins[i] = loadStarted(PROBEPLUGIN_PATH, BLOCK_SIZE);
+        setParameter(plugins[i], kProbeDelay, delays[i]);
+        CHECK(CVST_ParallelMixAdd(mix, plugins[i], (float)(1 << i)) == i);
+    }
+    CHECK(CVST_ParallelMixGetLatency(mix) == 237);
+    for (unsigned int blockSize : { 100, 128, 300 }) { // (the last one goes through in pieces)
+        auto output = runImpulse(mix, 10, blockSize);
+        CHECK(nonZero(output) == std::vector<size_t>{ 10 + 237 });
+        CHECK(output[10 + 237] == 7.0f);
+    }
+
+    // the slowest gets faster: the mix follows at the next block
+    setParameter(plugins[2], kProbeDelay, 0.05f);
+    runImpulse(mix, 0, BLOCK_SIZE); // (and flushes what's in flight)
+    CHECK(CVST_ParallelMixGetLatency(mix) == 100);
+    {
+        auto output = runImpulse(mix, 10, BLOCK_SIZE);
+        CHECK(nonZero(output) == std::vector<size_t>{ 10 + 100 });
+        CHECK(output[10 + 100] == 7.0f);
+    }
+
+    // one beyond maxLatency: the others wait up to maxLatency, it's late by the rest, and the mix latency is its own
+    takeLogged("");
+    setParameter(plugins[1], kProbeDelay, 1.2f);
+    runImpulse(mix, 0, BLOCK_SIZE);
+    CHECK(takeLogged("over the mix's maximum"));
+    CHECK(CVST_ParallelMixGetLatency(mix) == 1200);
+    {
+        auto output = runImpulse(mix, 10, BLOCK_SIZE);
+        CHECK((nonZero(output) == std::vector<size_t>{ 10 + MAX_LATENCY, 10 + 1200 }));
+        CHECK(output[10 + MAX_LATENCY] == 5.0f && output[10 + 1200] == 2.0f);
+    }
+    runImpulse(mix, 0, BLOCK_SIZE);
+    CHECK(!takeLogged("over the mix's maximum")); // (once per change, not every block)
+
+    // in place: every member still hears the input, whole blocks or in pieces
+    setParameter(plugins[1], kProbeDelay, 0.1f);
+    runImpulse(mix, 0, BLOCK_SIZE);
+    CHECK(CVST_ParallelMixGetLatency(mix) == 100);
+    for (unsigned int blockSize : { 100, 300 }) {
+        auto output = runImpulse(mix, 10, blockSize, true);
+        CHECK(nonZero(output) == std::vector<size_t>{ 10 + 100 });
+        CHECK(output[10 + 100] == 7.0f);
+    }
+
+    CVST_ParallelMixDestroy(mix);
+    for (auto plugin : plugins) {
+        CVST_Destroy(plugin);
+    }
+    CVST_Shutdown();
+    printf("ok\n");
+    return 0;
+}
@@ -0,0 +1,105 @@
+// ParameterShadowTest.cpp : the host-side parameter copy -- CVST_GetParameters follows every kind of change (the host's,
+// sample-accurate ones, chunk loads, the plugin's own automation), and CVST_GetChangedParameters reports each actual
+// change once, in ascending order, keeping what doesn't fit for the next call
+
+#include "TestCommon.h"
+
+#define BLOCK_SIZE 128
+
+static std::vector<int> changed(CVST_Plugin plugin, int maxIndices = 64)
+{
+    std::vector<int> indices(maxIndices);
+    indices.resize(CVST_GetChangedParameters(plugin, indices.data(), maxIndices));
+    return indices;
+}
+
+static float shadowed(CVST_Plugin plugin, int index)
+{
+    float value = -1.0f;
+    CHECK(CVST_GetParameters(plugin, index, &value, 1) == 1);
+    return value;
+}
+
+static void processSilence(CVST_Plugin plugin)
+{
+    TestBuffers<> inputs(2, BLOCK_SIZE), outputs(2, BLOCK_SIZE);
+    CVST_ProcessReplacing(plugin, inputs.view(0), outputs.view(0), BLOCK_SIZE);
+}
+
+int main()
+{
+    CVST_Init(testCallback);
+    auto plugin = loadStarted(PROBEPLUGIN_PATH, BLOCK_SIZE);
+    CHECK(CVST_GetNumParameters(plugin) == kNumProbeParams);
+    changed(plugin); // (whatever loading turned up)
+    CHECK(changed(plugin).empty());
+
+    // the host's own changes: reported once, ascending, and only if the value actually changed
+    float values[3] = { 0.02f, 0.0f, 0.5f }; // delay, tail, gain
+    CVST_SetParameters(plugin, kProbeDelay, values, 3);
+    CHECK(shadowed(plugin, kProbeGain) == 0.5f);
+    CHECK((changed(plugin) == std::vector<int>{ kProbeDelay, kProbeGain }));
+    CHECK(changed(plugin).empty());
+    CVST_SetParameters(plugin, kProbeDelay, values, 3);
+    CHECK(changed(plugin).empty());
+    float outOfRange = 1.0f;
+    CVST_SetParameters(plugin, CVST_GetNumParameters(plugin), &outOfRange, 1);
+    CHECK(changed(plugin).empty());
+
+    // more changes than asked for: the rest stay for the next call
+    float more[3] = { 0.03f, 0.1f, 0.75f };
+    CVST_SetParameters(plugin, kProbeDelay, more, 3);
+    CHECK((changed(plugin, 2) == std::vector<int>{ kProbeDelay, kProbeTail }));
+    CHECK((changed(plugin, 2) == std::vector<int>{ kProbeGain }));
+
+    // sample-accurate changes, as they're applied
+    CVST_ParameterChange change;
+    change.sampleOffs = 64;
+    change.index = kProbeGain;
+    change.value = 0.25f;
+    CVST_SetBlockParameterChanges(plugin, &change, 1);
+    CHECK(shadowed(plugin, kProbeGain) == 0.75f);
+    processSilence(plugin);
+    CHECK(shadowed(plugin, kProbeGain) == 0.25f);
+    CHECK((changed(plugin) == std::vector<int>{ kProbeGain }));
+
+    // what the plugin changed without saying so shows up on a refresh (here, its counters)
+    processSilence(plugin);
+    CHECK(changed(plugin).empty());
+    CVST_RefreshParameters(plugin);
+    auto refreshed = changed(plugin);
+    CHECK(std::find(refreshed.begin(), refreshed.end(), (int)kProbeCalls) != refreshed.end());
+    CHECK(std::find(refreshed.begin(), refreshed.end(), (int)kProbeGain) == refreshed.end());
+
+    // a chunk load re-reads everything
+    void *data;
+    size_t size;
+    CVST_GetChunk(plugin, ChunkType_Program, &data, &size);
+    std::vector<char> chunk((char *)data, (char *)data + size);
+    setParameter(plugin, kProbeGain, 1.0f);
+    setParameter(plugin, kProbeTail, 0.0f);
+    changed(plugin);
+    CVST_SetChunk(plugin, ChunkType_Program, chunk.data(), chunk.size());
+    CHECK(shadowed(plugin, kProbeGain) == 0.25f && shadowed(plugin, kProbeTail) == 0.1f);
+    CHECK((changed(plugin) == std::vector<int>{ kProbeTail, kProbeGain }));
+    CVST_Destroy(plugin);
+
+    // the plugin's own automation (the test plugin turns CC7 into its gain): shadowed, reported, and polled
+    plugin = loadStarted(TESTPLUGIN_PATH, BLOCK_SIZE);
+    changed(plugin);
+    CVST_MidiEvent cc;
+    cc.sampleOffs = 10;
+    cc.data.uint32 = 0x006407B0; // CC7 = 100
+    CVST_SetBlockEvents(plugin, &cc, 1);
+    processSilence(plugin);
+    CHECK(shadowed(plugin, 0) == 100 / 127.0f);
+    CHECK(changed(plugin) == std::vector<int>{ 0 });
+    CVST_AutomationEvent automation[4];
+    CHECK(CVST_PollAutomation(plugin, automation, 4) == 1);
+    CHECK(automation[0].index == 0 && automation[0].value == 100 / 127.0f);
+    CVST_Destroy(plugin);
+
+    CVST_Shutdown();
+    printf("ok\n");
+    return 0;
+}
@@ -0,0 +1,159 @@
+// PresetStoreTest.cpp : CVST_PresetStore -- entries come back byte for byte after a commit and reopen (compressed or not,
+// including content the compressor can't shrink and long overlapping matches), identical content is stored once, a
+// stored chunk restores a plugin, and damaged files are refused rather than trusted
+
+#include "TestCommon.h"
+
+#define STORE_PATH "PresetStoreTest.store"
+#define DAMAGED_PATH "PresetStoreTest.damaged"
+
+static std::string patterned(size_t size)
+{
+    std::string data(size, 0);
+    for (size_t i = 0; i < size; i++) {
+        data[i] = (char)("preset data "[i % 12] + (i / 4096) % 3);
+    }
+    return data;
+}
+
+static std::string noise(size_t size)
+{
+    std::string data(size, 0);
+    uint32_t state = 12345;
+    for (auto &byte : data) {
+        state = state * 1664525u + 1013904223u;
+        byte = (char)(state >> 24);
+    }
+    return data;
+}
+
+// patches the first blob record's rawSize (see the layout in PresetStore.cpp: a 40-byte header with the entry record
+// size at 8 and the entry count at 16, the entries, then the blobs -- offset, storedSize, rawSize ...)
+static void setRawSize(std::string &contents, uint64_t rawSize)
+{
+    uint32_t entrySize, numEntries;
+    memcpy(&entrySize, &contents[8], 4);
+    memcpy(&numEntries, &contents[16], 4);
+    memcpy(&contents[40 + (size_t)entrySize * numEntries + 16], &rawSize, 8);
+}
+
+static std::string entryData(CVST_PresetStore store, const char *name)
+{
+    auto index = CVST_PresetStoreFind(store, name);
+    CHECK(index >= 0);
+    size_t size = 0;
+    auto data = (const char *)CVST_PresetStoreGetData(store, index, &size);
+    CHECK(data != nullptr);
+    return std::string(data, size);
+}
+
+static bool entryCompressed(CVST_PresetStore store, const char *name)
+{
+    CVST_PresetInfo info;
+    CHECK(CVST_PresetStoreGetInfo(store, CVST_PresetStoreFind(store, name), &info));
+    CHECK(!strcmp(info.name, name));
+    return info.compressed;
+}
+
+int main()
+{
+    CVST_Init(testCallback);
+    remove(STORE_PATH);
+    const auto pattern = patterned(100000), random = noise(50000), zeros = std::string(20000, 0);
+
+    auto plugin = loadStarted(PROBEPLUGIN_PATH, 256);
+    setParameter(plugin, kProbeGain, 0.25f);
+    setParameter(plugin, kProbeDelay, 0.02f);
+
+    auto store = CVST_PresetStoreOpen(STORE_PATH);
+    CHECK(CVST_PresetStoreGetCount(store) == 0);
+    CHECK(CVST_PresetStoreAddFromPlugin(store, "probe", plugin, ChunkType_Program, false) == 0);
+    CVST_PresetStoreAdd(store, "pattern", 1, ChunkType_Bank, pattern.data(), pattern.size(), true);
+    CVST_PresetStoreAdd(store, "pattern again", 1, ChunkType_Bank, pattern.data(), pattern.size(), true);
+    CVST_PresetStoreAdd(store, "random", 2, ChunkType_Bank, random.data(), random.size(), true);
+    CVST_PresetStoreAdd(store, "random again", 2, ChunkType_Bank, random.data(), random.size(), false);
+    CVST_PresetStoreAdd(store, "zeros", 3, ChunkType_Program, zeros.data(), zeros.size(), true);
+    CHECK(entryData(store, "pattern") == pattern); // (usable before committing)
+    CHECK(CVST_PresetStoreCommit(store));
+    CVST_PresetStoreClose(store);
+
+    // everything back from the file, the compressor only kept where it paid off
+    store = CVST_PresetStoreOpen(STORE_PATH);
+    CHECK(CVST_PresetStoreGetCount(store) == 6);
+    CHECK(entryData(store, "pattern") == pattern && entryData(store, "pattern again") == pattern);
+    CHECK(entryData(store, "random") == random && entryData(store, "random again") == random);
+    CHECK(entryData(store, "zeros") == zeros);
+    CHECK(entryCompressed(store, "pattern") && entryCompressed(store, "zeros"));
+    CHECK(!entryCompressed(store, "random"));
+    CVST_PresetInfo info;
+    CHECK(CVST_PresetStoreGetInfo(store, CVST_PresetStoreFind(store, "probe"), &info));
+    CHECK(info.pluginID == ('c' << 24 | 'v' << 16 | 'p' << 8 | 'r') && info.chunkType == ChunkType_Program);
+    CHECK(CVST_PresetStoreFind(store, "nothing") == -1);
+
+    // stored once per content: the noise (which doesn't compress) would take twice its size otherwise
+    auto fileSize = readFile(STORE_PATH).size();
+    CHECK(fileSize > random.size() && fileSize < random.size() * 2);
+
+    // restoring the plugin from its entry
+    setParameter(plugin, kProbeGain, 1.0f);
+    CHECK(CVST_PresetStoreApply(store, CVST_PresetStoreFind(store, "probe"), plugin));
+    CHECK(getParameter(plugin, kProbeGain) == 0.25f);
+    CHECK(CVST_GetLatency(plugin) == 20);
+
+    // replacing an entry keeps its place, content nothing refers to any more is dropped on commit
+    CHECK(CVST_PresetStoreAdd(store, "random", 2, ChunkType_Bank, zeros.data(), zeros.size(), false) == CVST_PresetStoreFind(store, "random"));
+    CHECK(CVST_PresetStoreAdd(store, "random again", 2, ChunkType_Bank, zeros.data(), zeros.size(), false) >= 0);
+    CHECK(CVST_PresetStoreCommit(store));
+    CHECK(CVST_PresetStoreGetCount(store) == 6);
+    CHECK(entryData(store, "random") == zeros && entryData(store, "pattern") == pattern);
+    CHECK(readFile(STORE_PATH).size() < random.size());
+    CVST_PresetStoreClose(store);
+
+    // damaged files: a truncated or garbled one counts as empty (logged), a broken compressed entry can't be fetched
+    auto contents = readFile(STORE_PATH);
+    for (auto damaged : { contents.substr(0, contents.size() / 2), std::string(contents.size(), 'x') }) {
+        writeFile(DAMAGED_PATH, damaged);
+        store = CVST_PresetStoreOpen(DAMAGED_PATH);
+        CHECK(CVST_PresetStoreGetCount(store) == 0);
+        CHECK(takeLogged("starting empty"));
+        CVST_PresetStoreClose(store);
+    }
+    remove(DAMAGED_PATH);
+    store = CVST_PresetStoreOpen(DAMAGED_PATH);
+    CVST_PresetStoreAdd(store, "pattern", 1, ChunkType_Bank, pattern.data(), pattern.size(), true);
+    CHECK(CVST_PresetStoreCommit(store));
+    CVST_PresetStoreClose(store);
+    contents = readFile(DAMAGED_PATH);
+    std::fill(contents.end() - 64, contents.end(), (char)0xff); // (the end of the one compressed blob)
+    writeFile(DAMAGED_PATH, contents);
+    store = CVST_PresetStoreOpen(DAMAGED_PATH);
+    CHECK(CVST_PresetStoreGetCount(store) == 1);
+    size_t size = 0;
+    CHECK(CVST_PresetStoreGetData(store, 0, &size) == nullptr);
+    CHECK(!CVST_PresetStoreApply(store, 0, plugin));
+    CVST_PresetStoreClose(store);
+
+    // a blob claiming more data than it has (stored as is), or an impossible amount (compressed): refused on opening,
+    // before anything is read or allocated for it
+    for (bool compress : { false, true }) {
+        remove(DAMAGED_PATH);
+        store = CVST_PresetStoreOpen(DAMAGED_PATH);
+        CVST_PresetStoreAdd(store, "pattern", 1, ChunkType_Bank, pattern.data(), pattern.size(), compress);
+        CHECK(CVST_PresetStoreCommit(store));
+        CVST_PresetStoreClose(store);
+        contents = readFile(DAMAGED_PATH);
+        setRawSize(contents, compress ? (1ull << 40) : pattern.size() + 1);
+        writeFile(DAMAGED_PATH, contents);
+        store = CVST_PresetStoreOpen(DAMAGED_PATH);
+        CHECK(CVST_PresetStoreGetCount(store) == 0);
+        CHECK(takeLogged("starting empty"));
+        CVST_PresetStoreClose(store);
+    }
+
+    remove(STORE_PATH);
+    remove(DAMAGED_PATH);
+    CVST_Destroy(plugin);
+    CVST_Shutdown();
+    printf("ok\n");
+    return 0;
+}
@@ -0,0 +1,278 @@
+// ProbePlugin.cpp : a synthetic plugin for the tests -- behaviour set through its parameters, and what the host did to it
+// read back through further (read-only) ones
+//
+// output 0 is input 0 delayed by 'Delay' frames (reported as initialDelay) and scaled by 'Gain'; output 1 is silent but
+// for a 1.0 at every incoming MIDI event's position (so that event timing shows up in the audio). MIDI is echoed back
+// to the host, and a control change reports parameter <controller number> as automated, to <value> / 127 (without
+// changing it). the writable parameters are saved and restored as a chunk. 'Wide' makes it a 40 in / 40 out plugin, the
+// channels past the first two passed straight through (scaled by 'Gain'); 'FloatOnly' takes back effFlagsCanDoubleReplacing.
+// with a 'TimeFilter' (raw kVst*Valid mask), every process call asks for the time with it, then with every field, and
+// reads back what it got; with 'Busy', every process call takes at least that long (busy-waiting)
+// (the counters are raw values rather than 0..1, CVST_RefreshParameters then CVST_GetParameters to read them)
+
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include "../../deps/VST2_SDK/pluginterfaces/vst2.x/aeffectx.h"
+
+#ifdef _WIN32
+#define PLUGIN_EXPORT extern "C" __declspec(dllexport)
+#else
+#define PLUGIN_EXPORT extern "C" __attribute__((visibility("default")))
+#endif
+
+#define NUM_CHANNELS 2
+#define NUM_WIDE_CHANNELS 40 // (more than a bridge carries)
+#define MAX_DELAY 4096 // frames, at the plugin's rate (power of two)
+#define MAX_EVENTS 256 // per process call
+#define DELAY_SCALE 1000.0f // 'Delay' 1.0 = 1000 frames
+#define TAIL_SCALE 100000.0f // 'Tail' 1.0 = 100000 frames
+#define BUSY_SCALE 10000.0f // 'Busy' 1.0 = 10000 us
+
+enum Params {
+    kParamDelay,
+    kParamTail, // effGetTailSize (0: doesn't know)
+    kParamGain, // 1.0 = unity
+    kParamWide, // > 0.5: NUM_WIDE_CHANNELS each way
+    kParamFloatOnly, // > 0.5: no 64-bit processing
+    kParamTimeFilter, // (raw) audioMasterGetTime filter for the first request of every process call, 0: none
+    kParamBusy, // * 10 ms of busy-waiting per process call
+    kNumStateParams,
+    kParamCalls = kNumStateParams, // (read-only from here) process calls so far
+    kParamLastFrames, // frames in the last process call
+    kParamMaxFrames, // most frames in a process call
+    kParamSampleRate, // as set by the host
+    kParamBlockSize, // as set by the host
+    kParamEvents, // MIDI events received
+    kParamDoubleCalls, // processDoubleReplacing calls so far
+    kParamTimeFlags, // VstTimeInfo flags after the first request (as asked for by 'TimeFilter')
+    kParamTimeAllFlags, // and after the second one (asking for every field)
+    kParamTimeCached, // 1 if both returned the same VstTimeInfo
+    kParamTimeSamplePos, // (from here on, fields after the second request)
+    kParamTimePpqPos,
+    kParamTimeTempo,
+    kParamTimeBarStart,
+    kParamTimeSigNumerator,
+    kNumParams
+};
+
+struct ProbeState {
+    VstInt32 magic;
+    float params[kNumStateParams];
+};
+#define STATE_MAGIC CCONST('c', 'v', 'p', 'r')
+
+struct ProbePlugin {
+    AEffect effect;
+    audioMasterCallback host;
+
+    float params[kNumParams] = {};
+    float ring[MAX_DELAY] = {};
+    unsigned int writePos = 0;
+    int eventOffsets[MAX_EVENTS]; // for the next process call
+    int numEvents = 0;
+    ProbeState state;
+
+    ProbePlugin(audioMasterCallback host);
+
+    inline int delay() const { return std::min((int)lroundf(params[kParamDelay] * DELAY_SCALE), MAX_DELAY - 1); }
+    inline int channels() const { return params[kParamWide] > 0.5f ? NUM_WIDE_CHANNELS : NUM_CHANNELS; }
+
+    // latency and I/O as the parameters have them, returns whether that changed them
+    bool updateIO() {
+        auto changed = effect.initialDelay != delay() || effect.numInputs != channels();
+        effect.initialDelay = delay();
+        effect.numInputs = effect.numOutputs = channels();
+        return changed;
+    }
+    void updateFlags() {
+        effect.flags = params[kParamFloatOnly] > 0.5f ? effect.flags & ~effFlagsCanDoubleReplacing : effect.flags | effFlagsCanDoubleReplacing;
+    }
+};
+
+static VstIntPtr VSTCALLBACK dispatcherProc(AEffect* effect, VstInt32 opcode, VstInt32, VstIntPtr value, void* ptr, float opt)
+{
+    auto plugin = (ProbePlugin *)effect->object;
+    switch (opcode) {
+    case effClose:
+        delete plugin;
+        return 1;
+    case effSetSampleRate:
+        plugin->params[kParamSampleRate] = opt;
+        return 1;
+    case effSetBlockSize:
+        plugin->params[kParamBlockSize] = (float)value;
+        return 1;
+    case effSetProcessPrecision:
+        return 1;
+    case effMainsChanged:
+        if (value) {
+            memset(plugin->ring, 0, sizeof(plugin->ring));
+            plugin->numEvents = 0;
+        }
+        return 1;
+    case effGetTailSize:
+        return (VstIntPtr)lroundf(plugin->params[kParamTail] * TAIL_SCALE);
+    case effProcessEvents: {
+        // (deltaFrames as VST2 has it: from the start of the next process call)
+        auto events = (VstEvents *)ptr;
+        for (int i = 0; i < events->numEvents; i++) {
+            if (plugin->numEvents < MAX_EVENTS) {
+                plugin->eventOffsets[plugin->numEvents++] = events->events[i]->deltaFrames;
+            }
+            auto midi = (VstMidiEvent *)events->events[i];
+            if (midi->type == kVstMidiType && (midi->midiData[0] & 0xF0) == 0xB0) {
+                plugin->host(effect, audioMasterAutomate, midi->midiData[1], 0, nullptr, (midi->midiData[2] & 0x7F) / 127.0f);
+            }
+        }
+        plugin->params[kParamEvents] += (float)events->numEvents;
+        plugin->host(effect, audioMasterProcessEvents, 0, 0, events, 0.0f);
+        return 1;
+    }
+    case effGetChunk:
+        plugin->state.magic = STATE_MAGIC;
+        memcpy(plugin->state.params, plugin->params, sizeof(plugin->state.params));
+        *(void **)ptr = &plugin->state;
+        return sizeof(ProbeState);
+    case effSetChunk: {
+        auto state = (const ProbeState *)ptr;
+        if (value != sizeof(ProbeState) || state->magic != STATE_MAGIC) {
+            return 0;
+        }
+        memcpy(plugin->params, state->params, sizeof(state->params));
+        plugin->updateIO();
+        plugin->updateFlags();
+        return 1;
+    }
+    case effGetEffectName:
+        strcpy((char *)ptr, "ProbePlugin");
+        return 1;
+    case effGetPlugCategory:
+        return kPlugCategEffect;
+    case effCanDo:
+        if (!strcmp((const char *)ptr, "receiveVstEvents") || !strcmp((const char *)ptr, "receiveVstMidiEvent") ||
+            !strcmp((const char *)ptr, "sendVstEvents") || !strcmp((const char *)ptr, "sendVstMidiEvent"))
+        {
+            return 1;
+        }
+        return -1;
+    case effGetVstVersion:
+        return kVstVersion;
+    }
+    return 0;
+}
+
+#define ALL_TIME_FIELDS (kVstPpqPosValid | kVstTempoValid | kVstBarsValid | kVstCyclePosValid | kVstTimeSigValid | kVstClockValid)
+
+static void readTime(ProbePlugin *plugin)
+{
+    auto filter = (VstIntPtr)plugin->params[kParamTimeFilter];
+    if (!filter) {
+        return;
+    }
+    auto first = (VstTimeInfo *)plugin->host(&plugin->effect, audioMasterGetTime, 0, filter, nullptr, 0.0f);
+    if (!first) {
+        return;
+    }
+    plugin->params[kParamTimeFlags] = (float)first->flags;
+    auto time = (VstTimeInfo *)plugin->host(&plugin->effect, audioMasterGetTime, 0, ALL_TIME_FIELDS, nullptr, 0.0f);
+    plugin->params[kParamTimeAllFlags] = (float)time->flags;
+    plugin->params[kParamTimeCached] = time == first ? 1.0f : 0.0f;
+    plugin->params[kParamTimeSamplePos] = (float)time->samplePos;
+    plugin->params[kParamTimePpqPos] = (float)time->ppqPos;
+    plugin->params[kParamTimeTempo] = (float)time->tempo;
+    plugin->params[kParamTimeBarStart] = (float)time->barStartPos;
+    plugin->params[kParamTimeSigNumerator] = (float)time->timeSigNumerator;
+}
+
+template <typename T>
+static void process(AEffect* effect, T** inputs, T** outputs, VstInt32 sampleFrames)
+{
+    auto plugin = (ProbePlugin *)effect->object;
+    readTime(plugin);
+    if (plugin->params[kParamBusy] > 0.0f) {
+        auto until = std::chrono::steady_clock::now() + std::chrono::microseconds((long long)(plugin->params[kParamBusy] * BUSY_SCALE));
+        while (std::chrono::steady_clock::now() < until) {
+        }
+    }
+    auto delay = (unsigned int)plugin->delay();
+    auto gain = (T)plugin->params[kParamGain];
+    for (VstInt32 i = 0; i < sampleFrames; i++) {
+        plugin->ring[plugin->writePos % MAX_DELAY] = (float)inputs[0][i];
+        outputs[0][i] = (T)plugin->ring[(plugin->writePos - delay) % MAX_DELAY] * gain;
+        plugin->writePos++;
+        outputs[1][i] = 0;
+    }
+    for (int channel = NUM_CHANNELS; channel < std::min(effect->numInputs, effect->numOutputs); channel++) {
+        for (VstInt32 i = 0; i < sampleFrames; i++) {
+            outputs[channel][i] = inputs[channel][i] * gain;
+        }
+    }
+    for (int i = 0; i < plugin->numEvents; i++) {
+        outputs[1][std::max(0, std::min(plugin->eventOffsets[i], sampleFrames - 1))] = 1;
+    }
+    plugin->numEvents = 0;
+    plugin->params[kParamCalls] += 1.0f;
+    plugin->params[kParamLastFrames] = (float)sampleFrames;
+    plugin->params[kParamMaxFrames] = std::max(plugin->params[kParamMaxFrames], (float)sampleFrames);
+}
+
+static void VSTCALLBACK processReplacingProc(AEffect* effect, float** inputs, float** outputs, VstInt32 sampleFrames)
+{
+    process(effect, inputs, outputs, sampleFrames);
+}
+
+static void VSTCALLBACK processDoubleReplacingProc(AEffect* effect, double** inputs, double** outputs, VstInt32 sampleFrames)
+{
+    process(effect, inputs, outputs, sampleFrames);
+    ((ProbePlugin *)effect->object)->params[kParamDoubleCalls] += 1.0f;
+}
+
+static void VSTCALLBACK setParameterProc(AEffect* effect, VstInt32 index, float parameter)
+{
+    auto plugin = (ProbePlugin *)effect->object;
+    if (index >= 0 && index < kNumStateParams) {
+        plugin->params[index] = parameter;
+    }
+    if ((index == kParamDelay || index == kParamWide) && plugin->updateIO()) {
+        plugin->host(effect, audioMasterIOChanged, 0, 0, nullptr, 0.0f);
+    }
+    if (index == kParamFloatOnly) {
+        plugin->updateFlags();
+    }
+}
+
+static float VSTCALLBACK getParameterProc(AEffect* effect, VstInt32 index)
+{
+    auto plugin = (ProbePlugin *)effect->object;
+    return (index >= 0 && index < kNumParams) ? plugin->params[index] : 0.0f;
+}
+
+ProbePlugin::ProbePlugin(audioMasterCallback host)
+    :host(host)
+{
+    memset(&effect, 0, sizeof(effect));
+    effect.magic = kEffectMagic;
+    effect.dispatcher = dispatcherProc;
+    effect.setParameter = setParameterProc;
+    effect.getParameter = getParameterProc;
+    effect.processReplacing = processReplacingProc;
+    effect.processDoubleReplacing = processDoubleReplacingProc;
+    effect.numPrograms = 1;
+    effect.numParams = kNumParams;
+    effect.numInputs = NUM_CHANNELS;
+    effect.numOutputs = NUM_CHANNELS;
+    effect.flags = effFlagsCanReplacing | effFlagsCanDoubleReplacing | effFlagsProgramChunks;
+    effect.object = this;
+    effect.uniqueID = CCONST('c', 'v', 'p', 'r');
+    effect.version = 1000;
+
+    params[kParamGain] = 1.0f;
+}
+
+PLUGIN_EXPORT AEffect *VSTPluginMain(audioMasterCallback host)
+{
+    auto plugin = new ProbePlugin(host);
+    return &plugin->effect;
+}
@@ -0,0 +1,65 @@
+// ProcessGroupTest.cpp : CVST_ProcessGroup -- every member is processed exactly once per block, into its own buffers,
+// whatever the number of workers (and with workers having gone to sleep between blocks)
+
+#include "TestCommon.h"
+
+#include <chrono>
+#include <memory>
+#include <thread>
+
+#define BLOCK_SIZE 64
+#define NUM_MEMBERS 12
+#define NUM_BLOCKS 200
+
+static void runGroup(int numWorkers)
+{
+    auto group = CVST_ProcessGroupCreate(numWorkers);
+    std::vector<CVST_Plugin> plugins;
+    std::vector<std::unique_ptr<TestBuffers<>>> inputs, outputs;
+    for (int i = 0; i < NUM_MEMBERS; i++) {
+        auto plugin = loadStarted(PROBEPLUGIN_PATH, BLOCK_SIZE);
+        setParameter(plugin, kProbeGain, (float)(i + 1));
+        setParameter(plugin, kProbeDelay, i / 1000.0f);
+        plugins.push_back(plugin);
+        inputs.emplace_back(new TestBuffers<>(2, BLOCK_SIZE));
+        outputs.emplace_back(new TestBuffers<>(2, BLOCK_SIZE));
+        CHECK(CVST_ProcessGroupAdd(group, plugin, inputs[i]->view(0), outputs[i]->view(0)) == i);
+    }
+
+    for (int block = 0; block < NUM_BLOCKS; block++) {
+        for (int i = 0; i < NUM_MEMBERS; i++) {
+            inputs[i]->clear();
+            (*inputs[i])[0][block % (BLOCK_SIZE - NUM_MEMBERS)] = 1.0f; // (so that nothing spills into the next block)
+        }
+        if (block % 50 == 49) {
+            // long enough for the workers to stop spinning and sleep
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        }
+        CVST_ProcessGroupProcess(group, BLOCK_SIZE);
+        for (int i = 0; i < NUM_MEMBERS; i++) {
+            auto at = (size_t)(block % (BLOCK_SIZE - NUM_MEMBERS) + i);
+            auto &output = (*outputs[i])[0];
+            CHECK(nonZero(output) == std::vector<size_t>{ at });
+            CHECK(output[at] == (float)(i + 1));
+        }
+    }
+    for (auto plugin : plugins) {
+        CHECK(getParameter(plugin, kProbeCalls) == NUM_BLOCKS);
+    }
+
+    CVST_ProcessGroupDestroy(group);
+    for (auto plugin : plugins) {
+        CVST_Destroy(plugin);
+    }
+}
+
+int main()
+{
+    CVST_Init(testCallback);
+    for (int numWorkers : { 1, 3, 7 }) { // (besides the calling thread)
+        runGroup(numWorkers);
+    }
+    CVST_Shutdown();
+    printf("ok\n");
+    return 0;
+}
@@ -0,0 +1,70 @@
+// RenderTest.cpp : CVST_RenderOffline -- events land on the frames they were given for, whatever the render's block size
+// (and in fixed block mode, with caller frames still in the FIFO), the output is delayed by CVST_GetLatency, and the
+// plugin's block size is put back afterwards
+
+#include "TestCommon.h"
+
+#define BLOCK_SIZE 256
+#define TOTAL_FRAMES 10000
+
+static std::vector<CVST_MidiEvent> makeEvents(const std::vector<unsigned long> &offsets)
+{
+    std::vector<CVST_MidiEvent> events(offsets.size());
+    for (size_t i = 0; i < offsets.size(); i++) {
+        events[i].sampleOffs = offsets[i];
+        events[i].data.uint32 = 0x00403C90; // note on
+    }
+    return events;
+}
+
+// renders silence plus 'events', returns the frames the probe marked (output 1)
+static std::vector<size_t> renderMarkers(CVST_Plugin plugin, int blockSize, std::vector<CVST_MidiEvent> events)
+{
+    TestBuffers<> inputs(2, TOTAL_FRAMES), outputs(2, TOTAL_FRAMES);
+    CVST_RenderOffline(plugin, inputs.view(0), outputs.view(0), TOTAL_FRAMES, blockSize, events.data(), (int)events.size());
+    return nonZero(outputs[1]);
+}
+
+int main()
+{
+    CVST_Init(testCallback);
+    auto plugin = loadStarted(PROBEPLUGIN_PATH, BLOCK_SIZE);
+
+    // events across render block boundaries, for a few block sizes
+    std::vector<unsigned long> offsets = { 0, 1, 999, 1000, 4095, 4096, 5001, 9999 };
+    for (int blockSize : { 1000, 333, 0 }) {
+        auto markers = renderMarkers(plugin, blockSize, makeEvents(offsets));
+        CHECK(markers == std::vector<size_t>(offsets.begin(), offsets.end()));
+    }
+    CHECK(getParameter(plugin, kProbeBlockSize) == BLOCK_SIZE);
+
+    // an impulse comes out CVST_GetLatency frames later
+    setParameter(plugin, kProbeDelay, 0.1f);
+    CHECK(CVST_GetLatency(plugin) == 100);
+    {
+        TestBuffers<> inputs(2, TOTAL_FRAMES), outputs(2, TOTAL_FRAMES);
+        inputs[0][500] = 1.0f;
+        CVST_RenderOffline(plugin, inputs.view(0), outputs.view(0), TOTAL_FRAMES, 512, nullptr, 0);
+        CHECK(nonZero(outputs[0]) == std::vector<size_t>{ 500 + 100 });
+    }
+    setParameter(plugin, kProbeDelay, 0.0f);
+
+    // fixed block mode, with part of a block already collected: events are on the caller's timeline, so they come out
+    // exactly one adapter block (its latency) later
+    CVST_Suspend(plugin);
+    CVST_SetBlockMode(plugin, BlockMode_Fixed, 64);
+    CVST_Resume(plugin);
+    CHECK(CVST_GetLatency(plugin) == 64);
+    {
+        TestBuffers<> inputs(2, 10), outputs(2, 10);
+        CVST_ProcessReplacing(plugin, inputs.view(0), outputs.view(0), 10);
+    }
+    auto markers = renderMarkers(plugin, 1000, makeEvents({ 0, 50, 2000, 5000 }));
+    CHECK((markers == std::vector<size_t>{ 64, 114, 2064, 5064 }));
+
+    CVST_Suspend(plugin);
+    CVST_Destroy(plugin);
+    CVST_Shutdown();
+    printf("ok\n");
+    return 0;
+}
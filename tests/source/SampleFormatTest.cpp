@@ -0,0 +1,171 @@
+// SampleFormatTest.cpp : CVST_ConvertToFloat / CVST_ConvertFromFloat -- the vector kernels give exactly what the
+// scalar ones do, for every format, planar and interleaved, routed or not, at lengths that leave vector tails
+// (registered twice: as is, and with CVSTHOST_NO_AVX2 set, so both the AVX2 and the SSE2 kernels are covered)
+
+#include "TestCommon.h"
+
+#include <stdint.h>
+#include <math.h>
+
+static const size_t formatBytes[] = { 2, 3, 4, 4, 8 };
+
+static float clampf(float x, float lo, float hi)
+{
+    return std::min(std::max(x, lo), hi);
+}
+
+// the scalar kernels' arithmetic, one sample at a time (see SampleFormat.cpp)
+static float scalarToFloat(CVST_SampleFormat format, const uint8_t *p)
+{
+    switch (format) {
+    case CVST_SampleFormat_Int16:
+        return *(const int16_t *)p * (1.0f / 32768.0f);
+    case CVST_SampleFormat_Int24:
+        return (float)((int32_t)(((uint32_t)p[0] << 8) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 24)) >> 8) * (1.0f / 8388608.0f);
+    case CVST_SampleFormat_Int32:
+        return (float)*(const int32_t *)p * (1.0f / 2147483648.0f);
+    case CVST_SampleFormat_Float32:
+        return *(const float *)p;
+    default:
+        return (float)*(const double *)p;
+    }
+}
+
+static void scalarFromFloat(CVST_SampleFormat format, float x, uint8_t *p)
+{
+    switch (format) {
+    case CVST_SampleFormat_Int16: {
+        auto value = (int16_t)lrintf(clampf(x * 32768.0f, -32768.0f, 32767.0f));
+        memcpy(p, &value, 2);
+        break;
+    }
+    case CVST_SampleFormat_Int24: {
+        auto value = (int32_t)lrintf(clampf(x * 8388608.0f, -8388608.0f, 8388607.0f));
+        p[0] = (uint8_t)value;
+        p[1] = (uint8_t)(value >> 8);
+        p[2] = (uint8_t)(value >> 16);
+        break;
+    }
+    case CVST_SampleFormat_Int32: {
+        auto value = (int32_t)lrintf(clampf(x * 2147483648.0f, -2147483648.0f, 2147483520.0f));
+        memcpy(p, &value, 4);
+        break;
+    }
+    case CVST_SampleFormat_Float32:
+        memcpy(p, &x, 4);
+        break;
+    default: {
+        double value = x;
+        memcpy(p, &value, 8);
+    }
+    }
+}
+
+// slightly beyond full scale (so clipping is covered), with exact rounding ties mixed in
+static float testSample(CVST_SampleFormat format)
+{
+    if (rand() % 8 == 0) {
+        auto scale = format == CVST_SampleFormat_Int16 ? 32768.0f : 8388608.0f;
+        return (float)(rand() % 2001 - 1000) / scale + 0.5f / scale;
+    }
+    return ((float)rand() / RAND_MAX) * 2.2f - 1.1f;
+}
+
+static void runCase(CVST_SampleFormat format, bool interleaved, int numChannels, bool routed, unsigned int frames)
+{
+    CVST_BufferLayout layout;
+    layout.format = format;
+    layout.numChannels = numChannels;
+    layout.interleaved = interleaved;
+
+    // reversed, with one channel silenced and one out of range
+    std::vector<int> routing(numChannels);
+    for (int i = 0; i < numChannels; i++) {
+        routing[i] = numChannels - 1 - i;
+    }
+    if (numChannels > 1) {
+        routing[1] = -1;
+        routing[0] = numChannels;
+    }
+    auto routeOf = [&](int i) {
+        auto ch = routed ? routing[i] : i;
+        return ch < numChannels ? ch : -1;
+    };
+
+    auto bytes = formatBytes[format];
+    std::vector<uint8_t> driver(bytes * frames * numChannels);
+    std::vector<void *> driverPtrs;
+    for (int ch = 0; ch < numChannels; ch++) {
+        driverPtrs.push_back(interleaved ? driver.data() : driver.data() + bytes * frames * ch);
+    }
+    auto sampleAt = [&](int ch, unsigned int frame) {
+        return interleaved ? driver.data() + (frame * numChannels + ch) * bytes : driver.data() + (ch * frames + frame) * bytes;
+    };
+    TestBuffers<> plugin(numChannels, frames);
+    for (int ch = 0; ch < numChannels; ch++) {
+        for (unsigned int i = 0; i < frames; i++) {
+            plugin[ch][i] = testSample(format);
+        }
+    }
+    auto pluginRouting = routed ? routing.data() : nullptr;
+
+    // float -> driver, byte for byte
+    CVST_ConvertFromFloat(&layout, plugin.view(0), numChannels, driverPtrs.data(), pluginRouting, frames);
+    uint8_t expected[8];
+    for (int ch = 0; ch < numChannels; ch++) {
+        for (unsigned int i = 0; i < frames; i++) {
+            auto source = routeOf(ch);
+            memset(expected, 0, sizeof(expected));
+            if (source >= 0) {
+                scalarFromFloat(format, plugin[source][i], expected);
+            }
+            CHECK(memcmp(sampleAt(ch, i), expected, bytes) == 0);
+        }
+    }
+
+    // driver -> float, bit for bit (from what was just written, so every value is in range)
+    CVST_ConvertToFloat(&layout, driverPtrs.data(), plugin.view(0), numChannels, pluginRouting, frames);
+    for (int ch = 0; ch < numChannels; ch++) {
+        for (unsigned int i = 0; i < frames; i++) {
+            auto source = routeOf(ch);
+            auto value = source >= 0 ? scalarToFloat(format, sampleAt(source, i)) : 0.0f;
+            CHECK(memcmp(&plugin[ch][i], &value, sizeof(float)) == 0);
+        }
+    }
+}
+
+int main()
+{
+    srand(1234);
+    std::vector<unsigned int> lengths;
+    for (unsigned int frames = 0; frames <= 40; frames++) { // every tail, for every vector width
+        lengths.push_back(frames);
+    }
+    lengths.push_back(1021);
+    lengths.push_back(4099); // more than one interleave chunk
+
+    for (int format = CVST_SampleFormat_Int16; format <= CVST_SampleFormat_Float64; format++) {
+        for (bool interleaved : { false, true }) {
+            for (int numChannels : { 1, 3, 8 }) {
+                for (bool routed : { false, true }) {
+                    for (auto frames : lengths) {
+                        runCase((CVST_SampleFormat)format, interleaved, numChannels, routed, frames);
+                    }
+                }
+            }
+        }
+    }
+
+    // no driver channels: the plugin's are silenced, and nothing else is touched
+    for (bool interleaved : { false, true }) {
+        CVST_BufferLayout layout = { CVST_SampleFormat_Int16, 0, interleaved };
+        TestBuffers<> plugin(2, 64);
+        plugin[0][10] = 1.0f;
+        CVST_ConvertFromFloat(&layout, plugin.view(0), 2, nullptr, nullptr, 64);
+        CVST_ConvertToFloat(&layout, nullptr, plugin.view(0), 2, nullptr, 64);
+        CHECK(nonZero(plugin[0]).empty() && nonZero(plugin[1]).empty());
+    }
+
+    printf("ok\n");
+    return 0;
+}
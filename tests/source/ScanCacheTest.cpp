@@ -0,0 +1,79 @@
+// ScanCacheTest.cpp : CVST_ScanCache -- scanned info survives a reopen, unchanged binaries aren't loaded again, changed
+// ones are, a plugin that crashes (bridged) or a file that isn't one is just marked failed, and an index that doesn't
+// check out is scanned again from scratch
+
+#include "TestCommon.h"
+
+#define INDEX_PATH "ScanCacheTest.index"
+#define BOGUS_PATH "ScanCacheTest.bogus"
+
+static const char *paths[] = { PROBEPLUGIN_PATH, TESTPLUGIN_PATH, CRASHPLUGIN_PATH, BOGUS_PATH, "ScanCacheTest.missing" };
+static const int numPaths = sizeof(paths) / sizeof(paths[0]);
+
+static bool scannedInfo(CVST_ScanCache cache, const char *path, CVST_PluginInfo *info)
+{
+    auto index = CVST_ScanCacheFind(cache, path);
+    CHECK(index >= 0);
+    CHECK(!strcmp(CVST_ScanCacheGetPath(cache, index), path));
+    return CVST_ScanCacheGetInfo(cache, index, info);
+}
+
+// the index as written by an update of 'paths': the missing path dropped, sorted, probe and test plugin scanned
+static void checkIndex(CVST_ScanCache cache)
+{
+    CHECK(CVST_ScanCacheGetCount(cache) == numPaths - 1);
+    for (int i = 1; i < CVST_ScanCacheGetCount(cache); i++) {
+        CHECK(strcmp(CVST_ScanCacheGetPath(cache, i - 1), CVST_ScanCacheGetPath(cache, i)) < 0);
+    }
+    CHECK(CVST_ScanCacheFind(cache, "ScanCacheTest.missing") == -1);
+    CVST_PluginInfo info;
+    CHECK(scannedInfo(cache, PROBEPLUGIN_PATH, &info));
+    CHECK(!strcmp(info.name, "ProbePlugin"));
+    CHECK(info.numInputs == 2 && info.numOutputs == 2 && info.numParams == kNumProbeParams);
+    CHECK(scannedInfo(cache, TESTPLUGIN_PATH, &info));
+    CHECK(!scannedInfo(cache, CRASHPLUGIN_PATH, &info));
+    CHECK(!scannedInfo(cache, BOGUS_PATH, &info));
+}
+
+int main()
+{
+    CVST_Init(testCallback);
+    CVST_SetBridgePath(CVSTBRIDGE_PATH);
+    remove(INDEX_PATH);
+    writeFile(BOGUS_PATH, "not a plugin");
+
+    // first scan (the crashing plugin takes only its bridge process down)
+    auto cache = CVST_ScanCacheOpen(INDEX_PATH);
+    CHECK(CVST_ScanCacheGetCount(cache) == 0);
+    CHECK(CVST_ScanCacheUpdate(cache, paths, numPaths, 0) == numPaths - 1);
+    checkIndex(cache);
+    CVST_ScanCacheClose(cache);
+
+    // reopened: all there, nothing to scan again -- until a binary changes
+    cache = CVST_ScanCacheOpen(INDEX_PATH);
+    checkIndex(cache);
+    CHECK(CVST_ScanCacheUpdate(cache, paths, numPaths, 2) == 0);
+    checkIndex(cache);
+    writeFile(BOGUS_PATH, "still not a plugin");
+    CHECK(CVST_ScanCacheUpdate(cache, paths, numPaths, 2) == 1);
+    checkIndex(cache);
+    CVST_ScanCacheClose(cache);
+
+    // a damaged index counts as empty, and is rebuilt by the next update
+    auto index = readFile(INDEX_PATH);
+    for (auto damaged : { index.substr(0, index.size() / 2), std::string(index.size(), 'x') }) {
+        writeFile(INDEX_PATH, damaged);
+        cache = CVST_ScanCacheOpen(INDEX_PATH);
+        CHECK(CVST_ScanCacheGetCount(cache) == 0);
+        CHECK(CVST_ScanCacheFind(cache, PROBEPLUGIN_PATH) == -1);
+        CHECK(CVST_ScanCacheUpdate(cache, paths, numPaths, 0) == numPaths - 1);
+        checkIndex(cache);
+        CVST_ScanCacheClose(cache);
+    }
+
+    remove(INDEX_PATH);
+    remove(BOGUS_PATH);
+    CVST_Shutdown();
+    printf("ok\n");
+    return 0;
+}
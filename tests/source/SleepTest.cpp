@@ -0,0 +1,138 @@
+// SleepTest.cpp : CVST_SetSleepMode -- the plugin stops being called once its input has been silent for longer than its
+// tail plus its latency (outputs zeroed), and input over the threshold, MIDI, held notes (and the sustain pedal) wake it
+// or keep it awake; off, it's always called
+
+#include "TestCommon.h"
+
+#include <math.h>
+
+#define BLOCK_SIZE 100
+
+static float calls(CVST_Plugin plugin)
+{
+    return getParameter(plugin, kProbeCalls);
+}
+
+// a block at 'level' (alternating sign) on both inputs, returns the peak output
+static float processBlock(CVST_Plugin plugin, float level, CVST_MidiEvent *events = nullptr, int numEvents = 0)
+{
+    TestBuffers<> inputs(2, BLOCK_SIZE), outputs(2, BLOCK_SIZE);
+    for (int i = 0; i < BLOCK_SIZE; i++) {
+        inputs[0][i] = inputs[1][i] = i % 2 ? level : -level;
+    }
+    for (auto &channel : outputs.channels) {
+        std::fill(channel.begin(), channel.end(), 1.0f); // (so that zeroing shows)
+    }
+    if (numEvents > 0) {
+        CVST_SetBlockEvents(plugin, events, numEvents);
+    }
+    CVST_ProcessReplacing(plugin, inputs.view(0), outputs.view(0), BLOCK_SIZE);
+    float peak = 0.0f;
+    for (auto &channel : outputs.channels) {
+        for (auto x : channel) {
+            peak = std::max(peak, fabsf(x));
+        }
+    }
+    return peak;
+}
+
+static void processSilence(CVST_Plugin plugin, int numBlocks)
+{
+    for (int i = 0; i < numBlocks; i++) {
+        processBlock(plugin, 0.0f);
+    }
+}
+
+static CVST_MidiEvent midi(unsigned long sampleOffs, unsigned int data)
+{
+    CVST_MidiEvent event;
+    event.sampleOffs = sampleOffs;
+    event.data.uint32 = data;
+    return event;
+}
+
+int main()
+{
+    CVST_Init(testCallback);
+    auto plugin = loadStarted(PROBEPLUGIN_PATH, BLOCK_SIZE);
+    setParameter(plugin, kProbeTail, 0.01f); // 1000 frames
+    CVST_SetSleepMode(plugin, true, 5000, 0.0f);
+    CHECK(!CVST_IsSleeping(plugin));
+
+    // 10 blocks of tail still go through, then it sleeps: not called, outputs zeroed, the sample clock going on
+    CHECK(processBlock(plugin, 0.5f) == 0.5f);
+    auto awake = calls(plugin);
+    processSilence(plugin, 20);
+    CHECK(calls(plugin) == awake + 10);
+    CHECK(CVST_IsSleeping(plugin));
+    CHECK(processBlock(plugin, 0.0f) == 0.0f);
+    CHECK(CVST_GetSamplePosition(plugin) == 22 * BLOCK_SIZE);
+
+    // input wakes it, right away
+    CHECK(processBlock(plugin, 0.1f) == 0.1f);
+    CHECK(!CVST_IsSleeping(plugin));
+    awake = calls(plugin);
+    processSilence(plugin, 20);
+    CHECK(calls(plugin) == awake + 10 && CVST_IsSleeping(plugin));
+
+    // latency is waited for too
+    setParameter(plugin, kProbeDelay, 0.1f); // 100 frames
+    processBlock(plugin, 0.5f);
+    awake = calls(plugin);
+    processSilence(plugin, 20);
+    CHECK(calls(plugin) == awake + 11 && CVST_IsSleeping(plugin));
+    setParameter(plugin, kProbeDelay, 0.0f);
+    processSilence(plugin, 20);
+    CHECK(CVST_IsSleeping(plugin));
+
+    // MIDI wakes it, and a held note keeps it awake however long the silence
+    auto noteOn = midi(50, 0x00403C90), noteOff = midi(0, 0x00003C80);
+    awake = calls(plugin);
+    processBlock(plugin, 0.0f, &noteOn, 1);
+    processSilence(plugin, 30);
+    CHECK(calls(plugin) == awake + 31 && !CVST_IsSleeping(plugin));
+    processBlock(plugin, 0.0f, &noteOff, 1);
+    processSilence(plugin, 30);
+    CHECK(CVST_IsSleeping(plugin));
+
+    // so does the sustain pedal, until it's let go of (with the note released under it)
+    CVST_MidiEvent pedal[3] = { midi(0, 0x007F40B0), midi(1, 0x00503D90), midi(2, 0x00003D80) };
+    processBlock(plugin, 0.0f, pedal, 3);
+    processSilence(plugin, 30);
+    CHECK(!CVST_IsSleeping(plugin));
+    auto pedalUp = midi(0, 0x000040B0);
+    processBlock(plugin, 0.0f, &pedalUp, 1);
+    processSilence(plugin, 30);
+    CHECK(CVST_IsSleeping(plugin));
+
+    // a threshold: anything up to it is silence
+    CVST_SetSleepMode(plugin, true, 5000, 1e-5f);
+    processSilence(plugin, 20);
+    CHECK(CVST_IsSleeping(plugin));
+    processBlock(plugin, 1e-6f);
+    CHECK(CVST_IsSleeping(plugin));
+    processBlock(plugin, 1e-4f);
+    CHECK(!CVST_IsSleeping(plugin));
+
+    // a plugin that doesn't know its tail gets the fallback (5000 frames)
+    setParameter(plugin, kProbeTail, 0.0f);
+    CVST_Suspend(plugin);
+    CVST_Resume(plugin);
+    processBlock(plugin, 0.5f);
+    awake = calls(plugin);
+    processSilence(plugin, 60);
+    CHECK(calls(plugin) == awake + 50 && CVST_IsSleeping(plugin));
+
+    // off: always called
+    CVST_SetSleepMode(plugin, false, 0, 0.0f);
+    CHECK(!CVST_IsSleeping(plugin));
+    awake = calls(plugin);
+    processSilence(plugin, 10);
+    CHECK(calls(plugin) == awake + 10);
+
+    CVST_Suspend(plugin);
+    CVST_Destroy(plugin);
+    CVST_Shutdown();
+    printf("ok\n");
+    return 0;
+}
@@ -0,0 +1,131 @@
+// StatsTest.cpp : CVST_GetStats -- block times and loads against the deadline, overruns counted against the budget,
+// event dispatch time, resets at the next block, and snapshots that are consistent while the audio thread writes
+// (only lower bounds on times are checked, or bounds with plenty of room: the machine may be busy)
+
+#include "TestCommon.h"
+
+#include <math.h>
+#include <atomic>
+#include <thread>
+
+#define BLOCK_SIZE 256
+#define SAMPLE_RATE 44100.0f
+#define DEADLINE_US (BLOCK_SIZE * 1e6 / SAMPLE_RATE) // ~5805
+#define BUSY_US 2000.0
+
+static void process(CVST_Plugin plugin, int numBlocks, unsigned int blockSize = BLOCK_SIZE)
+{
+    TestBuffers<> inputs(2, blockSize), outputs(2, blockSize);
+    for (int i = 0; i < numBlocks; i++) {
+        CVST_ProcessReplacing(plugin, inputs.view(0), outputs.view(0), blockSize);
+    }
+}
+
+static CVST_Stats stats(CVST_Plugin plugin)
+{
+    CVST_Stats result;
+    CVST_GetStats(plugin, &result);
+    return result;
+}
+
+// what a consistent snapshot always has (averages up to rounding)
+static bool consistent(const CVST_Stats &s)
+{
+    unsigned long long inHistogram = 0;
+    for (auto count : s.histogram) {
+        inHistogram += count;
+    }
+    return inHistogram == s.blocks && s.overruns <= s.blocks && s.lastTime <= s.maxTime && s.avgTime <= s.maxTime * (1 + 1e-9) &&
+        s.lastLoad <= s.maxLoad && s.avgLoad <= s.maxLoad * (1 + 1e-9) && s.lastEventTime <= s.maxEventTime;
+}
+
+int main()
+{
+    CVST_Init(testCallback);
+    auto plugin = loadStarted(PROBEPLUGIN_PATH, BLOCK_SIZE, SAMPLE_RATE);
+    CVST_ResetStats(plugin);
+    process(plugin, 1);
+    CHECK(stats(plugin).blocks == 1);
+
+    // blocks taking ~2 ms (over a third of the deadline): over a budget of a tenth, every one
+    CVST_ResetStats(plugin);
+    CVST_SetStatsBudget(plugin, 0.1);
+    setParameter(plugin, kProbeBusy, (float)(BUSY_US / 10000.0));
+    process(plugin, 10);
+    {
+        auto s = stats(plugin);
+        CHECK(consistent(s));
+        CHECK(s.blocks == 10 && s.overruns == 10);
+        CHECK(s.lastTime >= BUSY_US && s.avgTime >= BUSY_US);
+        CHECK(s.lastLoad >= BUSY_US / DEADLINE_US && s.avgLoad >= BUSY_US / DEADLINE_US);
+        CHECK(fabs(s.maxLoad - s.maxTime / DEADLINE_US) < 1e-6);
+        // (all in the buckets from [1024, 2048) us up)
+        unsigned long long slow = 0;
+        for (int i = 11; i < CVST_STATS_HISTOGRAM_BUCKETS; i++) {
+            slow += s.histogram[i];
+        }
+        CHECK(slow == 10);
+    }
+
+    // quick ones (a few us) are well inside half the deadline: no further overruns, and the maximum is kept
+    CVST_SetStatsBudget(plugin, 0.5);
+    setParameter(plugin, kProbeBusy, 0.0f);
+    process(plugin, 10);
+    {
+        auto s = stats(plugin);
+        CHECK(consistent(s));
+        CHECK(s.blocks == 20 && s.overruns == 10);
+        CHECK(s.maxTime >= BUSY_US && s.lastTime < s.maxTime);
+    }
+
+    // a reset shows at the next block, not before
+    CVST_ResetStats(plugin);
+    CHECK(stats(plugin).blocks == 20);
+    process(plugin, 1);
+    {
+        auto s = stats(plugin);
+        CHECK(s.blocks == 1 && s.overruns == 0 && s.maxTime < BUSY_US);
+    }
+
+    // event dispatch is accounted separately, per block
+    {
+        CVST_MidiEvent note;
+        note.sampleOffs = 10;
+        note.data.uint32 = 0x00403C90;
+        CVST_SetBlockEvents(plugin, &note, 1);
+        process(plugin, 1);
+        auto s = stats(plugin);
+        CHECK(s.lastEventTime > 0.0 && s.lastEventTime <= s.lastTime);
+        process(plugin, 1);
+        s = stats(plugin);
+        CHECK(s.lastEventTime == 0.0 && s.maxEventTime > 0.0);
+    }
+
+    // read from another thread while blocks are written: never a snapshot from halfway through an update
+    {
+        CVST_ResetStats(plugin);
+        std::atomic<bool> done{ false };
+        std::atomic<long> snapshots{ 0 }, inconsistent{ 0 };
+        std::thread monitor([&]() {
+            while (!done.load()) {
+                if (!consistent(stats(plugin))) {
+                    inconsistent++;
+                }
+                snapshots++;
+            }
+        });
+        while (snapshots.load() == 0) { // (it's running)
+            std::this_thread::yield();
+        }
+        process(plugin, 20000, 32);
+        done = true;
+        monitor.join();
+        CHECK(inconsistent == 0);
+        CHECK(stats(plugin).blocks == 20000);
+    }
+
+    CVST_Destroy(plugin);
+    CVST_Shutdown();
+    printf("ok\n");
+    return 0;
+}
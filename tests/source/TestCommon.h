@@ -0,0 +1,185 @@
+#ifndef __CVSTHOST_TESTCOMMON_H__
+#define __CVSTHOST_TESTCOMMON_H__
+
+// shared bits of the tests: each one is a small program that exits non-zero at the first failed CHECK
+// (plugin paths come from CMake, see CMakeLists.txt)
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "../../source/CVSTHost.h"
+
+#ifndef PROBEPLUGIN_PATH
+#define PROBEPLUGIN_PATH "probeplugin.so"
+#endif
+#ifndef TESTPLUGIN_PATH
+#define TESTPLUGIN_PATH "testplugin.so"
+#endif
+#ifndef CRASHPLUGIN_PATH
+#define CRASHPLUGIN_PATH "crashplugin.so"
+#endif
+#ifndef CVSTBRIDGE_PATH
+#define CVSTBRIDGE_PATH "cvstbridge"
+#endif
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+        exit(1); \
+    } \
+} while (0)
+
+// the probe plugin's parameters (see ProbePlugin.cpp)
+enum ProbeParams {
+    kProbeDelay, // * 1000 frames
+    kProbeTail, // * 100000 frames
+    kProbeGain,
+    kProbeWide, // (40 channels each way)
+    kProbeFloatOnly, // (no effFlagsCanDoubleReplacing)
+    kProbeTimeFilter, // (raw kVst*Valid mask)
+    kProbeBusy, // * 10 ms per process call
+    kProbeCalls, // (read-only from here, raw values)
+    kProbeLastFrames,
+    kProbeMaxFrames,
+    kProbeSampleRate,
+    kProbeBlockSize,
+    kProbeEvents,
+    kProbeDoubleCalls,
+    kProbeTimeFlags,
+    kProbeTimeAllFlags,
+    kProbeTimeCached,
+    kProbeTimeSamplePos,
+    kProbeTimePpqPos,
+    kProbeTimeTempo,
+    kProbeTimeBarStart,
+    kProbeTimeSigNumerator,
+    kNumProbeParams
+};
+
+// log messages are collected (warnings and up are printed too), so tests can check something was reported
+static std::vector<std::string> testLog;
+
+inline int CDECL testCallback(CVST_HostEvent *event, CVST_Plugin, void *)
+{
+    event->handled = true;
+    switch (event->eventType) {
+    case CVST_EventType_Log:
+        testLog.push_back(event->logEvent.message);
+        if (event->logEvent.level >= CVST_LogLevel_Warning) {
+            printf("VST>> %s\n", event->logEvent.message);
+        }
+        break;
+    case CVST_EventType_GetVendorInfo:
+        event->vendorInfoEvent.vendor = "CVSTHost";
+        event->vendorInfoEvent.product = "Tests";
+        event->vendorInfoEvent.version = 1;
+        break;
+    default:
+        event->handled = false;
+    }
+    return 0;
+}
+
+// whether anything logged since the last call contains 'text' (and forgets it all)
+inline bool takeLogged(const char *text)
+{
+    CVST_DrainLog();
+    bool found = false;
+    for (auto &message : testLog) {
+        found = found || strstr(message.c_str(), text) != nullptr;
+    }
+    testLog.clear();
+    return found;
+}
+
+inline float getParameter(CVST_Plugin plugin, int index)
+{
+    CVST_RefreshParameters(plugin);
+    float value = 0.0f;
+    CVST_GetParameters(plugin, index, &value, 1);
+    return value;
+}
+
+inline void setParameter(CVST_Plugin plugin, int index, float value)
+{
+    CVST_SetParameters(plugin, index, &value, 1);
+}
+
+// loaded, started, and resumed at blockSize
+inline CVST_Plugin loadStarted(const char *path, int blockSize, float sampleRate = 44100.0f)
+{
+    auto plugin = CVST_LoadPlugin(path, nullptr);
+    CHECK(plugin != nullptr);
+    CVST_Start(plugin, sampleRate);
+    CVST_SetBlockSize(plugin, blockSize);
+    CVST_Resume(plugin);
+    return plugin;
+}
+
+// numChannels x frames of zeros, with a float ** view (offset by 'at' frames, see view())
+template <typename T = float>
+struct TestBuffers {
+    std::vector<std::vector<T>> channels;
+    std::vector<T *> ptrs;
+
+    TestBuffers(int numChannels, size_t frames)
+        :channels(numChannels, std::vector<T>(frames, (T)0)), ptrs(numChannels) {
+        view(0);
+    }
+
+    T **view(size_t at) {
+        for (size_t i = 0; i < channels.size(); i++) {
+            ptrs[i] = channels[i].data() + at;
+        }
+        return ptrs.data();
+    }
+
+    void clear() {
+        for (auto &channel : channels) {
+            std::fill(channel.begin(), channel.end(), (T)0);
+        }
+    }
+
+    std::vector<T> &operator[](size_t channel) { return channels[channel]; }
+};
+
+// (scratch files for the tests are written to the working directory, which for ctest is the build directory)
+inline void writeFile(const char *path, const std::string &contents)
+{
+    auto file = fopen(path, "wb");
+    CHECK(file != nullptr);
+    CHECK(fwrite(contents.data(), 1, contents.size(), file) == contents.size());
+    fclose(file);
+}
+
+inline std::string readFile(const char *path)
+{
+    std::string contents;
+    auto file = fopen(path, "rb");
+    CHECK(file != nullptr);
+    char buffer[4096];
+    for (size_t length; (length = fread(buffer, 1, sizeof(buffer), file)) > 0; ) {
+        contents.append(buffer, length);
+    }
+    fclose(file);
+    return contents;
+}
+
+// frames of 'channel' that aren't zero
+template <typename T>
+inline std::vector<size_t> nonZero(const std::vector<T> &channel)
+{
+    std::vector<size_t> result;
+    for (size_t i = 0; i < channel.size(); i++) {
+        if (channel[i] != 0) {
+            result.push_back(i);
+        }
+    }
+    return result;
+}
+
+#endif // __CVSTHOST_TESTCOMMON_H__
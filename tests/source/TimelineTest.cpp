@@ -0,0 +1,95 @@
+// TimelineTest.cpp : the MIDI timeline -- batches from several sources, unsorted and interleaved with each other, come
+// out in order (events on the same frame in the order they were scheduled), events past the block wait for theirs,
+// those scheduled ahead or in the past land where they should, and a full timeline drops from the end of the batch
+
+#include "TestCommon.h"
+
+#define BLOCK_SIZE 256
+
+typedef std::vector<std::pair<unsigned long, int>> Received; // (frame, note), in the order the plugin got them
+
+// a note numbered 'note' at each frame
+static std::vector<CVST_MidiEvent> notes(const Received &at)
+{
+    std::vector<CVST_MidiEvent> events(at.size());
+    for (size_t i = 0; i < at.size(); i++) {
+        events[i].sampleOffs = at[i].first;
+        events[i].data.uint32 = 0x00400090 | (at[i].second << 8);
+    }
+    return events;
+}
+
+static void setEvents(CVST_Plugin plugin, const Received &at)
+{
+    auto events = notes(at);
+    CVST_SetBlockEvents(plugin, events.data(), (int)events.size());
+}
+
+// processes a block, returns what the plugin received (it echoes it back, in order)
+static Received process(CVST_Plugin plugin)
+{
+    TestBuffers<> inputs(2, BLOCK_SIZE), outputs(2, BLOCK_SIZE);
+    CVST_ProcessReplacing(plugin, inputs.view(0), outputs.view(0), BLOCK_SIZE);
+    int numEvents = 0;
+    auto events = CVST_GetOutputEvents(plugin, &numEvents);
+    Received received;
+    for (int i = 0; i < numEvents; i++) {
+        received.push_back(std::make_pair(events[i].sampleOffs, (int)((events[i].data.uint32 >> 8) & 0x7F)));
+    }
+    return received;
+}
+
+int main()
+{
+    CVST_Init(testCallback);
+    auto plugin = loadStarted(PROBEPLUGIN_PATH, BLOCK_SIZE);
+
+    // two ports' worth, each unsorted (several runs), overlapping each other, one past the block
+    setEvents(plugin, { { 50, 1 }, { 10, 2 }, { 30, 3 }, { 30, 4 }, { 5, 5 } });
+    setEvents(plugin, { { 30, 6 }, { 7, 7 }, { 300, 8 }, { 200, 9 } });
+    CHECK((process(plugin) == Received{ { 5, 5 }, { 7, 7 }, { 10, 2 }, { 30, 3 }, { 30, 4 }, { 30, 6 }, { 50, 1 }, { 200, 9 } }));
+    CHECK((process(plugin) == Received{ { 300 - BLOCK_SIZE, 8 } }));
+
+    // scheduled ahead (absolute, unsorted, a block and more away) and into the past (due first, at the start of the
+    // block), merged with block events
+    auto now = CVST_GetSamplePosition(plugin);
+    CHECK(now == 2 * BLOCK_SIZE);
+    {
+        auto ahead = notes({ { BLOCK_SIZE + 20, 10 }, { 40, 11 }, { BLOCK_SIZE + 3, 12 } });
+        CVST_ScheduleEvents(plugin, now, ahead.data(), (int)ahead.size());
+        auto late = notes({ { 0, 13 } });
+        CVST_ScheduleEvents(plugin, now - 100, late.data(), 1);
+    }
+    setEvents(plugin, { { 40, 14 }, { 0, 15 } });
+    CHECK((process(plugin) == Received{ { 0, 13 }, { 0, 15 }, { 40, 11 }, { 40, 14 } }));
+    CHECK((process(plugin) == Received{ { 3, 12 }, { 20, 10 } }));
+
+    // one event per run, into a timeline that already has some: in order all the same
+    {
+        Received pending = { { 101, 100 }, { 51, 101 }, { 151, 102 } }, descending;
+        for (int i = 0; i < 60; i++) {
+            descending.push_back(std::make_pair((unsigned long)(180 - 3 * i), i));
+        }
+        setEvents(plugin, pending);
+        setEvents(plugin, descending);
+        auto expected = pending;
+        expected.insert(expected.end(), descending.begin(), descending.end());
+        std::stable_sort(expected.begin(), expected.end(), [](const std::pair<unsigned long, int> &a, const std::pair<unsigned long, int> &b) {
+            return a.first < b.first;
+        });
+        CHECK(process(plugin) == expected);
+    }
+
+    // full: what doesn't fit is dropped from the end of the batch (and said so), whatever its position
+    CVST_SetEventCapacity(plugin, 8, 64);
+    setEvents(plugin, { { 60, 1 }, { 20, 2 }, { 40, 3 } });
+    takeLogged("");
+    setEvents(plugin, { { 50, 4 }, { 10, 5 }, { 70, 6 }, { 30, 7 }, { 80, 8 }, { 0, 9 }, { 90, 10 } });
+    CHECK(takeLogged("dropped 2"));
+    CHECK((process(plugin) == Received{ { 10, 5 }, { 20, 2 }, { 30, 7 }, { 40, 3 }, { 50, 4 }, { 60, 1 }, { 70, 6 }, { 80, 8 } }));
+
+    CVST_Destroy(plugin);
+    CVST_Shutdown();
+    printf("ok\n");
+    return 0;
+}
@@ -0,0 +1,87 @@
+// TransportTest.cpp : audioMasterGetTime -- one VstTimeInfo per (sub-)block, filled with the fields the plugin's filter
+// mask asks for and no others (more being added if a later request asks for them, in the same struct), following the
+// transport as it's set and as the blocks advance it
+
+#include "TestCommon.h"
+#include "../../deps/VST2_SDK/pluginterfaces/vst2.x/aeffectx.h"
+
+#include <math.h>
+
+#define BLOCK_SIZE 256
+#define SAMPLE_RATE 44100.0
+#define ALL_TIME_FIELDS (kVstPpqPosValid | kVstTempoValid | kVstBarsValid | kVstCyclePosValid | kVstTimeSigValid | kVstClockValid)
+
+static void process(CVST_Plugin plugin, const std::vector<CVST_ParameterChange> &changes = {})
+{
+    if (!changes.empty()) {
+        CVST_SetBlockParameterChanges(plugin, changes.data(), (int)changes.size());
+    }
+    TestBuffers<> inputs(2, BLOCK_SIZE), outputs(2, BLOCK_SIZE);
+    CVST_ProcessReplacing(plugin, inputs.view(0), outputs.view(0), BLOCK_SIZE);
+}
+
+// the flags of the probe's first request (with its filter) in the last process call
+static int firstFlags(CVST_Plugin plugin)
+{
+    return (int)getParameter(plugin, kProbeTimeFlags);
+}
+
+int main()
+{
+    CVST_Init(testCallback);
+    auto plugin = loadStarted(PROBEPLUGIN_PATH, BLOCK_SIZE, (float)SAMPLE_RATE);
+
+    // stopped, defaults: just the tempo asked for, and only that computed; then the rest, in the same struct
+    setParameter(plugin, kProbeTimeFilter, (float)kVstTempoValid);
+    process(plugin);
+    CHECK(firstFlags(plugin) == (kVstTransportChanged | kVstTempoValid));
+    CHECK((int)getParameter(plugin, kProbeTimeAllFlags) == (kVstTransportChanged | ALL_TIME_FIELDS));
+    CHECK(getParameter(plugin, kProbeTimeCached) == 1.0f);
+    CHECK(getParameter(plugin, kProbeTimeTempo) == 120.0f && getParameter(plugin, kProbeTimeSigNumerator) == 4.0f);
+    CHECK(getParameter(plugin, kProbeTimeSamplePos) == 0.0f);
+
+    // playing from bar 3 of a 3/4 song: the next block starts there, the transport change is flagged once
+    CVST_Transport transport;
+    CVST_GetTransport(plugin, &transport);
+    transport.playing = true;
+    transport.tempo = 90.0;
+    transport.timeSigNumerator = 3;
+    transport.samplePos = 1000.0;
+    transport.ppqPos = 7.0;
+    CVST_SetTransport(plugin, &transport);
+    setParameter(plugin, kProbeTimeFilter, (float)(kVstPpqPosValid | kVstTimeSigValid));
+    process(plugin);
+    CHECK(firstFlags(plugin) == (kVstTransportChanged | kVstTransportPlaying | kVstPpqPosValid | kVstTimeSigValid));
+    CHECK(getParameter(plugin, kProbeTimeSamplePos) == 1000.0f && getParameter(plugin, kProbeTimePpqPos) == 7.0f);
+    CHECK(getParameter(plugin, kProbeTimeTempo) == 90.0f && getParameter(plugin, kProbeTimeSigNumerator) == 3.0f);
+    CHECK(getParameter(plugin, kProbeTimeBarStart) == 6.0f);
+
+    // a block later: advanced by it, no longer 'changed', and nothing computed beyond the filter
+    setParameter(plugin, kProbeTimeFilter, (float)kVstBarsValid);
+    process(plugin);
+    auto quartersPerFrame = 90.0 / (60.0 * SAMPLE_RATE);
+    CHECK(firstFlags(plugin) == (kVstTransportPlaying | kVstBarsValid));
+    CHECK(getParameter(plugin, kProbeTimeSamplePos) == 1000.0f + BLOCK_SIZE);
+    CHECK(fabs(getParameter(plugin, kProbeTimePpqPos) - (7.0 + BLOCK_SIZE * quartersPerFrame)) < 1e-5);
+
+    // split at a parameter change: the second processReplacing call gets a snapshot of its own, from its start
+    process(plugin, { { 100, kProbeGain, 1.0f } });
+    CHECK(getParameter(plugin, kProbeCalls) == 4.0f + 1.0f);
+    CHECK(firstFlags(plugin) == (kVstTransportPlaying | kVstBarsValid));
+    CHECK(getParameter(plugin, kProbeTimeSamplePos) == 1000.0f + 2 * BLOCK_SIZE + 100);
+    CHECK(fabs(getParameter(plugin, kProbeTimePpqPos) - (7.0 + (2 * BLOCK_SIZE + 100) * quartersPerFrame)) < 1e-5);
+
+    // stopped again: the position stays put
+    transport.playing = false;
+    transport.samplePos = 5000.0;
+    CVST_SetTransport(plugin, &transport);
+    process(plugin);
+    process(plugin);
+    CHECK(firstFlags(plugin) == kVstBarsValid);
+    CHECK(getParameter(plugin, kProbeTimeSamplePos) == 5000.0f);
+
+    CVST_Destroy(plugin);
+    CVST_Shutdown();
+    printf("ok\n");
+    return 0;
+}